@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <optimus/hash_map.h>
+#include <optimus/parallel.h>
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Number of rows sampled to estimate the number of groups.
+constexpr ::std::size_t group_estimate_sample = 1024;
+
+// Fewest rows worth handing to a thread of parallel_aggregate.
+constexpr ::std::size_t parallel_aggregate_min_rows = 16384;
+
+namespace detail {
+
+/**
+ * Estimates the number of distinct keys among the `n` rows from `first`
+ * from an evenly strided sample: if the sample of r rows holds d distinct
+ * keys, the estimate is the D for which r draws from D equally likely keys
+ * are expected to give d distinct ones, D (1 - (1 - 1/D)^r) = d. Skewed keys
+ * are underestimated, which only costs the table a few doublings.
+ */
+template <typename Iterator, typename KeyFn, typename Hash>
+::std::size_t estimate_groups(Iterator first, ::std::size_t n, const KeyFn& key, const Hash& hash) {
+    if (n <= group_estimate_sample) {
+        return n;
+    }
+    const ::std::size_t stride = n / group_estimate_sample;
+    ::std::vector<::std::size_t> hashes;
+    hashes.reserve(group_estimate_sample);
+    for (::std::size_t i = 0; i < group_estimate_sample; ++i, ::std::advance(first, stride)) {
+        hashes.push_back(hash(key(*first)));
+    }
+    ::std::sort(hashes.begin(), hashes.end());
+    const double distinct = double(::std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+    if (distinct == double(group_estimate_sample)) {
+        return n;
+    }
+
+    // The expected number of distinct keys grows with D, so bisect.
+    const double r = double(group_estimate_sample);
+    double lo = distinct;
+    double hi = double(n);
+    for (int i = 0; i < 64 && hi - lo > 1; ++i) {
+        const double mid = (lo + hi) / 2;
+        const double expected = mid * -::std::expm1(r * ::std::log1p(-1 / mid));
+        (expected < distinct ? lo : hi) = mid;
+    }
+    return ::std::size_t(hi);
+}
+
+// Which of `partitions` partitions a key with the mixed hash `hash` is
+// aggregated in. Uses the high bits, which flat_hash_map does not use to
+// place keys until it has 2^25 groups.
+inline ::std::size_t partition_of(::std::size_t hash, ::std::size_t partitions) {
+    return ::std::size_t(((::std::uint64_t(hash) >> 32) * partitions) >> 32);
+}
+
+} // namespace detail
+
+/**
+ * The rows of [first, last) grouped by the key `KeyFn` projects out of
+ * them, e.g. optimus::get<0> or optimus::compose<...>. Made by group_by;
+ * `aggregate` does the work.
+ */
+template <typename Iterator, typename KeyFn>
+class grouping {
+  public:
+    using reference = typename ::std::iterator_traits<Iterator>::reference;
+    using key_type = typename ::std::decay<result_of_t<const KeyFn(reference)>>::type;
+
+    template <typename ValueFn>
+    using value_type = typename ::std::decay<result_of_t<const ValueFn(reference)>>::type;
+
+    template <typename ValueFn>
+    using result_type = flat_hash_map<key_type, value_type<ValueFn>>;
+
+    grouping(Iterator first, Iterator last, KeyFn key)
+        : first_(first), last_(last), key_(optimus::move(key)), expected_groups_(0) { }
+
+    // Sizes the result for `groups` groups instead of estimating the number
+    // from a sample of the keys.
+    grouping& expect_groups(::std::size_t groups) {
+        expected_groups_ = groups;
+        return *this;
+    }
+
+    /**
+     * Reduces the values `ValueFn` projects out of the rows of each group
+     * with `op`, e.g. a functional.h operator such as optimus::plus<int>, and
+     * returns the map from each key to its reduced value. The first value
+     * of a group is taken as is, so `op` needs no identity.
+     */
+    template <typename ValueFn, typename ReduceOp>
+    result_type<ValueFn> aggregate(ValueFn value, ReduceOp op) const {
+        const ::std::size_t n = ::std::size_t(::std::distance(first_, last_));
+        result_type<ValueFn> result{expected_groups(n)};
+        for (Iterator it = first_; it != last_; ++it) {
+            result.accumulate(key_(*it), value(*it), op);
+        }
+        return result;
+    }
+
+    /**
+     * As aggregate, on `threads` threads. Each thread aggregates a slice of
+     * the rows into one table per partition of the key space; then each
+     * thread merges one partition across the slices, so no table is shared
+     * and no lock is taken. `op` must be associative and commutative, since
+     * values of a group are reduced in slice order and then across slices.
+     *
+     * Requires random access iterators. Falls back to aggregate when there
+     * are too few rows to be worth the threads.
+     */
+    template <typename ValueFn, typename ReduceOp>
+    result_type<ValueFn> parallel_aggregate(ValueFn value, ReduceOp op,
+                                            ::std::size_t threads = ::std::thread::hardware_concurrency()) const {
+        static_assert(::std::is_base_of<
+                          ::std::random_access_iterator_tag,
+                          typename ::std::iterator_traits<Iterator>::iterator_category>::value,
+                      "parallel_aggregate requires random access iterators");
+        using map_type = result_type<ValueFn>;
+
+        const ::std::size_t n = ::std::size_t(last_ - first_);
+        threads = ::std::min(threads, n / parallel_aggregate_min_rows);
+        if (threads <= 1) {
+            return aggregate(value, op);
+        }
+        const ::std::size_t partitions = threads;
+        const ::std::size_t groups = expected_groups(n);
+        const ::std::size_t slice_groups = ::std::min(groups, n / threads) / partitions;
+
+        // local[t * partitions + p]: partition p of slice t.
+        ::std::vector<map_type> local;
+        local.reserve(threads * partitions);
+        for (::std::size_t i = 0; i < threads * partitions; ++i) {
+            local.emplace_back(slice_groups);
+        }
+        detail::run_threads(threads, [&](::std::size_t t) {
+            map_type* slice = local.data() + t * partitions;
+            const Iterator last = first_ + ::std::ptrdiff_t(n * (t + 1) / threads);
+            for (Iterator it = first_ + ::std::ptrdiff_t(n * t / threads); it != last; ++it) {
+                const key_type key = key_(*it);
+                const ::std::size_t hash = slice->hash_of(key);
+                slice[detail::partition_of(hash, partitions)].accumulate(hash, key, value(*it), op);
+            }
+        });
+
+        ::std::vector<map_type> merged(partitions);
+        detail::run_threads(partitions, [&](::std::size_t p) {
+            map_type& partition = merged[p];
+            partition = optimus::move(local[p]);
+            for (::std::size_t t = 1; t < threads; ++t) {
+                for (auto& entry : local[t * partitions + p]) {
+                    partition.accumulate(partition.hash_of(entry.first), entry.first,
+                                         optimus::move(entry.second), op);
+                }
+                local[t * partitions + p] = map_type{};
+            }
+        });
+
+        ::std::size_t total = 0;
+        for (const map_type& partition : merged) {
+            total += partition.size();
+        }
+        map_type result{total};
+        for (map_type& partition : merged) {
+            for (auto& entry : partition) {
+                result.try_emplace(entry.first, optimus::move(entry.second));
+            }
+        }
+        return result;
+    }
+
+  private:
+    ::std::size_t expected_groups(::std::size_t n) const {
+        if (expected_groups_ != 0) {
+            return expected_groups_;
+        }
+        const ::std::hash<key_type> hash{};
+        return detail::estimate_groups(first_, n, key_, [&hash](const key_type& key) {
+            return detail::hash_mix(::std::uint64_t(hash(key)));
+        });
+    }
+
+    Iterator first_;
+    Iterator last_;
+    KeyFn key_;
+    ::std::size_t expected_groups_;
+};
+
+/**
+ * Groups the rows of [first, last) by `KeyFn`, for aggregating:
+ *
+ *   auto sums = optimus::group_by<optimus::get<0>>(rows.begin(), rows.end())
+ *       .aggregate(optimus::get<1>{}, optimus::plus<int>{});
+ *
+ * The result is a flat_hash_map, sized up front from an estimate of the
+ * number of groups (or from `expect_groups`) so that it rarely grows.
+ */
+template <typename KeyFn, typename Iterator>
+grouping<Iterator, KeyFn> group_by(Iterator first, Iterator last, KeyFn key = KeyFn{}) {
+    return grouping<Iterator, KeyFn>{first, last, optimus::move(key)};
+}
+
+template <typename KeyFn, typename Range>
+auto group_by(const Range& range, KeyFn key = KeyFn{})
+        -> grouping<decltype(::std::begin(range)), KeyFn> {
+    return grouping<decltype(::std::begin(range)), KeyFn>{
+        ::std::begin(range), ::std::end(range), optimus::move(key)};
+}
+
+} // namespace optimus
@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/transformers.h>
+
+#include "benchmark.h"
+
+// Compares calling a function one value at a time against batch<N>::apply,
+// which hands it blocks of N values through its range overload: a lookup
+// in a table shared between threads, which takes a lock once per call,
+// and divides_by, which is cheap enough inline that buffering costs more
+// than it saves.
+
+struct locked_lookup {
+    using argument_type = std::uint32_t;
+    using result_type = std::uint32_t;
+
+    std::mutex* lock;
+    const std::vector<std::uint32_t>* table;
+
+    std::uint32_t operator()(std::uint32_t x) const {
+        std::lock_guard<std::mutex> guard(*lock);
+        return (*table)[x % table->size()];
+    }
+
+    std::uint32_t* operator()(const std::uint32_t* first, const std::uint32_t* last, std::uint32_t* out) const {
+        std::lock_guard<std::mutex> guard(*lock);
+        for (; first != last; ++first, ++out) {
+            *out = (*table)[*first % table->size()];
+        }
+        return out;
+    }
+};
+
+template <typename Fn>
+std::uint64_t one_at_a_time(const std::vector<std::uint32_t>& values, const Fn& fn) {
+    std::uint64_t check = 0;
+    for (std::uint32_t value : values) {
+        check += fn(value);
+    }
+    return check;
+}
+
+template <std::size_t N, typename Fn>
+std::uint64_t batched(const std::vector<std::uint32_t>& values, const Fn& fn) {
+    typename optimus::batch<N>::template apply<Fn> batch{fn};
+    std::uint64_t check = 0;
+    auto add = [&check](std::uint32_t result) { check += result; };
+    for (std::uint32_t value : values) {
+        batch(value, add);
+    }
+    batch.flush(add);
+    return check;
+}
+
+int main() {
+    constexpr std::size_t n = 16 * 1000 * 1000;
+    std::vector<std::uint32_t> values(n);
+    std::mt19937 random(1);
+    for (auto& value : values) {
+        value = static_cast<std::uint32_t>(random());
+    }
+    volatile std::uint32_t divisor = 7;
+    std::mutex lock;
+    const std::vector<std::uint32_t> table(values.begin(), values.begin() + 4096);
+    const locked_lookup lookup{&lock, &table};
+    const optimus::divides_by<std::uint32_t> divide{divisor};
+
+    std::cout << "locked_lookup" << std::endl;
+    run("  one at a time", n, "value", [&] { return one_at_a_time(values, lookup); });
+    run("  batch<16>    ", n, "value", [&] { return batched<16>(values, lookup); });
+    run("  batch<256>   ", n, "value", [&] { return batched<256>(values, lookup); });
+
+    std::cout << "divides_by" << std::endl;
+    run("  one at a time", n, "value", [&] { return one_at_a_time(values, divide); });
+    run("  batch<16>    ", n, "value", [&] { return batched<16>(values, divide); });
+    run("  batch<256>   ", n, "value", [&] { return batched<256>(values, divide); });
+}
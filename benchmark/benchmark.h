@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+// The timing helper shared by the benchmarks.
+
+namespace detail {
+
+template <typename Body>
+double time_ns(Body& body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+} // namespace detail
+
+/**
+ * Times `body()` and prints the time it took per `unit`, of which it does
+ * `n`, e.g. "name: 3.2 ns/row (42)". A value returned by `body` is printed
+ * after the time, so that the work it depends on is not optimised away.
+ */
+template <typename Body>
+typename std::enable_if<std::is_void<decltype(std::declval<Body&>()())>::value>::type
+run(const char* name, std::size_t n, const char* unit, Body body) {
+    const double ns = detail::time_ns(body);
+    std::cout << name << ": " << ns / double(n) << " ns/" << unit << std::endl;
+}
+
+template <typename Body>
+typename std::enable_if<!std::is_void<decltype(std::declval<Body&>()())>::value>::type
+run(const char* name, std::size_t n, const char* unit, Body body) {
+    typename std::decay<decltype(body())>::type check{};
+    auto keep = [&] { check = body(); };
+    const double ns = detail::time_ns(keep);
+    std::cout << name << ": " << ns / double(n) << " ns/" << unit << " (" << check << ")" << std::endl;
+}
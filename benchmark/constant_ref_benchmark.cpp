@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/placeholders.h>
+
+#include "benchmark.h"
+
+// Compares counting the strings equal to a 64 character key through a
+// constant<std::string>, which copies the key on every call, against the
+// constant_ref<std::string> which `_1 == key` now captures.
+
+using namespace optimus::placeholders;
+
+int main() {
+    constexpr std::size_t n = 1000 * 1000;
+    const std::string key(64, 'k');
+    std::vector<std::string> values(n);
+    std::mt19937 random(1);
+    for (auto& value : values) {
+        value = random() % 4 == 0 ? key : std::string(64, char('a' + random() % 10));
+    }
+
+    run("constant    ", n, "value", [&] {
+        const auto eq = optimus::binary_expression<
+            optimus::equal_to, optimus::placeholder<0>, optimus::constant<std::string>>{
+                optimus::placeholder<0>{}, optimus::constant<std::string>{key}};
+        return std::uint64_t(std::count_if(values.begin(), values.end(), eq));
+    });
+
+    run("constant_ref", n, "value", [&] {
+        const auto eq = _1 == key;
+        return std::uint64_t(std::count_if(values.begin(), values.end(), eq));
+    });
+}
@@ -0,0 +1,51 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <optimus/aggregate.h>
+#include <optimus/functional.h>
+#include <optimus/transformers.h>
+
+#include "benchmark.h"
+
+// Compares group_by(...).aggregate and parallel_aggregate against the
+// std::unordered_map loop they replace, summing a value per key for a
+// range of group counts.
+
+using row = std::tuple<std::uint64_t, std::int64_t>;
+
+void compare(std::size_t rows, std::uint64_t groups) {
+    std::mt19937_64 gen(42);
+    std::vector<row> data(rows);
+    for (auto& r : data) {
+        r = row{gen() % groups, std::int64_t(gen() % 1000)};
+    }
+
+    std::cout << groups << " groups" << std::endl;
+    run("  unordered_map     ", rows, "row", [&] {
+        std::unordered_map<std::uint64_t, std::int64_t> sums;
+        for (const row& r : data) {
+            sums[std::get<0>(r)] += std::get<1>(r);
+        }
+        return sums.size();
+    });
+    run("  aggregate         ", rows, "row", [&] {
+        return optimus::group_by<optimus::get<0>>(data)
+            .aggregate(optimus::get<1>{}, optimus::plus<std::int64_t>{}).size();
+    });
+    run("  parallel_aggregate", rows, "row", [&] {
+        return optimus::group_by<optimus::get<0>>(data)
+            .parallel_aggregate(optimus::get<1>{}, optimus::plus<std::int64_t>{}).size();
+    });
+}
+
+int main() {
+    constexpr std::size_t rows = 20 * 1000 * 1000;
+    for (std::uint64_t groups : {100ull, 100000ull, 10000000ull}) {
+        compare(rows, groups);
+    }
+}
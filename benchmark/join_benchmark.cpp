@@ -0,0 +1,62 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <optimus/join.h>
+#include <optimus/transformers.h>
+
+#include "benchmark.h"
+
+// Compares hash_join, serial and parallel, against probing a
+// std::unordered_multimap built from the right range.
+
+using row = std::tuple<std::uint64_t, std::uint64_t>;
+
+int main() {
+    constexpr std::size_t left_rows = 20 * 1000 * 1000;
+    constexpr std::size_t right_rows = 5 * 1000 * 1000;
+    std::mt19937_64 gen(42);
+    std::vector<row> left(left_rows);
+    std::vector<row> right(right_rows);
+    for (auto& r : left) {
+        r = row{gen() % (2 * right_rows), gen()};
+    }
+    for (std::size_t i = 0; i < right_rows; ++i) {
+        right[i] = row{gen() % (2 * right_rows), i};
+    }
+
+    run("unordered_multimap    ", left_rows, "row", [&] {
+        std::unordered_multimap<std::uint64_t, const row*> table;
+        table.reserve(right_rows);
+        for (const row& r : right) {
+            table.emplace(std::get<0>(r), &r);
+        }
+        std::uint64_t checksum = 0;
+        for (const row& l : left) {
+            const auto range = table.equal_range(std::get<0>(l));
+            for (auto it = range.first; it != range.second; ++it) {
+                checksum += std::get<1>(*it->second);
+            }
+        }
+        return checksum;
+    });
+    run("hash_join             ", left_rows, "row", [&] {
+        std::uint64_t checksum = 0;
+        for (auto pair : optimus::hash_join<optimus::fst, optimus::fst>(left, right)) {
+            checksum += std::get<1>(std::get<1>(pair));
+        }
+        return checksum;
+    });
+    run("hash_join (4 threads) ", left_rows, "row", [&] {
+        std::atomic<std::uint64_t> checksum{0};
+        optimus::hash_join<optimus::fst, optimus::fst>(left, right, optimus::fst{}, optimus::fst{}, 4)
+            .parallel_for_each([&checksum](optimus::tuple<const row&, const row&> pair) {
+                checksum += std::get<1>(std::get<1>(pair));
+            }, 4);
+        return checksum.load();
+    });
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <optimus/lazy_tuple.h>
+
+#include "benchmark.h"
+
+// Compares decoding every field of a 16 field comma separated row and then
+// reading two of them against a lazy_tuple which decodes only those two.
+
+template <std::size_t I>
+struct field {
+    long operator()(const char* line) const {
+        for (std::size_t i = 0; i < I; ++i) {
+            while (*line++ != ',') { }
+        }
+        return std::strtol(line, nullptr, 10);
+    }
+};
+
+using row = optimus::lazy_tuple<const char*, field<0>, field<1>, field<2>, field<3>, field<4>, field<5>,
+                                field<6>, field<7>, field<8>, field<9>, field<10>, field<11>, field<12>,
+                                field<13>, field<14>, field<15>>;
+
+int main() {
+    constexpr std::size_t n = 1000 * 1000;
+    std::vector<std::string> lines(n);
+    std::mt19937 random(1);
+    for (auto& line : lines) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            line += (i == 0 ? "" : ",") + std::to_string(random() % 100000);
+        }
+    }
+
+    run("eager", n, "row", [&lines] {
+        std::uint64_t check = 0;
+        for (const auto& line : lines) {
+            const char* s = line.c_str();
+            long fields[16];
+            for (std::size_t i = 0; i < 16; ++i) {
+                char* end;
+                fields[i] = std::strtol(s, &end, 10);
+                s = end + 1;
+            }
+            check += std::uint64_t(fields[2] + fields[9]);
+        }
+        return check;
+    });
+
+    run("lazy ", n, "row", [&lines] {
+        std::uint64_t check = 0;
+        row r(nullptr);
+        for (const auto& line : lines) {
+            r.reset(line.c_str());
+            check += std::uint64_t(r.get<2>() + r.get<9>());
+        }
+        return check;
+    });
+}
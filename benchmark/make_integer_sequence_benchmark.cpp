@@ -0,0 +1,17 @@
+#include <cstddef>
+
+#include <optimus/utility.h>
+
+// Compile-time benchmark: build with -DSEQUENCE_SIZE=N and time the
+// compiler, with and without -DOPTIMUS_NO_BUILTIN_INTEGER_SEQUENCE.
+// See the Makefile for the sizes we track.
+
+#ifndef SEQUENCE_SIZE
+#define SEQUENCE_SIZE 1000
+#endif
+
+static_assert(
+    optimus::make_index_sequence<SEQUENCE_SIZE>::size() == SEQUENCE_SIZE,
+    "Wrong sequence size");
+
+int main() { }
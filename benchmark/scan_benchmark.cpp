@@ -0,0 +1,37 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/parallel.h>
+#include <optimus/scan.h>
+
+#include "benchmark.h"
+
+// Compares prefix sums of an offset array with std::partial_sum against
+// optimus::inclusive_scan on one thread and on every core.
+
+int main() {
+    constexpr std::size_t n = 64 * 1000 * 1000;
+    std::vector<std::uint32_t> lengths(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        lengths[i] = std::uint32_t(i * 2654435761u >> 28);
+    }
+    std::vector<std::uint32_t> offsets(n);
+    const std::uint32_t* first = lengths.data();
+    const std::uint32_t* last = first + n;
+
+    optimus::work_stealing_pool one{0};
+    optimus::work_stealing_pool& all = optimus::work_stealing_pool::shared();
+    std::cout << "threads = " << all.size() + 1 << std::endl;
+
+    for (int repeat = 0; repeat < 2; ++repeat) {
+        run("  std::partial_sum        ", n, "element", [&] { std::partial_sum(first, last, offsets.begin()); });
+        run("  inclusive_scan, 1 thread", n, "element", [&] { optimus::inclusive_scan(one, first, last, offsets.data()); });
+        run("  inclusive_scan, parallel", n, "element", [&] { optimus::inclusive_scan(all, first, last, offsets.data()); });
+    }
+    std::cout << "  last offset " << offsets.back() << std::endl;
+}
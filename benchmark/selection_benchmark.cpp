@@ -0,0 +1,41 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <optimus/placeholders.h>
+#include <optimus/selection.h>
+
+#include "benchmark.h"
+
+// Compares a predicate_selector against a loop with short-circuiting
+// conditions, for three conditions which each hold for about half of
+// random rows, so that the loop's branches mispredict.
+
+using namespace optimus::placeholders;
+
+int main() {
+    constexpr std::size_t n = 20 * 1000 * 1000;
+    std::mt19937 gen(42);
+    std::vector<std::int32_t> values(n);
+    for (auto& v : values) {
+        v = std::int32_t(gen() % 1000);
+    }
+    std::vector<std::uint32_t> selected(n);
+
+    run("short-circuit loop", n, "row", [&] {
+        std::uint32_t* out = selected.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::int32_t v = values[i];
+            if ((v & 1) == 0 && v < 500 && (v & 16) == 0) {
+                *out++ = std::uint32_t(i);
+            }
+        }
+        return std::size_t(out - selected.data());
+    });
+
+    run("predicate_selector", n, "row", [&] {
+        auto selector = optimus::make_selector(optimus::make_all_of_pred((_1 & 1) == 0, _1 < 500, (_1 & 16) == 0));
+        return std::size_t(selector.select(values.begin(), values.end(), selected.data()) - selected.data());
+    });
+}
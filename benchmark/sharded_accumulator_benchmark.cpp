@@ -0,0 +1,49 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/sharded_accumulator.h>
+
+#include "benchmark.h"
+
+// Compares counting from several threads into a sharded_accumulator
+// against a single std::atomic counter.
+
+template <typename Add>
+void run_threads(const char* name, std::size_t threads, std::size_t per_thread, Add add) {
+    run(name, threads * per_thread, "add", [&] {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&add, per_thread] {
+                for (std::size_t i = 0; i < per_thread; ++i) {
+                    add();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+int main() {
+    const std::size_t threads = std::max(4u, std::thread::hardware_concurrency());
+    constexpr std::size_t per_thread = 10 * 1000 * 1000;
+    std::cout << "threads = " << threads << std::endl;
+
+    std::atomic<std::uint64_t> atomic{0};
+    run_threads("  std::atomic        ", threads, per_thread, [&atomic] {
+        atomic.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    optimus::sharded_accumulator<std::uint64_t, optimus::plus<std::uint64_t>> sharded;
+    run_threads("  sharded_accumulator", threads, per_thread, [&sharded] {
+        sharded.add(1);
+    });
+
+    std::cout << "  totals " << atomic.load() << " " << sharded.read() << std::endl;
+}
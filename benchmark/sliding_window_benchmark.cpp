@@ -0,0 +1,59 @@
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <optimus/sliding_window.h>
+
+#include "benchmark.h"
+
+// Compares a running maximum over the last `width` values kept by a
+// count_window against folding the whole window on each value.
+
+struct max_op {
+    std::uint32_t operator()(std::uint32_t a, std::uint32_t b) const {
+        return a < b ? b : a;
+    }
+};
+
+int main() {
+    constexpr std::size_t n = 4 * 1000 * 1000;
+    std::vector<std::uint32_t> values(n);
+    std::mt19937 random(1);
+    for (auto& value : values) {
+        value = static_cast<std::uint32_t>(random());
+    }
+
+    for (std::size_t width : {16, 256, 4096}) {
+        std::cout << "width = " << width << std::endl;
+
+        run("  recompute   ", n, "value", [&values, width] {
+            std::deque<std::uint32_t> window;
+            std::uint64_t check = 0;
+            for (std::uint32_t value : values) {
+                window.push_back(value);
+                if (window.size() > width) {
+                    window.pop_front();
+                }
+                std::uint32_t result = 0;
+                for (std::uint32_t x : window) {
+                    result = max_op{}(result, x);
+                }
+                check += result;
+            }
+            return check;
+        });
+
+        run("  count_window", n, "value", [&values, width] {
+            optimus::count_window<std::uint32_t, max_op> window{width};
+            std::uint64_t check = 0;
+            for (std::uint32_t value : values) {
+                window.push(value);
+                check += window.query();
+            }
+            return check;
+        });
+    }
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <optimus/sorted_index.h>
+#include <optimus/transformers.h>
+
+#include "benchmark.h"
+
+// Compares point lookups in a sorted_index against std::lower_bound over
+// the sorted keys, for random keys of a large table.
+
+struct key_of {
+    std::uint32_t operator()(std::uint32_t value) const {
+        return value;
+    }
+};
+
+int main() {
+    constexpr std::size_t n = 32 * 1024 * 1024;
+    constexpr std::size_t lookups = 4 * 1000 * 1000;
+    std::mt19937 gen(42);
+    std::vector<std::uint32_t> rows(n);
+    for (auto& row : rows) {
+        row = std::uint32_t(gen());
+    }
+    std::vector<std::uint32_t> keys(lookups);
+    for (auto& key : keys) {
+        key = std::uint32_t(gen());
+    }
+
+    std::vector<std::uint32_t> sorted = rows;
+    std::sort(sorted.begin(), sorted.end());
+    const auto index = optimus::index_by<key_of>(rows);
+
+    std::cout << "n = " << n << std::endl;
+    run("  std::lower_bound", lookups, "lookup", [&] {
+        std::size_t checksum = 0;
+        for (auto key : keys) {
+            checksum += std::size_t(std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin());
+        }
+        return checksum;
+    });
+    run("  sorted_index    ", lookups, "lookup", [&] {
+        std::size_t checksum = 0;
+        for (auto key : keys) {
+            checksum += std::size_t(index.lower_bound(key) - index.begin());
+        }
+        return checksum;
+    });
+}
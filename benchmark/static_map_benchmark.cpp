@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <optimus/static_map.h>
+
+#include "benchmark.h"
+
+// Compares looking fields up by name in a static_map, through its perfect
+// hash and by a compile-time index, against a std::unordered_map.
+
+constexpr auto fields = optimus::make_static_keys("id", "price", "quantity", "side", "venue", "timestamp",
+                                                  "account", "strategy", "currency", "fee", "order_type",
+                                                  "time_in_force", "exchange", "symbol", "sequence", "flags");
+
+int main() {
+    constexpr std::size_t n = 10 * 1000 * 1000;
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        names.emplace_back(fields.key(i), fields.key_size(i));
+    }
+    std::vector<std::uint32_t> order(n);
+    std::mt19937 random(1);
+    for (auto& i : order) {
+        i = static_cast<std::uint32_t>(random() % names.size());
+    }
+
+    optimus::static_map<std::uint64_t, fields.size()> row{fields};
+    std::unordered_map<std::string, std::uint64_t> map;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        row[i] = i + 1;
+        map[names[i]] = i + 1;
+    }
+
+    run("unordered_map::at   ", n, "lookup", [&] {
+        std::uint64_t check = 0;
+        for (std::uint32_t i : order) {
+            check += map.at(names[i]);
+        }
+        return check;
+    });
+
+    run("static_map::at      ", n, "lookup", [&] {
+        std::uint64_t check = 0;
+        for (std::uint32_t i : order) {
+            check += row.at(names[i]);
+        }
+        return check;
+    });
+
+    run("static_map index_of ", n, "lookup", [&] {
+        constexpr std::size_t price = fields.index_of("price");
+        std::uint64_t check = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            check += row[price];
+            row[price] ^= i & 1;
+        }
+        return check;
+    });
+}
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/top_k.h>
+
+#include "benchmark.h"
+
+// Compares top_k against sorting the whole input and against
+// std::partial_sort, for the largest k of random integers.
+
+std::int64_t sum(const std::vector<std::int32_t>& values) {
+    std::int64_t total = 0;
+    for (auto v : values) {
+        total += v;
+    }
+    return total;
+}
+
+int main() {
+    constexpr std::size_t n = 50 * 1000 * 1000;
+    std::mt19937 gen(42);
+    std::vector<std::int32_t> values(n);
+    for (auto& v : values) {
+        v = std::int32_t(gen());
+    }
+
+    for (std::size_t k : {10u, 1000u}) {
+        std::cout << "k = " << k << std::endl;
+        run("  sort        ", n, "value", [&] {
+            auto copy = values;
+            std::sort(copy.begin(), copy.end(), std::greater<std::int32_t>{});
+            copy.resize(k);
+            return sum(copy);
+        });
+        run("  partial_sort", n, "value", [&] {
+            auto copy = values;
+            std::partial_sort(copy.begin(), copy.begin() + std::ptrdiff_t(k), copy.end(),
+                              std::greater<std::int32_t>{});
+            copy.resize(k);
+            return sum(copy);
+        });
+        run("  top_k       ", n, "value", [&] {
+            return sum(optimus::top_k<optimus::greater<std::int32_t>>(values, k));
+        });
+    }
+}
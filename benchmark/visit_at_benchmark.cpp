@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <optimus/tuple.h>
+
+// Compares optimus::visit_at against the chain of if-else branches it
+// replaces, for a tuple small enough to use the switch and one large
+// enough to use the table.
+
+struct accumulate {
+    std::uint64_t& sum;
+
+    template <typename T>
+    void operator()(const T& v) const {
+        sum += v;
+    }
+};
+
+using small_tuple = optimus::tuple<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t>;
+using large_tuple = optimus::tuple<
+    int, int, int, int, int, int, int, int,
+    int, int, int, int, int, int, int, int>;
+
+template <typename Tuple>
+void if_else_chain(const Tuple& t, std::size_t index, const accumulate& fn);
+
+template <>
+void if_else_chain(const small_tuple& t, std::size_t index, const accumulate& fn) {
+    if (index == 0) {
+        fn(optimus::get<0>(t));
+    } else if (index == 1) {
+        fn(optimus::get<1>(t));
+    } else if (index == 2) {
+        fn(optimus::get<2>(t));
+    } else {
+        fn(optimus::get<3>(t));
+    }
+}
+
+template <>
+void if_else_chain(const large_tuple& t, std::size_t index, const accumulate& fn) {
+    if (index == 0) { fn(optimus::get<0>(t)); }
+    else if (index == 1) { fn(optimus::get<1>(t)); }
+    else if (index == 2) { fn(optimus::get<2>(t)); }
+    else if (index == 3) { fn(optimus::get<3>(t)); }
+    else if (index == 4) { fn(optimus::get<4>(t)); }
+    else if (index == 5) { fn(optimus::get<5>(t)); }
+    else if (index == 6) { fn(optimus::get<6>(t)); }
+    else if (index == 7) { fn(optimus::get<7>(t)); }
+    else if (index == 8) { fn(optimus::get<8>(t)); }
+    else if (index == 9) { fn(optimus::get<9>(t)); }
+    else if (index == 10) { fn(optimus::get<10>(t)); }
+    else if (index == 11) { fn(optimus::get<11>(t)); }
+    else if (index == 12) { fn(optimus::get<12>(t)); }
+    else if (index == 13) { fn(optimus::get<13>(t)); }
+    else if (index == 14) { fn(optimus::get<14>(t)); }
+    else { fn(optimus::get<15>(t)); }
+}
+
+template <typename Body>
+void run(const char* name, const std::vector<std::size_t>& indices, Body body) {
+    std::uint64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const std::size_t index : indices) {
+        body(index, accumulate{sum});
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << name << ": " << ns / indices.size() << " ns/call (sum " << sum << ")" << std::endl;
+}
+
+template <typename Tuple>
+void compare(const char* name, const Tuple& t, std::size_t iterations) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> dis(0, optimus::tuple_size<Tuple>::value - 1);
+    std::vector<std::size_t> indices(iterations);
+    for (auto& index : indices) {
+        index = dis(gen);
+    }
+
+    std::cout << name << std::endl;
+    run("  if-else chain", indices, [&](std::size_t index, const accumulate& fn) {
+        if_else_chain(t, index, fn);
+    });
+    run("  visit_at     ", indices, [&](std::size_t index, const accumulate& fn) {
+        optimus::visit_at(t, index, fn);
+    });
+}
+
+int main() {
+    constexpr std::size_t iterations = 50 * 1000 * 1000;
+    compare("4 elements (switch)", small_tuple{1, 2, 3, 4}, iterations);
+    compare("16 elements (table)",
+            large_tuple{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}, iterations);
+}
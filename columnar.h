@@ -0,0 +1,472 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <optimus/functional.h>
+#include <optimus/record.h>
+#include <optimus/traits.h>
+#include <optimus/transformers.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+constexpr ::std::size_t columnar_default_block_rows = 4096;
+
+/**
+ * The 64 byte header at the start of a columnar file. It is followed by a
+ * directory of `column_count` column_entry, then by one segment per
+ * column: the `row_count` values of the column packed back to back, and
+ * the min and max of each block of `block_rows` values. Every segment is
+ * page aligned, so that a column of a mapped file can be read in place and
+ * shares no page with the other columns.
+ */
+struct columnar_file_header {
+    static constexpr ::std::uint64_t file_magic = 0x314c4f4353554d4full; // "OMUSCOL1"
+    static constexpr ::std::uint32_t current_version = 1;
+    static constexpr ::std::uint32_t native_byte_order = 0x01020304;
+    static constexpr ::std::size_t segment_alignment = 4096;
+
+    struct column_entry {
+        ::std::uint64_t value_size;
+        ::std::uint64_t data_offset;
+        ::std::uint64_t stats_offset;
+        ::std::uint64_t reserved;
+    };
+
+    ::std::uint64_t magic;
+    ::std::uint32_t version;
+    ::std::uint32_t byte_order;
+    ::std::uint64_t schema;
+    ::std::uint64_t column_count;
+    ::std::uint64_t row_count;
+    ::std::uint64_t block_rows;
+    ::std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(columnar_file_header) == 64, "columnar_file_header must be 64 bytes");
+
+/**
+ * One column of a columnar file, read in place: the values and, for each
+ * block of `block_rows()` values, their min and max.
+ */
+template <typename T>
+class column_view {
+  public:
+    using value_type = T;
+    using const_iterator = const T*;
+
+    column_view() : data_(nullptr), stats_(nullptr), size_(0), block_rows_(1) { }
+
+    column_view(const T* data, const T* stats, ::std::size_t size, ::std::size_t block_rows)
+        : data_(data), stats_(stats), size_(size), block_rows_(block_rows) { }
+
+    const T* data() const { return data_; }
+    ::std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T& operator[](::std::size_t i) const { return data_[i]; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    ::std::size_t block_rows() const { return block_rows_; }
+    ::std::size_t block_count() const { return (size_ + block_rows_ - 1) / block_rows_; }
+    const T& block_min(::std::size_t block) const { return stats_[2 * block]; }
+    const T& block_max(::std::size_t block) const { return stats_[2 * block + 1]; }
+
+  private:
+    const T* data_;
+    const T* stats_;
+    ::std::size_t size_;
+    ::std::size_t block_rows_;
+};
+
+namespace detail {
+
+template <typename T>
+constexpr ::std::uint64_t column_data_size(::std::uint64_t rows) {
+    return align_up(rows * sizeof(T), columnar_file_header::segment_alignment);
+}
+
+template <typename T>
+constexpr ::std::uint64_t column_stats_size(::std::uint64_t rows, ::std::uint64_t block_rows) {
+    return align_up((rows + block_rows - 1) / block_rows * 2 * sizeof(T),
+                    columnar_file_header::segment_alignment);
+}
+
+inline void write_padding(::std::ostream& out, ::std::uint64_t& position, ::std::uint64_t offset) {
+    static const char zeros[columnar_file_header::segment_alignment] = { };
+    out.write(zeros, ::std::streamsize(offset - position));
+    position = offset;
+}
+
+// Whether `v` is unordered with itself, i.e. a NaN.
+template <typename T>
+constexpr bool is_unordered(const T& v) {
+    return !(v == v);
+}
+
+// Writes column `I` of [first, last) and its block statistics.
+template <::std::size_t I, typename... Types, typename ForwardIterator>
+void write_column(::std::ostream& out, ForwardIterator first, ForwardIterator last,
+                  ::std::uint64_t block_rows, ::std::uint64_t& position,
+                  const columnar_file_header::column_entry& entry) {
+    using T = typename record_layout<Types...>::template type<I>;
+    static_assert(::std::is_same<
+                      typename ::std::decay<decltype(record_field<I>::get(*first))>::type, T>::value,
+                  "record fields must be exactly of the column types");
+
+    write_padding(out, position, entry.data_offset);
+    ::std::vector<T> stats;
+    ::std::vector<T> values;
+    values.reserve(block_rows);
+    while (first != last && out) {
+        values.clear();
+        for (; values.size() < block_rows && first != last; ++first) {
+            values.push_back(record_field<I>::get(*first));
+        }
+        // NaNs are left out of the bounds, which a NaN would otherwise
+        // poison so that no comparison matched the block. Once the bounds
+        // start from an ordered value, `<` never picks a NaN.
+        auto ordered = values.begin();
+        while (ordered != values.end() && is_unordered(*ordered)) {
+            ++ordered;
+        }
+        T min = ordered != values.end() ? *ordered : values[0];
+        T max = min;
+        for (const T& v : values) {
+            min = v < min ? v : min;
+            max = max < v ? v : max;
+        }
+        stats.push_back(min);
+        stats.push_back(max);
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  ::std::streamsize(values.size() * sizeof(T)));
+        position += values.size() * sizeof(T);
+    }
+
+    write_padding(out, position, entry.stats_offset);
+    out.write(reinterpret_cast<const char*>(stats.data()), ::std::streamsize(stats.size() * sizeof(T)));
+    position += stats.size() * sizeof(T);
+}
+
+template <typename... Types, typename ForwardIterator, ::std::size_t... Indices>
+void write_columns(::std::ostream& out, ForwardIterator first, ForwardIterator last,
+                   ::std::uint64_t block_rows, ::std::uint64_t& position,
+                   const columnar_file_header::column_entry* entries, index_sequence<Indices...>) {
+    using swallow = int[];
+    (void)swallow{0, (write_column<Indices, Types...>(
+            out, first, last, block_rows, position, entries[Indices]), 0)...};
+}
+
+} // namespace detail
+
+/**
+ * Writes the records in [first, last) to `out` as a columnar file, one
+ * segment per field. Records are optimus::tuple, or anything else whose
+ * fields ::std::get can reach, with fields exactly of the types `Types`;
+ * each must be trivially copyable and ordered by `<`, which the block
+ * statistics use.
+ *
+ * The input is read once per column, so memory use is bounded by a block
+ * and the statistics.
+ * Returns whether the stream is still good.
+ */
+template <typename... Types, typename ForwardIterator>
+bool write_columnar_file(::std::ostream& out, ForwardIterator first, ForwardIterator last,
+                         ::std::size_t block_rows = columnar_default_block_rows) {
+    constexpr ::std::size_t column_count = sizeof...(Types);
+    static_assert(column_count > 0, "a columnar file needs at least one column");
+    if (block_rows == 0) {
+        return false;
+    }
+
+    columnar_file_header header;
+    ::std::memset(&header, 0, sizeof(header));
+    header.magic = columnar_file_header::file_magic;
+    header.version = columnar_file_header::current_version;
+    header.byte_order = columnar_file_header::native_byte_order;
+    header.schema = record_layout<Types...>::schema;
+    header.column_count = column_count;
+    header.row_count = ::std::uint64_t(::std::distance(first, last));
+    header.block_rows = block_rows;
+
+    const ::std::uint64_t sizes[] = {sizeof(Types)...};
+    const ::std::uint64_t data_sizes[] = {detail::column_data_size<Types>(header.row_count)...};
+    const ::std::uint64_t stats_sizes[] = {detail::column_stats_size<Types>(header.row_count, block_rows)...};
+    columnar_file_header::column_entry entries[column_count];
+    ::std::uint64_t offset = detail::align_up(sizeof(header) + sizeof(entries),
+                                              columnar_file_header::segment_alignment);
+    for (::std::size_t i = 0; i < column_count; ++i) {
+        entries[i].value_size = sizes[i];
+        entries[i].data_offset = offset;
+        entries[i].stats_offset = offset + data_sizes[i];
+        entries[i].reserved = 0;
+        offset += data_sizes[i] + stats_sizes[i];
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+    ::std::uint64_t position = sizeof(header) + sizeof(entries);
+    detail::write_columns<Types...>(out, first, last, block_rows, position, entries,
+                                    index_sequence_for<Types...>{});
+    detail::write_padding(out, position, offset);
+    return bool(out);
+}
+
+/**
+ * A view of a columnar file which reads its columns in place, typically
+ * from a mapped_file. Opening a view only checks the header and directory;
+ * since every column is a separate page-aligned segment, the pages of a
+ * column are only faulted in once it is read, and a scan which touches 2
+ * of 15 columns reads 2 columns from disk.
+ *
+ * A view of a buffer which is not a columnar file of `Types` is not
+ * `valid()` and has no rows.
+ */
+template <typename... Types>
+class columnar_file_view {
+  public:
+    static constexpr ::std::size_t column_count = sizeof...(Types);
+
+    template <::std::size_t I>
+    using column_type = typename record_layout<Types...>::template type<I>;
+
+    columnar_file_view(const void* data, ::std::size_t size) : valid_(false), size_(0), block_rows_(1) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        columnar_file_header header;
+        columnar_file_header::column_entry entries[column_count];
+        if (data == nullptr || size < sizeof(header) + sizeof(entries)) {
+            return;
+        }
+        ::std::memcpy(&header, bytes, sizeof(header));
+        ::std::memcpy(entries, bytes + sizeof(header), sizeof(entries));
+        if (header.magic != columnar_file_header::file_magic
+                || header.version != columnar_file_header::current_version
+                || header.byte_order != columnar_file_header::native_byte_order
+                || header.schema != record_layout<Types...>::schema
+                || header.column_count != column_count
+                || header.block_rows == 0
+                || header.row_count > size) {
+            return;
+        }
+        const ::std::uint64_t sizes[] = {sizeof(Types)...};
+        const ::std::uint64_t alignments[] = {alignof(Types)...};
+        const ::std::uint64_t blocks = (header.row_count + header.block_rows - 1) / header.block_rows;
+        for (::std::size_t i = 0; i < column_count; ++i) {
+            const columnar_file_header::column_entry& entry = entries[i];
+            if (entry.value_size != sizes[i]
+                    || entry.data_offset > size
+                    || entry.stats_offset > size
+                    || header.row_count > (size - entry.data_offset) / sizes[i]
+                    || blocks > (size - entry.stats_offset) / (2 * sizes[i])
+                    || reinterpret_cast<::std::uintptr_t>(bytes + entry.data_offset) % alignments[i] != 0
+                    || reinterpret_cast<::std::uintptr_t>(bytes + entry.stats_offset) % alignments[i] != 0) {
+                return;
+            }
+            data_[i] = bytes + entry.data_offset;
+            stats_[i] = bytes + entry.stats_offset;
+        }
+        valid_ = true;
+        size_ = ::std::size_t(header.row_count);
+        block_rows_ = ::std::size_t(header.block_rows);
+    }
+
+    bool valid() const {
+        return valid_;
+    }
+
+    ::std::size_t size() const {
+        return size_;
+    }
+
+    ::std::size_t block_rows() const {
+        return block_rows_;
+    }
+
+    ::std::size_t block_count() const {
+        return (size_ + block_rows_ - 1) / block_rows_;
+    }
+
+    template <::std::size_t I>
+    column_view<column_type<I>> column() const {
+        static_assert(I < column_count, "column index out of range");
+        if (!valid_) {
+            return column_view<column_type<I>>{};
+        }
+        return column_view<column_type<I>>{
+            reinterpret_cast<const column_type<I>*>(data_[I]),
+            reinterpret_cast<const column_type<I>*>(stats_[I]),
+            size_,
+            block_rows_};
+    }
+
+  private:
+    bool valid_;
+    ::std::size_t size_;
+    ::std::size_t block_rows_;
+    const unsigned char* data_[column_count];
+    const unsigned char* stats_[column_count];
+};
+
+template <typename... Types>
+constexpr ::std::size_t columnar_file_view<Types...>::column_count;
+
+/**
+ * The rows whose column `Column` compares true against `value` with
+ * `Compare`, e.g. `where<2>(optimus::less<int>{}, 100)`. With the
+ * comparisons of functional.h a scan uses the block statistics to skip the
+ * blocks in which no row can match; any other `Compare` is tested row by
+ * row.
+ */
+template <::std::size_t Column, typename Compare, typename T>
+struct column_predicate {
+    Compare compare;
+    T value;
+
+    template <typename U>
+    constexpr bool operator()(const U& v) const {
+        return compare(v, value);
+    }
+};
+
+template <::std::size_t Column, typename Compare, typename T>
+constexpr column_predicate<Column, Compare, typename ::std::decay<T>::type>
+where(Compare compare, T&& value) {
+    return column_predicate<Column, Compare, typename ::std::decay<T>::type>{
+        compare, optimus::forward<T>(value)};
+}
+
+namespace detail {
+
+// Whether a block with the given bounds can hold a value matching
+// `compare(value, bound)`.
+template <typename Compare, typename T, typename U>
+constexpr bool block_may_match(const Compare&, const T&, const T&, const U&) {
+    return true;
+}
+
+template <typename V, typename T, typename U>
+constexpr bool block_may_match(const optimus::less<V>&, const T& min, const T&, const U& bound) {
+    return min < bound;
+}
+
+template <typename V, typename T, typename U>
+constexpr bool block_may_match(const optimus::less_equal<V>&, const T& min, const T&, const U& bound) {
+    return min <= bound;
+}
+
+template <typename V, typename T, typename U>
+constexpr bool block_may_match(const optimus::greater<V>&, const T&, const T& max, const U& bound) {
+    return max > bound;
+}
+
+template <typename V, typename T, typename U>
+constexpr bool block_may_match(const optimus::greater_equal<V>&, const T&, const T& max, const U& bound) {
+    return max >= bound;
+}
+
+template <typename V, typename T, typename U>
+constexpr bool block_may_match(const optimus::equal_to<V>&, const T& min, const T& max, const U& bound) {
+    return min <= bound && bound <= max;
+}
+
+// The columns a projection reads.
+template <typename Projection>
+struct projection_columns;
+
+template <::std::size_t Index>
+struct projection_columns<optimus::get<Index>> {
+    using type = index_sequence<Index>;
+};
+
+template <::std::size_t... Indices>
+struct projection_columns<optimus::variadic<optimus::get<Indices>...>> {
+    using type = index_sequence<Indices...>;
+};
+
+struct all_rows {
+    constexpr bool operator()(::std::size_t) const {
+        return true;
+    }
+};
+
+// Calls `fn` with the projected values of each row in [first, last) which
+// passes `filter`. `columns` holds a pointer to each projected column.
+template <typename Columns, typename Filter, typename Fn, ::std::size_t... Positions>
+void scan_rows(const Columns& columns, ::std::size_t first, ::std::size_t last,
+               const Filter& filter, Fn& fn, index_sequence<Positions...>) {
+    for (::std::size_t row = first; row < last; ++row) {
+        if (filter(row)) {
+            fn(::std::get<Positions>(columns)[row]...);
+        }
+    }
+}
+
+template <typename... Types, typename Filter, typename Fn, ::std::size_t... Indices>
+void scan_projection(const columnar_file_view<Types...>& view, ::std::size_t first, ::std::size_t last,
+                     const Filter& filter, Fn& fn, index_sequence<Indices...>) {
+    scan_rows(::std::make_tuple(view.template column<Indices>().data()...), first, last, filter, fn,
+              make_index_sequence<sizeof...(Indices)>{});
+}
+
+template <typename T, typename Predicate>
+struct column_filter {
+    const T* column;
+    const Predicate& predicate;
+
+    bool operator()(::std::size_t row) const {
+        return predicate(column[row]);
+    }
+};
+
+} // namespace detail
+
+/**
+ * Calls `fn` for each row of `view` with the columns that `Projection`
+ * picks out of it, i.e. with the arguments `Projection::apply<Fn>` would
+ * pass on: `scan<get<2>>(view, fn)` calls `fn(c2)`, and
+ * `scan<variadic<get<0>, get<3>>>(view, fn)` calls `fn(c0, c3)`. Only the
+ * projected columns are read. Returns `fn`.
+ */
+template <typename Projection, typename... Types, typename Fn>
+Fn scan(const columnar_file_view<Types...>& view, Fn fn) {
+    detail::scan_projection(view, 0, view.size(), detail::all_rows{}, fn,
+                            typename detail::projection_columns<Projection>::type{});
+    return fn;
+}
+
+/**
+ * As above, restricted to the rows which satisfy `predicate`. Blocks which
+ * the statistics of the predicate's column rule out are skipped without
+ * reading any of their rows.
+ */
+template <typename Projection, typename... Types, ::std::size_t Column, typename Compare, typename T,
+          typename Fn>
+Fn scan(const columnar_file_view<Types...>& view, const column_predicate<Column, Compare, T>& predicate,
+        Fn fn) {
+    using column_type = typename columnar_file_view<Types...>::template column_type<Column>;
+    const column_view<column_type> column = view.template column<Column>();
+    const detail::column_filter<column_type, column_predicate<Column, Compare, T>> filter{
+        column.data(), predicate};
+    for (::std::size_t block = 0; block < column.block_count(); ++block) {
+        if (!detail::block_may_match(predicate.compare, column.block_min(block),
+                                     column.block_max(block), predicate.value)) {
+            continue;
+        }
+        const ::std::size_t first = block * column.block_rows();
+        const ::std::size_t last = first + column.block_rows() < column.size()
+            ? first + column.block_rows()
+            : column.size();
+        detail::scan_projection(view, first, last, filter, fn,
+                                typename detail::projection_columns<Projection>::type{});
+    }
+    return fn;
+}
+
+} // namespace optimus
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #include <optimus/traits.h>
@@ -8,7 +10,7 @@
 namespace optimus {
 
 #define OPTIMUS_MAKE_FUNCTION_CONSTRUCTORS(Class) \
-    constexpr Class() { } \
+    constexpr Class() noexcept { } \
     constexpr Class(Class const&) = default; \
     constexpr Class(Class &&) = default;
 /*
@@ -30,10 +32,11 @@ struct constant {
     using result_type = T;
 
     template <typename... Args, typename = safe_forwarding_constructor_t<constant, Args...>>
-    explicit constexpr constant(Args&&... args) : v_(optimus::forward<Args>(args)...) { }
+    explicit constexpr constant(Args&&... args) noexcept(::std::is_nothrow_constructible<T, Args&&...>::value)
+            : v_(optimus::forward<Args>(args)...) { }
 
     template <typename... Args>
-    constexpr T operator()(Args&&...) const {
+    constexpr T operator()(Args&&...) const noexcept(::std::is_nothrow_copy_constructible<T>::value) {
         return v_;
     }
 
@@ -47,11 +50,38 @@ struct constant<::std::integral_constant<Integral, Value>> {
     using result_type = Integral;
 
     template <typename... Args>
-    constexpr Integral operator()(Args&&...) const {
+    constexpr Integral operator()(Args&&...) const noexcept {
         return Value;
     }
 };
 
+/**
+ * As constant, but returns a reference to the value it holds instead of a
+ * copy of it, for values which are expensive to copy: a
+ * constant<std::string> copies, and may allocate, on every call, where a
+ * constant_ref<std::string> does not. The reference lives as long as the
+ * constant_ref.
+ */
+template <typename T>
+struct constant_ref {
+    constexpr constant_ref() = delete;
+    constexpr constant_ref(const constant_ref&) = default;
+    constexpr constant_ref(constant_ref&&) = default;
+
+    using result_type = const T&;
+
+    template <typename... Args, typename = safe_forwarding_constructor_t<constant_ref, Args...>>
+    explicit constexpr constant_ref(Args&&... args) noexcept(::std::is_nothrow_constructible<T, Args&&...>::value)
+            : v_(optimus::forward<Args>(args)...) { }
+
+    template <typename... Args>
+    constexpr const T& operator()(Args&&...) const noexcept {
+        return v_;
+    }
+
+    T v_;
+};
+
 #define OPTIMUS_BINARY_COMPARISON_FUNCTION_IMPL(Class, Op, Result) \
     template <typename T> \
     struct Class { \
@@ -61,7 +91,8 @@ struct constant<::std::integral_constant<Integral, Value>> {
         using first_argument_type = T; \
         using second_argument_type = T; \
         \
-        constexpr result_type operator()(const T& lhs, const T& rhs) const { \
+        constexpr result_type operator()(const T& lhs, const T& rhs) const \
+                noexcept(noexcept(result_type(::std::declval<const T&>() Op ::std::declval<const T&>()))) { \
             return lhs Op rhs; \
         } \
     };
@@ -74,7 +105,8 @@ struct constant<::std::integral_constant<Integral, Value>> {
         using result_type = Result; \
         using argument_type = T; \
         \
-        constexpr result_type operator()(const T& arg) const { \
+        constexpr result_type operator()(const T& arg) const \
+                noexcept(noexcept(result_type(Op(::std::declval<const T&>())))) { \
             return Op(arg); \
         } \
     };
@@ -118,6 +150,277 @@ OPTIMUS_BINARY_COMPARISON_FUNCTION(bit_xor, ^)
 #undef OPTIMUS_BINARY_COMPARISON_FUNCTION_IMPL
 #undef OPTIMUS_UNARY_COMPARISON_FUNCTION_IMPL
 
+/**
+ * The identity element of a binary operation: the value `value()` for
+ * which op(value(), x) == x for every x, from which a reduction can start
+ * without a first element. Specialize it for other operations.
+ */
+template <typename Op>
+struct identity_element;
+
+#define OPTIMUS_IDENTITY_ELEMENT(Class, Type, Value) \
+    template <typename T> \
+    struct identity_element<Class<T>> { \
+        static constexpr Type value() { \
+            return Value; \
+        } \
+    };
+
+OPTIMUS_IDENTITY_ELEMENT(plus, T, T(0))
+OPTIMUS_IDENTITY_ELEMENT(multiplies, T, T(1))
+OPTIMUS_IDENTITY_ELEMENT(bit_and, T, T(~T(0)))
+OPTIMUS_IDENTITY_ELEMENT(bit_or, T, T(0))
+OPTIMUS_IDENTITY_ELEMENT(bit_xor, T, T(0))
+OPTIMUS_IDENTITY_ELEMENT(logical_and, bool, true)
+OPTIMUS_IDENTITY_ELEMENT(logical_or, bool, false)
+
+#undef OPTIMUS_IDENTITY_ELEMENT
+
+namespace detail {
+
+// Number of bits in the unsigned integer type U.
+template <typename U>
+using bit_width = ::std::integral_constant<unsigned, 8 * sizeof(U)>;
+
+// Upper half of the double width product a * b.
+template <typename U>
+constexpr U mulhi(U a, U b, ::std::true_type /* fits in 64 bits */) {
+    return U((::std::uint64_t(a) * b) >> bit_width<U>::value);
+}
+
+constexpr ::std::uint64_t mulhi64_combine(
+        ::std::uint64_t lo_lo, ::std::uint64_t hi_lo,
+        ::std::uint64_t lo_hi, ::std::uint64_t hi_hi) {
+    return hi_hi + (hi_lo >> 32) +
+        (((lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi) >> 32);
+}
+
+template <typename U>
+constexpr U mulhi(U a, U b, ::std::false_type /* fits in 64 bits */) {
+#if defined(__SIZEOF_INT128__)
+    return U((__extension__ (unsigned __int128)(a) * b) >> 64);
+#else
+    return U(mulhi64_combine(
+            (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu),
+            (a >> 32) * (b & 0xFFFFFFFFu),
+            (a & 0xFFFFFFFFu) * (b >> 32),
+            (a >> 32) * (b >> 32)));
+#endif
+}
+
+template <typename U>
+constexpr U mulhi(U a, U b) {
+    return mulhi(a, b, ::std::integral_constant<bool, (sizeof(U) < 8)>{});
+}
+
+// Smallest l such that 2^l >= d.
+template <typename U>
+constexpr unsigned ceil_log2(U d, unsigned l = 0) {
+    return (l < bit_width<U>::value && (U(1) << l) < d) ? ceil_log2(d, l + 1) : l;
+}
+
+// 2^l modulo 2^bits.
+template <typename U>
+constexpr U pow2_mod(unsigned l) {
+    return l < bit_width<U>::value ? U(U(1) << l) : U(0);
+}
+
+// floor(2^bits * r / d) for r < d, computed one quotient bit at a time so
+// that nothing wider than U is needed.
+template <typename U>
+constexpr U long_divide(U r, U d, unsigned bits, U q = 0) {
+    return bits == 0 ? q :
+        r >= U(d - r) ?
+            long_divide(U(r - (d - r)), d, bits - 1, U((q << 1) | 1)) :
+            long_divide(U(r << 1), d, bits - 1, U(q << 1));
+}
+
+/**
+ * Precomputed reciprocal of an unsigned divisor, following Granlund and
+ * Montgomery, "Division by Invariant Integers using Multiplication".
+ * The quotient of any n by the divisor is
+ *   (t + ((n - t) >> shift1)) >> shift2, with t = mulhi(magic, n)
+ * which handles every divisor (including powers of two and one) without
+ * branching, so a loop of divisions can be vectorized.
+ */
+template <typename U>
+struct unsigned_divisor {
+    static_assert(::std::is_unsigned<U>::value, "unsigned_divisor requires an unsigned type");
+
+    // Promote narrow types to unsigned so the arithmetic never goes
+    // through int.
+    using wide_type = typename ::std::conditional<
+        (sizeof(U) < sizeof(unsigned)), unsigned, U>::type;
+
+    explicit constexpr unsigned_divisor(U d)
+            : magic_(U(long_divide(U(pow2_mod<U>(ceil_log2(d)) - d), d, bit_width<U>::value) + 1)),
+              shift1_(ceil_log2(d) < 1 ? ceil_log2(d) : 1),
+              shift2_(ceil_log2(d) < 1 ? 0 : ceil_log2(d) - 1) { }
+
+    constexpr unsigned_divisor(const unsigned_divisor&) = default;
+    constexpr unsigned_divisor(unsigned_divisor&&) = default;
+
+    constexpr U quotient(U n) const {
+        return quotient_impl(n, mulhi<U>(magic_, n));
+    }
+
+    constexpr U quotient_impl(U n, U t) const {
+        return U((wide_type(t) + (wide_type(U(n - t)) >> shift1_)) >> shift2_);
+    }
+
+    U magic_;
+    unsigned char shift1_;
+    unsigned char shift2_;
+};
+
+template <typename T>
+using make_unsigned_t = typename ::std::make_unsigned<T>::type;
+
+template <typename T>
+constexpr make_unsigned_t<T> unsigned_abs(T v) {
+    return v < 0 ? make_unsigned_t<T>(make_unsigned_t<T>(0) - make_unsigned_t<T>(v))
+                 : make_unsigned_t<T>(v);
+}
+
+/**
+ * Divisor of an arbitrary integral type. Signed division divides the
+ * magnitudes and then restores the sign, which truncates towards zero
+ * exactly like the builtin operator.
+ */
+template <typename T, bool = ::std::is_signed<T>::value>
+struct invariant_divisor {
+    explicit constexpr invariant_divisor(T d) : divisor_(d), reciprocal_(d) { }
+
+    constexpr T quotient(T n) const {
+        return reciprocal_.quotient(n);
+    }
+
+    constexpr T remainder(T n) const {
+        return remainder_impl(n, quotient(n));
+    }
+
+    constexpr T remainder_impl(T n, T q) const {
+        using wide_type = typename unsigned_divisor<T>::wide_type;
+        return T(wide_type(n) - wide_type(q) * wide_type(divisor_));
+    }
+
+    T divisor_;
+    unsigned_divisor<T> reciprocal_;
+};
+
+template <typename T>
+struct invariant_divisor<T, true> {
+    using unsigned_type = make_unsigned_t<T>;
+
+    explicit constexpr invariant_divisor(T d)
+            : divisor_(d), reciprocal_(unsigned_abs(d)) { }
+
+    constexpr T quotient(T n) const {
+        return quotient_impl(
+                reciprocal_.quotient(unsigned_abs(n)),
+                (n < 0) != (divisor_ < 0));
+    }
+
+    constexpr T quotient_impl(unsigned_type q, bool negative) const {
+        return T(negative ? unsigned_type(unsigned_type(0) - q) : q);
+    }
+
+    constexpr T remainder(T n) const {
+        return remainder_impl(n, quotient(n));
+    }
+
+    constexpr T remainder_impl(T n, T q) const {
+        using wide_type = typename unsigned_divisor<unsigned_type>::wide_type;
+        return T(unsigned_type(wide_type(unsigned_type(n)) -
+                wide_type(unsigned_type(q)) * wide_type(unsigned_type(divisor_))));
+    }
+
+    T divisor_;
+    unsigned_divisor<unsigned_type> reciprocal_;
+};
+
+} // namespace detail
+
+/**
+ * `divides_by<T>{d}` and `modulus_by<T>{d}` compute `n / d` and `n % d` for
+ * a divisor fixed at construction. The reciprocal of `d` is computed once,
+ * so each call is a multiply, an add and two shifts instead of a hardware
+ * divide. As with `divides`, the behaviour for a zero divisor is undefined.
+ *
+ * The three argument overload transforms the range [first, last) into out
+ * and returns the end of the output, which lets the compiler vectorize the
+ * loop.
+ *
+ * `divides_by<std::integral_constant<T, d>>` takes the divisor as part of
+ * the type, at which point the compiler already knows the reciprocal.
+ */
+#define OPTIMUS_INVARIANT_DIVISOR_FUNCTION(Class, Method) \
+    template <typename T> \
+    struct Class { \
+        static_assert(::std::is_integral<T>::value && !::std::is_same<T, bool>::value, \
+                #Class " requires a non-bool integral type"); \
+        \
+        constexpr Class() = delete; \
+        constexpr Class(const Class&) = default; \
+        constexpr Class(Class&&) = default; \
+        explicit constexpr Class(T divisor) noexcept : divisor_(divisor) { } \
+        \
+        using result_type = T; \
+        using argument_type = T; \
+        \
+        constexpr result_type operator()(const T& arg) const noexcept { \
+            return divisor_.Method(arg); \
+        } \
+        \
+        T* operator()(const T* first, const T* last, T* out) const noexcept { \
+            const detail::invariant_divisor<T> d = divisor_; \
+            for (; first != last; ++first, ++out) { \
+                *out = d.Method(*first); \
+            } \
+            return out; \
+        } \
+        \
+        constexpr T divisor() const { \
+            return divisor_.divisor_; \
+        } \
+        \
+        detail::invariant_divisor<T> divisor_; \
+    };
+
+#define OPTIMUS_CONSTANT_DIVISOR_FUNCTION(Class, Op) \
+    template <typename Integral, Integral Value> \
+    struct Class<::std::integral_constant<Integral, Value>> { \
+        static_assert(Value != 0, #Class " requires a non-zero divisor"); \
+        \
+        OPTIMUS_MAKE_FUNCTION_CONSTRUCTORS(Class) \
+        \
+        using result_type = Integral; \
+        using argument_type = Integral; \
+        \
+        constexpr result_type operator()(const Integral& arg) const noexcept { \
+            return arg Op Value; \
+        } \
+        \
+        Integral* operator()(const Integral* first, const Integral* last, Integral* out) const noexcept { \
+            for (; first != last; ++first, ++out) { \
+                *out = *first Op Value; \
+            } \
+            return out; \
+        } \
+        \
+        constexpr Integral divisor() const { \
+            return Value; \
+        } \
+    };
+
+OPTIMUS_INVARIANT_DIVISOR_FUNCTION(divides_by, quotient)
+OPTIMUS_INVARIANT_DIVISOR_FUNCTION(modulus_by, remainder)
+OPTIMUS_CONSTANT_DIVISOR_FUNCTION(divides_by, /)
+OPTIMUS_CONSTANT_DIVISOR_FUNCTION(modulus_by, %)
+
+#undef OPTIMUS_INVARIANT_DIVISOR_FUNCTION
+#undef OPTIMUS_CONSTANT_DIVISOR_FUNCTION
+
 template <template <typename...> class BinOp, typename TArg, typename... TArgs>
 struct foldr1 {
   using type = typename BinOp<TArg, typename foldr1<BinOp, TArgs...>::type>::type;
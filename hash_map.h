@@ -0,0 +1,446 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <optimus/utility.h>
+
+namespace optimus {
+
+namespace detail {
+
+// Each slot of a flat_hash_map has a control byte: `hash_empty` or the low 7
+// bits of the hash of the key stored there.
+using hash_ctrl_t = signed char;
+
+constexpr hash_ctrl_t hash_empty = -128;
+constexpr ::std::size_t hash_group_width = 16;
+
+// Spreads the bits of a hash with a single wide multiply, folding the high
+// half of the product into the low half.
+inline ::std::uint64_t hash_fold(::std::uint64_t x) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128_t;
+    const uint128_t product = uint128_t(x) * 0x9e3779b97f4a7c15ull;
+    return ::std::uint64_t(product) ^ ::std::uint64_t(product >> 64);
+#else
+    return hash_mix(x);
+#endif
+}
+
+// The control bytes of `hash_group_width` consecutive slots, which are
+// matched against a tag all at once.
+class hash_group {
+  public:
+#if defined(__SSE2__)
+    explicit hash_group(const hash_ctrl_t* ctrl)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) { }
+
+    // Bit i is set if slot i holds `tag`.
+    ::std::uint32_t match(hash_ctrl_t tag) const {
+        return ::std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl_)));
+    }
+
+    // Bit i is set if slot i is empty.
+    ::std::uint32_t match_empty() const {
+        return ::std::uint32_t(_mm_movemask_epi8(ctrl_));
+    }
+
+  private:
+    __m128i ctrl_;
+#else
+    explicit hash_group(const hash_ctrl_t* ctrl) {
+        ::std::memcpy(ctrl_, ctrl, hash_group_width);
+    }
+
+    ::std::uint32_t match(hash_ctrl_t tag) const {
+        ::std::uint32_t mask = 0;
+        for (::std::size_t i = 0; i < hash_group_width; ++i) {
+            mask |= ::std::uint32_t(ctrl_[i] == tag) << i;
+        }
+        return mask;
+    }
+
+    ::std::uint32_t match_empty() const {
+        return match(hash_empty);
+    }
+
+  private:
+    hash_ctrl_t ctrl_[hash_group_width];
+#endif
+};
+
+} // namespace detail
+
+/**
+ * An insert-only hash map with open addressing, for building aggregates and
+ * join tables. Entries live in one flat array next to an array of control
+ * bytes holding 7 bits of each key's hash; a lookup compares the tag
+ * against a whole group of 16 control bytes at once (with SSE2 where
+ * available) and only touches the entries whose tag matches, so there is no
+ * allocation per entry and no pointer chasing.
+ *
+ * Groups are probed quadratically and the table grows by doubling once it
+ * is 7/8 full; `reserve` sizes it up front. The hash of `Hash` is mixed
+ * before use, so ::std::hash of integers, which is usually the identity, is
+ * fine. Entries cannot be erased, and references to them are invalidated
+ * when the table grows. Both arrays come from `Allocator`, the control
+ * bytes through its rebind.
+ */
+template <
+    typename Key,
+    typename Value,
+    typename Hash = ::std::hash<Key>,
+    typename Allocator = ::std::allocator<::std::pair<Key, Value>>
+>
+class flat_hash_map {
+    using slot_traits = ::std::allocator_traits<Allocator>;
+    using ctrl_allocator = typename slot_traits::template rebind_alloc<detail::hash_ctrl_t>;
+    using ctrl_traits = ::std::allocator_traits<ctrl_allocator>;
+
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = ::std::pair<Key, Value>;
+    using size_type = ::std::size_t;
+    using hasher = Hash;
+    using allocator_type = Allocator;
+
+    template <bool Const>
+    class basic_iterator {
+      public:
+        using iterator_category = ::std::forward_iterator_tag;
+        using value_type = flat_hash_map::value_type;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = typename ::std::conditional<Const, const value_type*, value_type*>::type;
+        using reference = typename ::std::conditional<Const, const value_type&, value_type&>::type;
+
+        basic_iterator() : ctrl_(nullptr), slot_(nullptr), end_(nullptr) { }
+
+        // Allows conversion from iterator to const_iterator.
+        basic_iterator(const basic_iterator<false>& other)
+            : ctrl_(other.ctrl_), slot_(other.slot_), end_(other.end_) { }
+
+        reference operator*() const { return *slot_; }
+        pointer operator->() const { return slot_; }
+
+        basic_iterator& operator++() {
+            ++ctrl_;
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) {
+            return lhs.ctrl_ == rhs.ctrl_;
+        }
+
+        friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) {
+            return lhs.ctrl_ != rhs.ctrl_;
+        }
+
+      private:
+        friend class flat_hash_map;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(const detail::hash_ctrl_t* ctrl, pointer slot, const detail::hash_ctrl_t* end)
+                : ctrl_(ctrl), slot_(slot), end_(end) {
+            skip_empty();
+        }
+
+        void skip_empty() {
+            for (; ctrl_ != end_ && *ctrl_ == detail::hash_empty; ++ctrl_, ++slot_) { }
+        }
+
+        const detail::hash_ctrl_t* ctrl_;
+        pointer slot_;
+        const detail::hash_ctrl_t* end_;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    explicit flat_hash_map(size_type expected = 0, const Hash& hash = Hash{},
+                           const Allocator& alloc = Allocator{})
+            : hash_(hash), alloc_(alloc), ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0),
+              growth_left_(0) {
+        reserve(expected);
+    }
+
+    flat_hash_map(const flat_hash_map& other)
+            : hash_(other.hash_),
+              alloc_(slot_traits::select_on_container_copy_construction(other.alloc_)),
+              ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), growth_left_(0) {
+        reserve(other.size_);
+        for (const value_type& entry : other) {
+            emplace_new(hash_of(entry.first), entry);
+        }
+    }
+
+    flat_hash_map(flat_hash_map&& other) noexcept
+            : hash_(optimus::move(other.hash_)),
+              alloc_(optimus::move(other.alloc_)),
+              ctrl_(other.ctrl_),
+              slots_(other.slots_),
+              capacity_(other.capacity_),
+              size_(other.size_),
+              growth_left_(other.growth_left_) {
+        other.ctrl_ = nullptr;
+        other.slots_ = nullptr;
+        other.capacity_ = other.size_ = other.growth_left_ = 0;
+    }
+
+    flat_hash_map& operator=(flat_hash_map other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~flat_hash_map() {
+        release();
+    }
+
+    void swap(flat_hash_map& other) noexcept {
+        using ::std::swap;
+        swap(hash_, other.hash_);
+        swap(alloc_, other.alloc_);
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(capacity_, other.capacity_);
+        swap(size_, other.size_);
+        swap(growth_left_, other.growth_left_);
+    }
+
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_type capacity() const { return capacity_; }
+    allocator_type get_allocator() const { return alloc_; }
+
+    iterator begin() { return iterator{ctrl_, slots_, ctrl_ + capacity_}; }
+    iterator end() { return iterator{ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_}; }
+    const_iterator begin() const { return const_iterator{ctrl_, slots_, ctrl_ + capacity_}; }
+    const_iterator end() const { return const_iterator{ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_}; }
+
+    // Makes room for `n` entries without growing.
+    void reserve(size_type n) {
+        if (n <= capacity_ - capacity_ / 8) {
+            return;
+        }
+        size_type capacity = detail::hash_group_width;
+        while (capacity - capacity / 8 < n) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+    iterator find(const Key& key) {
+        value_type* slot = find_slot(key, hash_of(key));
+        return slot == nullptr ? end() : iterator_at(slot);
+    }
+
+    const_iterator find(const Key& key) const {
+        value_type* slot = find_slot(key, hash_of(key));
+        return slot == nullptr ? end() : const_iterator{iterator_at(slot)};
+    }
+
+    size_type count(const Key& key) const {
+        return find_slot(key, hash_of(key)) == nullptr ? 0 : 1;
+    }
+
+    /**
+     * Inserts `key` with a value constructed from `args` unless it is
+     * already present. Returns the entry of `key` and whether it was
+     * inserted.
+     */
+    template <typename... Args>
+    ::std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        const ::std::size_t hash = hash_of(key);
+        value_type* slot = find_slot(key, hash);
+        if (slot != nullptr) {
+            return ::std::make_pair(iterator_at(slot), false);
+        }
+        slot = emplace_new(hash, ::std::piecewise_construct,
+                           ::std::forward_as_tuple(key),
+                           ::std::forward_as_tuple(optimus::forward<Args>(args)...));
+        return ::std::make_pair(iterator_at(slot), true);
+    }
+
+    ::std::pair<iterator, bool> insert(const value_type& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    Value& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    /**
+     * Inserts `key` with `value`, or if it is already present replaces its
+     * value `v` with `op(v, value)`.
+     */
+    template <typename V, typename Op>
+    void accumulate(const Key& key, V&& value, const Op& op) {
+        accumulate(hash_of(key), key, optimus::forward<V>(value), op);
+    }
+
+    // As above, with `hash` the result of `hash_of(key)`.
+    template <typename V, typename Op>
+    void accumulate(::std::size_t hash, const Key& key, V&& value, const Op& op) {
+        value_type* slot = find_slot(key, hash);
+        if (slot != nullptr) {
+            slot->second = op(optimus::move(slot->second), optimus::forward<V>(value));
+        } else {
+            emplace_new(hash, key, optimus::forward<V>(value));
+        }
+    }
+
+    // The mixed hash of `key`, as used to place it.
+    ::std::size_t hash_of(const Key& key) const {
+        return ::std::size_t(detail::hash_fold(::std::uint64_t(hash_(key))));
+    }
+
+  private:
+    static detail::hash_ctrl_t tag_of(::std::size_t hash) {
+        return detail::hash_ctrl_t(hash & 0x7F);
+    }
+
+    iterator iterator_at(value_type* slot) const {
+        const ::std::size_t i = ::std::size_t(slot - slots_);
+        return iterator{ctrl_ + i, slots_ + i, ctrl_ + capacity_};
+    }
+
+    // The entry of `key`, probing the groups of `hash` until one has an
+    // empty slot.
+    value_type* find_slot(const Key& key, ::std::size_t hash) const {
+        if (capacity_ == 0) {
+            return nullptr;
+        }
+        const ::std::size_t group_mask = capacity_ / detail::hash_group_width - 1;
+        const detail::hash_ctrl_t tag = tag_of(hash);
+        ::std::size_t group = (hash >> 7) & group_mask;
+        for (::std::size_t step = 1; ; ++step) {
+            const ::std::size_t base = group * detail::hash_group_width;
+            const detail::hash_group g{ctrl_ + base};
+            for (::std::uint32_t match = g.match(tag); match != 0; match &= match - 1) {
+                value_type* slot = slots_ + base + detail::count_trailing_zeros(match);
+                if (slot->first == key) {
+                    return slot;
+                }
+            }
+            if (g.match_empty() != 0) {
+                return nullptr;
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // The first empty slot in the probe sequence of `hash`.
+    ::std::size_t find_empty(::std::size_t hash) const {
+        const ::std::size_t group_mask = capacity_ / detail::hash_group_width - 1;
+        ::std::size_t group = (hash >> 7) & group_mask;
+        for (::std::size_t step = 1; ; ++step) {
+            const ::std::size_t base = group * detail::hash_group_width;
+            const ::std::uint32_t empty = detail::hash_group{ctrl_ + base}.match_empty();
+            if (empty != 0) {
+                return base + detail::count_trailing_zeros(empty);
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // Inserts an entry for a key which is not in the table.
+    template <typename... Args>
+    value_type* emplace_new(::std::size_t hash, Args&&... args) {
+        if (growth_left_ == 0) {
+            rehash(capacity_ == 0 ? detail::hash_group_width : 2 * capacity_);
+        }
+        const ::std::size_t i = find_empty(hash);
+        value_type* slot = ::new (static_cast<void*>(slots_ + i)) value_type(optimus::forward<Args>(args)...);
+        ctrl_[i] = tag_of(hash);
+        ++size_;
+        --growth_left_;
+        return slot;
+    }
+
+    void rehash(size_type capacity) {
+        detail::hash_ctrl_t* old_ctrl = ctrl_;
+        value_type* old_slots = slots_;
+        const size_type old_capacity = capacity_;
+
+        // Both arrays are allocated before either is published, so that a
+        // failed allocation leaves the table as it was.
+        ctrl_allocator ctrl_alloc(alloc_);
+        detail::hash_ctrl_t* ctrl = ctrl_traits::allocate(ctrl_alloc, capacity);
+        value_type* slots;
+        try {
+            slots = slot_traits::allocate(alloc_, capacity);
+        } catch (...) {
+            ctrl_traits::deallocate(ctrl_alloc, ctrl, capacity);
+            throw;
+        }
+        ::std::memset(ctrl, detail::hash_empty, capacity);
+        ctrl_ = ctrl;
+        slots_ = slots;
+        capacity_ = capacity;
+        growth_left_ = capacity - capacity / 8 - size_;
+
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] != detail::hash_empty) {
+                const ::std::size_t hash = hash_of(old_slots[i].first);
+                const ::std::size_t j = find_empty(hash);
+                ::new (static_cast<void*>(slots_ + j)) value_type(optimus::move(old_slots[i]));
+                ctrl_[j] = tag_of(hash);
+                old_slots[i].~value_type();
+            }
+        }
+        if (old_ctrl != nullptr) {
+            slot_traits::deallocate(alloc_, old_slots, old_capacity);
+            ctrl_traits::deallocate(ctrl_alloc, old_ctrl, old_capacity);
+        }
+    }
+
+    void release() {
+        if (ctrl_ == nullptr) {
+            return;
+        }
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] != detail::hash_empty) {
+                slots_[i].~value_type();
+            }
+        }
+        slot_traits::deallocate(alloc_, slots_, capacity_);
+        ctrl_allocator ctrl_alloc(alloc_);
+        ctrl_traits::deallocate(ctrl_alloc, ctrl_, capacity_);
+    }
+
+    Hash hash_;
+    Allocator alloc_;
+    detail::hash_ctrl_t* ctrl_;
+    value_type* slots_;
+    size_type capacity_;
+    size_type size_;
+    size_type growth_left_;
+};
+
+template <typename Key, typename Value, typename Hash, typename Allocator>
+void swap(flat_hash_map<Key, Value, Hash, Allocator>& lhs,
+          flat_hash_map<Key, Value, Hash, Allocator>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // namespace optimus
@@ -0,0 +1,536 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <optimus/hash_map.h>
+#include <optimus/parallel.h>
+#include <optimus/traits.h>
+#include <optimus/tuple_core.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Rows per radix partition of a hash join, chosen so that a partition's
+// share of the table stays in the L2 cache.
+constexpr ::std::size_t join_partition_rows = 8192;
+
+// Most radix bits partitioned on in one pass; more would thrash the TLB.
+constexpr unsigned join_max_radix_bits = 8;
+
+namespace detail {
+
+struct join_entry {
+    ::std::uint64_t hash;
+    ::std::size_t index;
+};
+
+inline unsigned join_radix_bits(::std::size_t rows, ::std::size_t threads) {
+    unsigned bits = 0;
+    while (bits < join_max_radix_bits
+            && ((rows >> bits) > join_partition_rows || (::std::size_t(1) << bits) < 4 * threads)) {
+        ++bits;
+    }
+    return bits;
+}
+
+inline ::std::size_t radix_of(::std::uint64_t hash, unsigned bits) {
+    return bits == 0 ? 0 : ::std::size_t(hash >> (64 - bits));
+}
+
+/**
+ * Scatters `in` into `out` by the top `bits` bits of the hash, preserving
+ * the order within a partition, and returns the offset of each partition
+ * in `out` followed by the total. Each of `threads` threads histograms and
+ * scatters a slice of `in` into its own region of every partition.
+ */
+inline ::std::vector<::std::size_t> radix_partition(const ::std::vector<join_entry>& in,
+                                                   ::std::vector<join_entry>& out,
+                                                   unsigned bits, ::std::size_t threads) {
+    const ::std::size_t partitions = ::std::size_t(1) << bits;
+    const ::std::size_t n = in.size();
+    threads = ::std::max<::std::size_t>(1, ::std::min(threads, n / join_partition_rows));
+    ::std::vector<::std::size_t> histograms(threads * partitions, 0);
+    run_threads(threads, [&](::std::size_t t) {
+        ::std::size_t* histogram = histograms.data() + t * partitions;
+        for (::std::size_t i = n * t / threads; i < n * (t + 1) / threads; ++i) {
+            ++histogram[radix_of(in[i].hash, bits)];
+        }
+    });
+
+    ::std::vector<::std::size_t> offsets(partitions + 1);
+    ::std::size_t offset = 0;
+    for (::std::size_t p = 0; p < partitions; ++p) {
+        offsets[p] = offset;
+        for (::std::size_t t = 0; t < threads; ++t) {
+            const ::std::size_t count = histograms[t * partitions + p];
+            histograms[t * partitions + p] = offset;
+            offset += count;
+        }
+    }
+    offsets[partitions] = offset;
+
+    out.resize(n);
+    run_threads(threads, [&](::std::size_t t) {
+        ::std::size_t* cursor = histograms.data() + t * partitions;
+        for (::std::size_t i = n * t / threads; i < n * (t + 1) / threads; ++i) {
+            out[cursor[radix_of(in[i].hash, bits)]++] = in[i];
+        }
+    });
+    return offsets;
+}
+
+// Runs `fn(p)` for each of `count` partitions, handed out to `threads`
+// threads as they become free.
+template <typename Fn>
+void for_each_partition(::std::size_t count, ::std::size_t threads, const Fn& fn) {
+    ::std::atomic<::std::size_t> next{0};
+    run_threads(::std::max<::std::size_t>(1, ::std::min(threads, count)), [&](::std::size_t) {
+        for (::std::size_t p = next++; p < count; p = next++) {
+            fn(p);
+        }
+    });
+}
+
+template <typename Key>
+::std::uint64_t join_hash(const Key& key) {
+    return hash_fold(::std::uint64_t(::std::hash<Key>{}(key)));
+}
+
+} // namespace detail
+
+/**
+ * The pairs of rows of two ranges whose keys are equal, made by hash_join.
+ * Iterating yields, lazily, an optimus::tuple of references to the left
+ * and right rows (as optimus::tie would), so get<0> and get<1> and their
+ * transformers apply to it, as they do to the rows of a zip. Pairs come
+ * out grouped by radix partition, not in the order of either range.
+ *
+ * The right range is the build side: its rows are hashed, radix
+ * partitioned on the top bits of the hash into partitions which fit in
+ * cache, then bucketed within each partition into one flat array with no
+ * pointers. The left rows are partitioned the same way, so the probes of a
+ * partition only ever touch that partition's buckets. Both ranges must be
+ * random access and outlive the join.
+ */
+template <typename LeftIterator, typename RightIterator, typename LeftKey, typename RightKey>
+class hash_join_range {
+  public:
+    using left_reference = typename ::std::iterator_traits<LeftIterator>::reference;
+    using right_reference = typename ::std::iterator_traits<RightIterator>::reference;
+    using key_type = typename ::std::decay<result_of_t<const RightKey(right_reference)>>::type;
+    using value_type = optimus::tuple<left_reference, right_reference>;
+
+    class iterator {
+      public:
+        using iterator_category = ::std::input_iterator_tag;
+        using value_type = hash_join_range::value_type;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        iterator() : join_(nullptr), probe_(0), entry_(0), entry_end_(0) { }
+
+        reference operator*() const {
+            return join_->pair(join_->probes_[probe_].index, join_->entries_[entry_].index);
+        }
+
+        iterator& operator++() {
+            ++entry_;
+            settle();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.probe_ == rhs.probe_ && lhs.entry_ == rhs.entry_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+      private:
+        friend class hash_join_range;
+
+        iterator(const hash_join_range* join, ::std::size_t probe)
+                : join_(join), probe_(probe), entry_(0), entry_end_(0) {
+            if (probe_ < join_->probes_.size()) {
+                load_bucket();
+                settle();
+            }
+        }
+
+        void load_bucket() {
+            const ::std::size_t bucket = join_->bucket_of(join_->probes_[probe_].hash);
+            entry_ = join_->buckets_[bucket];
+            entry_end_ = join_->buckets_[bucket + 1];
+        }
+
+        // Moves to the next match at or after the current entry.
+        void settle() {
+            for (;;) {
+                for (; entry_ < entry_end_; ++entry_) {
+                    if (join_->matches(join_->probes_[probe_], join_->entries_[entry_])) {
+                        return;
+                    }
+                }
+                if (++probe_ == join_->probes_.size()) {
+                    entry_ = entry_end_ = 0;
+                    return;
+                }
+                load_bucket();
+            }
+        }
+
+        const hash_join_range* join_;
+        ::std::size_t probe_;
+        ::std::size_t entry_;
+        ::std::size_t entry_end_;
+    };
+
+    hash_join_range(LeftIterator left, ::std::size_t left_size, RightIterator right, ::std::size_t right_size,
+                    LeftKey left_key, RightKey right_key, ::std::size_t threads)
+            : left_(left), right_(right), left_key_(optimus::move(left_key)), right_key_(optimus::move(right_key)) {
+        threads = ::std::max<::std::size_t>(1, threads);
+        radix_bits_ = detail::join_radix_bits(right_size, threads);
+        bucket_bits_ = radix_bits_;
+        while (bucket_bits_ < 63 && (::std::size_t(1) << bucket_bits_) < right_size) {
+            ++bucket_bits_;
+        }
+        build(right_size, threads);
+        partition_probes(left_size, threads);
+    }
+
+    iterator begin() const {
+        return iterator{this, 0};
+    }
+
+    iterator end() const {
+        return iterator{this, probes_.size()};
+    }
+
+    /**
+     * Calls `fn` with every pair, from `threads` threads at once, each
+     * taking whole partitions; so `fn` must be safe to call concurrently.
+     * Returns `fn`.
+     */
+    template <typename Fn>
+    Fn parallel_for_each(Fn fn, ::std::size_t threads = ::std::thread::hardware_concurrency()) const {
+        const ::std::size_t partitions = probe_partitions_.size() - 1;
+        detail::for_each_partition(partitions, threads, [&](::std::size_t p) {
+            for (::std::size_t i = probe_partitions_[p]; i < probe_partitions_[p + 1]; ++i) {
+                const detail::join_entry& probe = probes_[i];
+                const ::std::size_t bucket = bucket_of(probe.hash);
+                for (::std::size_t e = buckets_[bucket]; e < buckets_[bucket + 1]; ++e) {
+                    if (matches(probe, entries_[e])) {
+                        fn(pair(probe.index, entries_[e].index));
+                    }
+                }
+            }
+        });
+        return fn;
+    }
+
+  private:
+    ::std::size_t bucket_of(::std::uint64_t hash) const {
+        return detail::radix_of(hash, bucket_bits_);
+    }
+
+    value_type pair(::std::size_t left, ::std::size_t right) const {
+        return value_type{left_[::std::ptrdiff_t(left)], right_[::std::ptrdiff_t(right)]};
+    }
+
+    bool matches(const detail::join_entry& probe, const detail::join_entry& entry) const {
+        return probe.hash == entry.hash
+            && key_type(left_key_(left_[::std::ptrdiff_t(probe.index)]))
+                == right_key_(right_[::std::ptrdiff_t(entry.index)]);
+    }
+
+    template <typename Fn>
+    ::std::vector<detail::join_entry> hash_rows(::std::size_t n, ::std::size_t threads, const Fn& hash) const {
+        ::std::vector<detail::join_entry> rows(n);
+        threads = ::std::max<::std::size_t>(1, ::std::min(threads, n / join_partition_rows));
+        detail::run_threads(threads, [&](::std::size_t t) {
+            for (::std::size_t i = n * t / threads; i < n * (t + 1) / threads; ++i) {
+                rows[i] = detail::join_entry{hash(i), i};
+            }
+        });
+        return rows;
+    }
+
+    void build(::std::size_t n, ::std::size_t threads) {
+        const ::std::vector<detail::join_entry> rows = hash_rows(n, threads, [this](::std::size_t i) {
+            return detail::join_hash(key_type(right_key_(right_[::std::ptrdiff_t(i)])));
+        });
+        ::std::vector<detail::join_entry> partitioned;
+        const ::std::vector<::std::size_t> partitions =
+            detail::radix_partition(rows, partitioned, radix_bits_, threads);
+
+        // Each partition owns a contiguous range of buckets, which are
+        // counted and filled within the partition, in cache.
+        const unsigned local_bits = bucket_bits_ - radix_bits_;
+        buckets_.assign((::std::size_t(1) << bucket_bits_) + 1, 0);
+        entries_.resize(n);
+        detail::for_each_partition(partitions.size() - 1, threads, [&](::std::size_t p) {
+            ::std::size_t* buckets = buckets_.data() + (p << local_bits);
+            const ::std::size_t bucket_count = ::std::size_t(1) << local_bits;
+            for (::std::size_t i = partitions[p]; i < partitions[p + 1]; ++i) {
+                ++buckets[bucket_of(partitioned[i].hash) - (p << local_bits)];
+            }
+            ::std::size_t offset = partitions[p];
+            for (::std::size_t b = 0; b < bucket_count; ++b) {
+                const ::std::size_t count = buckets[b];
+                buckets[b] = offset;
+                offset += count;
+            }
+            for (::std::size_t i = partitions[p]; i < partitions[p + 1]; ++i) {
+                entries_[buckets[bucket_of(partitioned[i].hash) - (p << local_bits)]++] = partitioned[i];
+            }
+            // The cursors now hold the end of each bucket; shift back.
+            for (::std::size_t b = bucket_count; b-- > 1; ) {
+                buckets[b] = buckets[b - 1];
+            }
+            buckets[0] = partitions[p];
+        });
+        buckets_.back() = n;
+    }
+
+    void partition_probes(::std::size_t n, ::std::size_t threads) {
+        const ::std::vector<detail::join_entry> rows = hash_rows(n, threads, [this](::std::size_t i) {
+            return detail::join_hash(key_type(left_key_(left_[::std::ptrdiff_t(i)])));
+        });
+        probe_partitions_ = detail::radix_partition(rows, probes_, radix_bits_, threads);
+    }
+
+    LeftIterator left_;
+    RightIterator right_;
+    LeftKey left_key_;
+    RightKey right_key_;
+    unsigned radix_bits_;
+    unsigned bucket_bits_;
+    // The build rows, ordered by bucket; bucket b is
+    // entries_[buckets_[b], buckets_[b + 1]).
+    ::std::vector<detail::join_entry> entries_;
+    ::std::vector<::std::size_t> buckets_;
+    // The probe rows, ordered by partition.
+    ::std::vector<detail::join_entry> probes_;
+    ::std::vector<::std::size_t> probe_partitions_;
+};
+
+/**
+ * Joins the rows of `left` and `right` whose keys, as projected by
+ * `LeftKey` and `RightKey` (e.g. optimus::get<0> and optimus::at<...>), are
+ * equal. The right range is built into the hash table, so it should be the
+ * smaller. `threads` threads build the table and partition the probes.
+ *
+ *   for (auto pair : optimus::hash_join<optimus::get<0>, optimus::get<1>>(orders, customers)) {
+ *       use(std::get<0>(pair), std::get<1>(pair));
+ *   }
+ */
+template <typename LeftKey, typename RightKey, typename LeftRange, typename RightRange>
+hash_join_range<decltype(::std::begin(::std::declval<const LeftRange&>())),
+                decltype(::std::begin(::std::declval<const RightRange&>())),
+                LeftKey, RightKey>
+hash_join(const LeftRange& left, const RightRange& right,
+          LeftKey left_key = LeftKey{}, RightKey right_key = RightKey{}, ::std::size_t threads = 1) {
+    return {::std::begin(left), ::std::size_t(::std::end(left) - ::std::begin(left)),
+            ::std::begin(right), ::std::size_t(::std::end(right) - ::std::begin(right)),
+            optimus::move(left_key), optimus::move(right_key), threads};
+}
+
+/**
+ * The pairs of rows of two ranges, both sorted by their keys, whose keys
+ * are equal, made by merge_join. Iterating walks both ranges once, lazily,
+ * yielding an optimus::tuple of references to the left and right rows for
+ * each pair (every combination, where keys repeat), in key order. Keys are
+ * ordered by `<`.
+ */
+template <typename LeftIterator, typename RightIterator, typename LeftKey, typename RightKey>
+class merge_join_range {
+  public:
+    using left_reference = typename ::std::iterator_traits<LeftIterator>::reference;
+    using right_reference = typename ::std::iterator_traits<RightIterator>::reference;
+    using value_type = optimus::tuple<left_reference, right_reference>;
+
+    class iterator {
+      public:
+        using iterator_category = ::std::input_iterator_tag;
+        using value_type = merge_join_range::value_type;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        iterator() : join_(nullptr) { }
+
+        reference operator*() const {
+            return value_type{*left_, *right_};
+        }
+
+        iterator& operator++() {
+            if (++right_ != run_end_) {
+                return *this;
+            }
+            // The next left row joins the same run if it has the same key.
+            const LeftIterator previous = left_++;
+            if (left_ != left_end_ && !join_->less(join_->left_key_(*previous), join_->left_key_(*left_))) {
+                right_ = run_begin_;
+                return *this;
+            }
+            run_begin_ = run_end_;
+            settle();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.left_ == rhs.left_ && (lhs.left_ == lhs.left_end_ || lhs.right_ == rhs.right_);
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+      private:
+        friend class merge_join_range;
+
+        iterator(const merge_join_range* join, LeftIterator left, LeftIterator left_end,
+                 RightIterator right, RightIterator right_end)
+                : join_(join), left_(left), left_end_(left_end),
+                  run_begin_(right), run_end_(right), right_(right), right_end_(right_end) {
+            settle();
+        }
+
+        // Finds the next left row with a run of right rows of equal key.
+        void settle() {
+            while (left_ != left_end_ && run_begin_ != right_end_) {
+                const auto left_key = join_->left_key_(*left_);
+                const auto right_key = join_->right_key_(*run_begin_);
+                if (join_->less(left_key, right_key)) {
+                    ++left_;
+                } else if (join_->less(right_key, left_key)) {
+                    ++run_begin_;
+                } else {
+                    run_end_ = run_begin_;
+                    while (run_end_ != right_end_ && !join_->less(left_key, join_->right_key_(*run_end_))) {
+                        ++run_end_;
+                    }
+                    right_ = run_begin_;
+                    return;
+                }
+            }
+            left_ = left_end_;
+        }
+
+        const merge_join_range* join_;
+        LeftIterator left_;
+        LeftIterator left_end_;
+        RightIterator run_begin_;
+        RightIterator run_end_;
+        RightIterator right_;
+        RightIterator right_end_;
+    };
+
+    merge_join_range(LeftIterator left_first, LeftIterator left_last,
+                     RightIterator right_first, RightIterator right_last,
+                     LeftKey left_key, RightKey right_key)
+        : left_first_(left_first), left_last_(left_last),
+          right_first_(right_first), right_last_(right_last),
+          left_key_(optimus::move(left_key)), right_key_(optimus::move(right_key)) { }
+
+    iterator begin() const {
+        return iterator{this, left_first_, left_last_, right_first_, right_last_};
+    }
+
+    iterator end() const {
+        return iterator{this, left_last_, left_last_, right_last_, right_last_};
+    }
+
+    /**
+     * Calls `fn` with every pair, from `threads` threads at once, so `fn`
+     * must be safe to call concurrently. The left range is cut into slices
+     * at changes of key and each slice is merged with the matching part of
+     * the right range, found by binary search. Requires random access
+     * ranges. Returns `fn`.
+     */
+    template <typename Fn>
+    Fn parallel_for_each(Fn fn, ::std::size_t threads = ::std::thread::hardware_concurrency()) const {
+        const ::std::size_t n = ::std::size_t(left_last_ - left_first_);
+        threads = ::std::max<::std::size_t>(1, ::std::min(threads, n / join_partition_rows));
+        ::std::vector<LeftIterator> cuts{left_first_};
+        for (::std::size_t t = 1; t < threads; ++t) {
+            LeftIterator cut = left_first_ + ::std::ptrdiff_t(n * t / threads);
+            if (cut <= cuts.back()) {
+                continue;
+            }
+            // Don't split a run of equal keys.
+            while (cut != left_last_ && !less(left_key_(*(cut - 1)), left_key_(*cut))) {
+                ++cut;
+            }
+            cuts.push_back(cut);
+        }
+        cuts.push_back(left_last_);
+
+        detail::run_threads(cuts.size() - 1, [&](::std::size_t t) {
+            if (cuts[t] == cuts[t + 1]) {
+                return;
+            }
+            const auto first_key = left_key_(*cuts[t]);
+            const RightIterator right_first = ::std::partition_point(right_first_, right_last_,
+                [&](right_reference row) { return less(right_key_(row), first_key); });
+            const merge_join_range slice{cuts[t], cuts[t + 1], right_first, right_last_, left_key_, right_key_};
+            for (value_type pair : slice) {
+                fn(pair);
+            }
+        });
+        return fn;
+    }
+
+  private:
+    template <typename L, typename R>
+    static bool less(const L& lhs, const R& rhs) {
+        return lhs < rhs;
+    }
+
+    LeftIterator left_first_;
+    LeftIterator left_last_;
+    RightIterator right_first_;
+    RightIterator right_last_;
+    LeftKey left_key_;
+    RightKey right_key_;
+};
+
+/**
+ * Joins the rows of `left` and `right`, both sorted by their keys as
+ * projected by `LeftKey` and `RightKey`, whose keys are equal.
+ */
+template <typename LeftKey, typename RightKey, typename LeftRange, typename RightRange>
+merge_join_range<decltype(::std::begin(::std::declval<const LeftRange&>())),
+                 decltype(::std::begin(::std::declval<const RightRange&>())),
+                 LeftKey, RightKey>
+merge_join(const LeftRange& left, const RightRange& right,
+           LeftKey left_key = LeftKey{}, RightKey right_key = RightKey{}) {
+    return {::std::begin(left), ::std::end(left), ::std::begin(right), ::std::end(right),
+            optimus::move(left_key), optimus::move(right_key)};
+}
+
+} // namespace optimus
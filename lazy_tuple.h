@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+
+#include <optimus/traits.h>
+#include <optimus/tuple_core.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+namespace detail {
+
+// The smallest unsigned integer with a bit for each of `N` elements.
+template <::std::size_t N>
+using lazy_mask_t = typename ::std::conditional<
+    (N <= 8),
+    ::std::uint8_t,
+    typename ::std::conditional<
+        (N <= 16),
+        ::std::uint16_t,
+        typename ::std::conditional<(N <= 32), ::std::uint32_t, ::std::uint64_t>::type
+    >::type
+>::type;
+
+template <typename Source, typename Fn>
+using lazy_element_t = typename ::std::decay<result_of_t<const Fn&(const Source&)>>::type;
+
+template <typename T>
+using lazy_slot = typename ::std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+} // namespace detail
+
+/**
+ * A tuple whose element I is `fns[I](source)`, worked out on first access
+ * and kept in place after, e.g. the fields of a wide record decoded from
+ * its bytes: a projection which reads two of the fields decodes only
+ * those two. A bitmask, in the smallest word with a bit per element, says
+ * which elements have been worked out; nothing is allocated.
+ *
+ * Elements are read through `get<I>`, found by argument dependent lookup,
+ * so `optimus::get<I>` and its transformers apply to a lazy_tuple as they
+ * do to tuples. Reading a const lazy_tuple may still work an element out,
+ * so unlike a tuple it must not be read from two threads at once. reset()
+ * rebinds it to another source, so that one lazy_tuple can be reused for
+ * record after record.
+ */
+template <typename Source, typename... Fns>
+class lazy_tuple : public detail::tuple_like_adl::tuple_like<lazy_tuple<Source, Fns...>> {
+    static_assert(sizeof...(Fns) > 0, "lazy_tuple requires at least one element");
+    static_assert(sizeof...(Fns) <= 64, "lazy_tuple holds at most 64 elements");
+
+    using indices = optimus::index_sequence_for<Fns...>;
+
+  public:
+    using source_type = Source;
+    using mask_type = detail::lazy_mask_t<sizeof...(Fns)>;
+
+    template <::std::size_t I>
+    using element_type =
+        detail::lazy_element_t<Source, typename ::std::tuple_element<I, ::std::tuple<Fns...>>::type>;
+
+    explicit lazy_tuple(Source source) : source_(optimus::move(source)), mask_(0) { }
+
+    lazy_tuple(Source source, Fns... fns)
+            : source_(optimus::move(source)), fns_(optimus::move(fns)...), mask_(0) { }
+
+    // Copies the elements worked out so far along with the source.
+    lazy_tuple(const lazy_tuple& other) : source_(other.source_), fns_(other.fns_), mask_(0) {
+        copy_from(other, indices{});
+    }
+
+    lazy_tuple(lazy_tuple&& other)
+            : source_(optimus::move(other.source_)), fns_(optimus::move(other.fns_)), mask_(0) {
+        move_from(other, indices{});
+    }
+
+    lazy_tuple& operator=(const lazy_tuple& other) {
+        if (this != &other) {
+            clear();
+            source_ = other.source_;
+            fns_ = other.fns_;
+            copy_from(other, indices{});
+        }
+        return *this;
+    }
+
+    lazy_tuple& operator=(lazy_tuple&& other) {
+        if (this != &other) {
+            clear();
+            source_ = optimus::move(other.source_);
+            fns_ = optimus::move(other.fns_);
+            move_from(other, indices{});
+        }
+        return *this;
+    }
+
+    ~lazy_tuple() {
+        clear();
+    }
+
+    const Source& source() const {
+        return source_;
+    }
+
+    // Drops the elements worked out so far and takes them from `source`.
+    void reset(Source source) {
+        clear();
+        source_ = optimus::move(source);
+    }
+
+    // Bit I is set if element I has been worked out.
+    mask_type mask() const {
+        return mask_;
+    }
+
+    template <::std::size_t I>
+    bool initialized() const {
+        return (mask_ & bit<I>()) != 0;
+    }
+
+    template <::std::size_t I>
+    element_type<I>& get() {
+        return *element<I>();
+    }
+
+    template <::std::size_t I>
+    const element_type<I>& get() const {
+        return *element<I>();
+    }
+
+  private:
+    friend class detail::tuple_like_adl::tuple_like<lazy_tuple>;
+
+    // Read by the `get<I>` of tuple_like, so that optimus::get<I> and its
+    // transformers work elements out as they read them.
+    template <::std::size_t I>
+    static element_type<I>& get_element(lazy_tuple& t) {
+        return t.template get<I>();
+    }
+
+    template <::std::size_t I>
+    static const element_type<I>& get_element(const lazy_tuple& t) {
+        return t.template get<I>();
+    }
+
+    template <::std::size_t I>
+    static element_type<I>&& get_element(lazy_tuple&& t) {
+        return optimus::move(t.template get<I>());
+    }
+
+    template <::std::size_t I>
+    static constexpr mask_type bit() {
+        return mask_type(mask_type(1) << I);
+    }
+
+    template <::std::size_t I>
+    element_type<I>* slot() const {
+        return reinterpret_cast<element_type<I>*>(&::std::get<I>(slots_));
+    }
+
+    template <::std::size_t I>
+    element_type<I>* element() const {
+        element_type<I>* value = slot<I>();
+        if ((mask_ & bit<I>()) == 0) {
+            ::new (static_cast<void*>(value)) element_type<I>(::std::get<I>(fns_)(source_));
+            mask_ = mask_type(mask_ | bit<I>());
+        }
+        return value;
+    }
+
+    template <::std::size_t I>
+    void destroy() {
+        if ((mask_ & bit<I>()) != 0) {
+            slot<I>()->~element_type<I>();
+        }
+    }
+
+    template <::std::size_t I>
+    void copy_element(const lazy_tuple& other) {
+        if ((other.mask_ & bit<I>()) != 0) {
+            ::new (static_cast<void*>(slot<I>())) element_type<I>(*other.slot<I>());
+            mask_ = mask_type(mask_ | bit<I>());
+        }
+    }
+
+    template <::std::size_t I>
+    void move_element(lazy_tuple& other) {
+        if ((other.mask_ & bit<I>()) != 0) {
+            ::new (static_cast<void*>(slot<I>())) element_type<I>(optimus::move(*other.slot<I>()));
+            mask_ = mask_type(mask_ | bit<I>());
+        }
+    }
+
+    template <::std::size_t... Indices>
+    void copy_from(const lazy_tuple& other, optimus::index_sequence<Indices...>) {
+        using swallow = int[];
+        try {
+            (void)swallow{0, (copy_element<Indices>(other), 0)...};
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <::std::size_t... Indices>
+    void move_from(lazy_tuple& other, optimus::index_sequence<Indices...>) {
+        using swallow = int[];
+        (void)swallow{0, (move_element<Indices>(other), 0)...};
+    }
+
+    template <::std::size_t... Indices>
+    void clear(optimus::index_sequence<Indices...>) {
+        using swallow = int[];
+        (void)swallow{0, (destroy<Indices>(), 0)...};
+    }
+
+    void clear() {
+        if (mask_ != 0) {
+            clear(indices{});
+            mask_ = 0;
+        }
+    }
+
+    Source source_;
+    optimus::tuple<Fns...> fns_;
+    mutable optimus::tuple<detail::lazy_slot<detail::lazy_element_t<Source, Fns>>...> slots_;
+    mutable mask_type mask_;
+};
+
+template <typename Source, typename... Fns>
+lazy_tuple<typename ::std::decay<Source>::type, typename ::std::decay<Fns>::type...>
+make_lazy_tuple(Source&& source, Fns&&... fns) {
+    return lazy_tuple<typename ::std::decay<Source>::type, typename ::std::decay<Fns>::type...>(
+        optimus::forward<Source>(source), optimus::forward<Fns>(fns)...);
+}
+
+} // namespace optimus
+
+namespace std {
+
+template <typename Source, typename... Fns>
+struct tuple_size<optimus::lazy_tuple<Source, Fns...>>
+    : ::std::integral_constant<::std::size_t, sizeof...(Fns)> { };
+
+template <std::size_t I, typename Source, typename... Fns>
+struct tuple_element<I, optimus::lazy_tuple<Source, Fns...>> {
+    using type = typename optimus::lazy_tuple<Source, Fns...>::template element_type<I>;
+};
+
+} // namespace std
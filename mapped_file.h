@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace optimus {
+
+/**
+ * A read-only memory mapping of a whole file (POSIX). Pages are faulted in
+ * on first access, so opening a large file costs nothing up front.
+ *
+ * Opening fails silently: check `valid()` before using the mapping. Empty
+ * files cannot be mapped and are reported as invalid.
+ */
+class mapped_file {
+  public:
+    mapped_file() noexcept : data_(nullptr), size_(0) { }
+
+    explicit mapped_file(const char* path) noexcept : data_(nullptr), size_(0) {
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = data;
+                size_ = std::size_t(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~mapped_file() {
+        unmap();
+    }
+
+    bool valid() const noexcept {
+        return data_ != nullptr;
+    }
+
+    const void* data() const noexcept {
+        return data_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    // Hints that the mapping will be read front to back.
+    void advise_sequential() const noexcept {
+        if (data_ != nullptr) {
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+  private:
+    void unmap() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    void* data_;
+    std::size_t size_;
+};
+
+}
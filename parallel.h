@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Estimated nanoseconds of work below which a call is not worth handing to
+// another thread; waking one takes several microseconds.
+constexpr ::std::size_t parallel_min_cost = 10000;
+
+namespace detail {
+
+// Runs `fn(0)` ... `fn(n - 1)` on `n` threads, one of them this one. Once
+// every thread has been joined, rethrows the exception of the first call
+// which threw, so that an exception never leaves a std::thread.
+template <typename Fn>
+void run_threads(::std::size_t n, const Fn& fn) {
+    ::std::vector<::std::exception_ptr> errors(n);
+    const auto run = [&fn, &errors](::std::size_t i) {
+        try {
+            fn(i);
+        } catch (...) {
+            errors[i] = ::std::current_exception();
+        }
+    };
+
+    ::std::vector<::std::thread> workers;
+    workers.reserve(n == 0 ? 0 : n - 1);
+    try {
+        for (::std::size_t i = 1; i < n; ++i) {
+            workers.emplace_back(run, i);
+        }
+    } catch (...) {
+        for (::std::thread& worker : workers) {
+            worker.join();
+        }
+        throw;
+    }
+    if (n != 0) {
+        run(0);
+    }
+    for (::std::thread& worker : workers) {
+        worker.join();
+    }
+    for (const ::std::exception_ptr& error : errors) {
+        if (error) {
+            ::std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * A call `run(context, index)` forked onto a work_stealing_pool. It lives
+ * in the frame of the thread which forked it until that thread has joined
+ * it, so forking allocates nothing.
+ */
+struct pool_task {
+    void (*run)(void* context, ::std::size_t index);
+    void* context;
+    ::std::size_t index;
+    ::std::atomic<::std::size_t>* pending;
+    ::std::exception_ptr error;
+};
+
+// The pool the current thread works for, if any, and its queue in it.
+struct pool_worker {
+    const void* pool;
+    ::std::size_t queue;
+};
+
+inline pool_worker& current_pool_worker() {
+    static thread_local pool_worker worker{nullptr, 0};
+    return worker;
+}
+
+} // namespace detail
+
+/**
+ * A fixed set of threads for fork-join parallelism. Each thread keeps a
+ * queue of the tasks it forked, runs the newest of them itself and, once
+ * its queue is empty, steals the oldest task of another thread, which
+ * tends to be the largest piece of work left. A thread waiting to join
+ * its tasks runs tasks too, so tasks may fork and join recursively
+ * without running out of threads. Threads outside the pool share one more
+ * queue.
+ */
+class work_stealing_pool {
+  public:
+    // `threads` threads besides those which call run.
+    explicit work_stealing_pool(::std::size_t threads = default_threads()) : queued_(0), stop_(false) {
+        for (::std::size_t i = 0; i <= threads; ++i) {
+            queues_.emplace_back(new queue);
+        }
+        threads_.reserve(threads);
+        for (::std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool() {
+        {
+            ::std::lock_guard<::std::mutex> lock{sleep_mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (::std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    ::std::size_t size() const {
+        return threads_.size();
+    }
+
+    // A pool with a thread for every core but the caller's, started on
+    // first use.
+    static work_stealing_pool& shared() {
+        static work_stealing_pool pool;
+        return pool;
+    }
+
+    /**
+     * Runs `tasks[0]` ... `tasks[n - 1]`: the first on this thread and the
+     * others wherever a thread is free, this one included. Returns once
+     * all have, rethrowing the exception of the first task which threw.
+     */
+    void run(detail::pool_task* tasks, ::std::size_t n) {
+        if (n == 0) {
+            return;
+        }
+        ::std::atomic<::std::size_t> pending{n - 1};
+        const ::std::size_t self = own_queue();
+        for (::std::size_t i = 0; i < n; ++i) {
+            tasks[i].pending = &pending;
+            tasks[i].error = nullptr;
+        }
+        if (n > 1) {
+            push(self, tasks + 1, n - 1);
+        }
+        execute(tasks[0], false);
+        while (pending.load(::std::memory_order_acquire) != 0) {
+            detail::pool_task* task = take(self);
+            if (task != nullptr) {
+                execute(*task, true);
+            } else {
+                ::std::this_thread::yield();
+            }
+        }
+        for (::std::size_t i = 0; i < n; ++i) {
+            if (tasks[i].error) {
+                ::std::rethrow_exception(tasks[i].error);
+            }
+        }
+    }
+
+    // Runs `fn(0)` ... `fn(n - 1)` as tasks.
+    template <typename Fn>
+    void for_each_index(::std::size_t n, const Fn& fn) {
+        ::std::vector<detail::pool_task> tasks(n);
+        for (::std::size_t i = 0; i < n; ++i) {
+            tasks[i].run = &call<Fn>;
+            tasks[i].context = const_cast<void*>(static_cast<const void*>(&fn));
+            tasks[i].index = i;
+        }
+        run(tasks.data(), n);
+    }
+
+  private:
+    struct queue {
+        ::std::mutex mutex;
+        ::std::deque<detail::pool_task*> tasks;
+    };
+
+    static ::std::size_t default_threads() {
+        const ::std::size_t cores = ::std::thread::hardware_concurrency();
+        return cores == 0 ? 0 : cores - 1;
+    }
+
+    template <typename Fn>
+    static void call(void* context, ::std::size_t index) {
+        (*static_cast<const Fn*>(context))(index);
+    }
+
+    ::std::size_t own_queue() const {
+        const detail::pool_worker& worker = detail::current_pool_worker();
+        return worker.pool == this ? worker.queue : threads_.size();
+    }
+
+    void push(::std::size_t self, detail::pool_task* tasks, ::std::size_t n) {
+        // Counted first, so that take never counts below zero.
+        queued_.fetch_add(n, ::std::memory_order_release);
+        {
+            ::std::lock_guard<::std::mutex> lock{queues_[self]->mutex};
+            for (::std::size_t i = 0; i < n; ++i) {
+                queues_[self]->tasks.push_back(tasks + i);
+            }
+        }
+        // Taking the lock orders the count before any sleeper's check of it.
+        { ::std::lock_guard<::std::mutex> lock{sleep_mutex_}; }
+        if (n == 1) {
+            wake_.notify_one();
+        } else {
+            wake_.notify_all();
+        }
+    }
+
+    // The newest task of this thread's queue, or else the oldest of another.
+    detail::pool_task* take(::std::size_t self) {
+        if (queued_.load(::std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+        for (::std::size_t i = 0; i < queues_.size(); ++i) {
+            queue& q = *queues_[(self + i) % queues_.size()];
+            ::std::lock_guard<::std::mutex> lock{q.mutex};
+            if (!q.tasks.empty()) {
+                detail::pool_task* task;
+                if (i == 0) {
+                    task = q.tasks.back();
+                    q.tasks.pop_back();
+                } else {
+                    task = q.tasks.front();
+                    q.tasks.pop_front();
+                }
+                queued_.fetch_sub(1, ::std::memory_order_relaxed);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    // The task is done with once `pending` is decremented, since the
+    // thread which forked it may return as soon as it sees that.
+    static void execute(detail::pool_task& task, bool counted) {
+        try {
+            task.run(task.context, task.index);
+        } catch (...) {
+            task.error = ::std::current_exception();
+        }
+        if (counted) {
+            task.pending->fetch_sub(1, ::std::memory_order_acq_rel);
+        }
+    }
+
+    void work(::std::size_t self) {
+        detail::current_pool_worker() = detail::pool_worker{this, self};
+        for (;;) {
+            detail::pool_task* task = take(self);
+            if (task != nullptr) {
+                execute(*task, true);
+                continue;
+            }
+            ::std::unique_lock<::std::mutex> lock{sleep_mutex_};
+            wake_.wait(lock, [this] {
+                return stop_ || queued_.load(::std::memory_order_acquire) != 0;
+            });
+            if (stop_ && queued_.load(::std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    // queues_[i] is thread i's; the last is shared by threads outside.
+    ::std::vector<::std::unique_ptr<queue>> queues_;
+    ::std::vector<::std::thread> threads_;
+    ::std::atomic<::std::size_t> queued_;
+    ::std::mutex sleep_mutex_;
+    ::std::condition_variable wake_;
+    bool stop_;
+};
+
+namespace detail {
+
+template <bool... Flags>
+struct count_true : ::std::integral_constant<::std::size_t, 0> { };
+
+template <bool Flag, bool... Flags>
+struct count_true<Flag, Flags...>
+        : ::std::integral_constant<::std::size_t, ::std::size_t(Flag) + count_true<Flags...>::value> { };
+
+template <typename Fn>
+struct declared_cost {
+    template <typename F>
+    static ::std::integral_constant<::std::size_t, F::cost> test(int);
+
+    template <typename F>
+    static ::std::integral_constant<::std::size_t, parallel_min_cost> test(...);
+
+    using type = decltype(test<Fn>(0));
+};
+
+// Holds the result of a forked call until it is passed on.
+template <typename R>
+class task_result {
+  public:
+    task_result() : done_(false) { }
+
+    task_result(const task_result&) = delete;
+
+    ~task_result() {
+        if (done_) {
+            reinterpret_cast<R*>(&storage_)->~R();
+        }
+    }
+
+    template <typename Call>
+    void emplace(Call&& call) {
+        ::new (static_cast<void*>(&storage_)) R(call());
+        done_ = true;
+    }
+
+    R&& take() {
+        return optimus::move(*reinterpret_cast<R*>(&storage_));
+    }
+
+  private:
+    typename ::std::aligned_storage<sizeof(R), alignof(R)>::type storage_;
+    bool done_;
+};
+
+template <typename R>
+class task_result<R&> {
+  public:
+    template <typename Call>
+    void emplace(Call&& call) {
+        result_ = &call();
+    }
+
+    R& take() {
+        return *result_;
+    }
+
+  private:
+    R* result_ = nullptr;
+};
+
+template <typename R>
+class task_result<R&&> {
+  public:
+    template <typename Call>
+    void emplace(Call&& call) {
+        R&& result = call();
+        result_ = &result;
+    }
+
+    R&& take() {
+        return optimus::move(*result_);
+    }
+
+  private:
+    R* result_ = nullptr;
+};
+
+} // namespace detail
+
+/**
+ * Estimated nanoseconds a call to `Fn` takes, which parallel_variadic
+ * compares with parallel_min_cost: `Fn::cost` if Fn declares one, and
+ * otherwise parallel_min_cost, since a Fn is only put in a
+ * parallel_variadic because it is expected to be slow. Specialize to
+ * declare the cost of a Fn which cannot be changed.
+ */
+template <typename Fn>
+struct task_cost : detail::declared_cost<Fn>::type { };
+
+/**
+ * As variadic: each argument goes through its own Fn, and the results go
+ * to the outer function object. When at least two of the Fns are costly
+ * by task_cost, the Fns are called as tasks on work_stealing_pool::shared()
+ * and joined before the outer function object is called; otherwise they
+ * are called in order on the calling thread, as by variadic. An exception
+ * thrown by a Fn is rethrown once all of them have finished.
+ *
+ *   using decode_row = optimus::parallel_variadic<decode_text, decode_image>
+ *       ::apply<make_document>;
+ */
+template <typename... Fns>
+class parallel_variadic {
+    template <::std::size_t Index>
+    using fn_at = typename ::std::tuple_element<Index, ::std::tuple<Fns...>>::type;
+
+    using forks = ::std::integral_constant<bool,
+            (detail::count_true<(task_cost<Fns>::value >= parallel_min_cost)...>::value >= 2)>;
+
+    template <typename Args, typename Indices>
+    struct frame;
+
+    template <typename... Args, ::std::size_t... Indices>
+    struct frame<::std::tuple<Args...>, index_sequence<Indices...>> {
+        explicit frame(Args&&... arguments) : args(optimus::forward<Args>(arguments)...) { }
+
+        ::std::tuple<Args&&...> args;
+        ::std::tuple<detail::task_result<result_of_t<const Fns(Args&&)>>...> results;
+
+        template <::std::size_t Index>
+        static void run(void* context, ::std::size_t) {
+            frame& self = *static_cast<frame*>(context);
+            ::std::get<Index>(self.results).emplace([&self]() -> result_of_t<
+                    const fn_at<Index>(typename ::std::tuple_element<Index, ::std::tuple<Args&&...>>::type)> {
+                return fn_at<Index>{}(::std::get<Index>(optimus::move(self.args)));
+            });
+        }
+
+        template <typename Fn>
+        result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> call(const Fn& fn) {
+            detail::pool_task tasks[] = {detail::pool_task{&run<Indices>, this, Indices, nullptr, nullptr}...};
+            work_stealing_pool::shared().run(tasks, sizeof...(Indices));
+            return fn(::std::get<Indices>(results).take()...);
+        }
+    };
+
+    template <typename Fn>
+    struct impl {
+        constexpr impl() { }
+
+        template <
+            typename... Args,
+            typename = safe_forwarding_constructor_t<impl, Args...>
+        >
+        explicit constexpr impl(Args&&... args) : fn_(optimus::forward<Args>(args)...) { }
+
+        constexpr impl(const impl&) = default;
+        constexpr impl(impl&&) = default;
+
+        template <typename... Args, typename = typename ::std::enable_if<sizeof...(Fns) == sizeof...(Args)>::type>
+        auto operator()(Args&&... args) const -> result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> {
+            return call(forks{}, optimus::forward<Args>(args)...);
+        }
+
+        Fn fn_;
+
+      private:
+        template <typename... Args>
+        auto call(::std::false_type, Args&&... args) const
+                -> result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> {
+            return fn_(Fns{}(optimus::forward<Args>(args))...);
+        }
+
+        template <typename... Args>
+        auto call(::std::true_type, Args&&... args) const
+                -> result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> {
+            frame<::std::tuple<Args...>, index_sequence_for<Fns...>> f{optimus::forward<Args>(args)...};
+            return f.call(fn_);
+        }
+    };
+
+  public:
+    template <typename Fn>
+    using apply = impl<Fn>;
+};
+
+} // namespace optimus
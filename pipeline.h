@@ -0,0 +1,555 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Bytes per cache line, which the indices of a ring are kept apart by so
+// that the producer and consumer do not invalidate each other's line.
+constexpr ::std::size_t ring_cache_line = 64;
+
+namespace detail {
+
+// Waits out a full or empty ring: spins briefly, then yields, then sleeps,
+// so that a stage with nothing to do does not hold on to its core.
+class backoff {
+  public:
+    backoff() : waits_(0) { }
+
+    void operator()() {
+        ++waits_;
+        if (waits_ < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else if (waits_ < 1024) {
+            ::std::this_thread::yield();
+        } else {
+            ::std::this_thread::sleep_for(::std::chrono::microseconds(50));
+        }
+    }
+
+    void reset() {
+        waits_ = 0;
+    }
+
+  private:
+    unsigned waits_;
+};
+
+// Pins the calling thread to `core`, where the platform allows it.
+inline void pin_to_core(::std::size_t core) {
+#if defined(__linux__)
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core % ::std::max(1u, ::std::thread::hardware_concurrency()), &cores);
+    pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#else
+    (void)core;
+#endif
+}
+
+} // namespace detail
+
+/**
+ * A bounded queue from one producer thread to one consumer thread which
+ * takes no lock. Each side keeps its own index on its own cache line, and
+ * a cached copy of the other's, which it reloads only when the ring looks
+ * full or empty; values are pushed and popped in batches so that the
+ * indices, the only shared writes, change once per batch.
+ *
+ * The producer closes the ring after its last push; the consumer has seen
+ * everything once it finds the ring closed and then empty.
+ */
+template <typename T>
+class spsc_ring {
+  public:
+    // Rounds `capacity` up to a power of two.
+    explicit spsc_ring(::std::size_t capacity)
+            : head_(0), cached_tail_(0), tail_(0), cached_head_(0), closed_(false) {
+        ::std::size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        slots_.reset(new slot[size]);
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    ~spsc_ring() {
+        const ::std::size_t tail = tail_.load(::std::memory_order_relaxed);
+        for (::std::size_t i = head_.load(::std::memory_order_relaxed); i != tail; ++i) {
+            at(i)->~T();
+        }
+    }
+
+    ::std::size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * Producer: constructs values from up to `n` values from `first`, as
+     * many as there is room for, and returns how many. Pass a
+     * move_iterator to move them.
+     */
+    template <typename Iterator>
+    ::std::size_t try_push(Iterator first, ::std::size_t n) {
+        const ::std::size_t tail = tail_.load(::std::memory_order_relaxed);
+        if (capacity() - (tail - cached_head_) < n) {
+            cached_head_ = head_.load(::std::memory_order_acquire);
+        }
+        n = ::std::min(n, capacity() - (tail - cached_head_));
+        for (::std::size_t i = 0; i < n; ++i, ++first) {
+            try {
+                ::new (static_cast<void*>(at(tail + i))) T(*first);
+            } catch (...) {
+                tail_.store(tail + i, ::std::memory_order_release);
+                throw;
+            }
+        }
+        tail_.store(tail + n, ::std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Consumer: calls `fn(T&&)` on up to `n` values in order, as many as
+     * there are, then frees their slots, and returns how many.
+     */
+    template <typename Fn>
+    ::std::size_t try_pop(::std::size_t n, Fn&& fn) {
+        const ::std::size_t head = head_.load(::std::memory_order_relaxed);
+        if (cached_tail_ - head < n) {
+            cached_tail_ = tail_.load(::std::memory_order_acquire);
+        }
+        n = ::std::min(n, cached_tail_ - head);
+        for (::std::size_t i = 0; i < n; ++i) {
+            T* value = at(head + i);
+            try {
+                fn(optimus::move(*value));
+            } catch (...) {
+                value->~T();
+                head_.store(head + i + 1, ::std::memory_order_release);
+                throw;
+            }
+            value->~T();
+        }
+        head_.store(head + n, ::std::memory_order_release);
+        return n;
+    }
+
+    // Producer: no more values will be pushed.
+    void close() {
+        closed_.store(true, ::std::memory_order_release);
+    }
+
+    bool closed() const {
+        return closed_.load(::std::memory_order_acquire);
+    }
+
+  private:
+    using slot = typename ::std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    using index = ::std::atomic<::std::size_t>;
+
+    T* at(::std::size_t i) {
+        return reinterpret_cast<T*>(&slots_[i & mask_]);
+    }
+
+    // Consumer side.
+    index head_;
+    ::std::size_t cached_tail_;
+    char pad_head_[ring_cache_line - sizeof(index) - sizeof(::std::size_t)];
+
+    // Producer side.
+    index tail_;
+    ::std::size_t cached_head_;
+    char pad_tail_[ring_cache_line - sizeof(index) - sizeof(::std::size_t)];
+
+    ::std::atomic<bool> closed_;
+    ::std::size_t mask_;
+    ::std::unique_ptr<slot[]> slots_;
+};
+
+/**
+ * A stage which passes on the values `Pred` holds for and drops the rest.
+ * Stages which pass on other than one value per input are written like
+ * this one: they take the value and an `emit` function object, and say
+ * what they emit by `output_type`.
+ */
+template <typename Pred>
+struct keep_if {
+    template <typename In>
+    using output_type = In;
+
+    keep_if() = default;
+
+    explicit keep_if(Pred pred) : pred_(optimus::move(pred)) { }
+
+    template <typename In, typename Emit>
+    void operator()(In&& in, Emit& emit) {
+        if (pred_(in)) {
+            emit(optimus::forward<In>(in));
+        }
+    }
+
+    Pred pred_;
+};
+
+struct pipeline_options {
+    // Values each ring holds, rounded up to a power of two. A full ring
+    // stalls the stage feeding it.
+    ::std::size_t capacity = 4096;
+
+    // Most values a stage takes from its ring, or hands to the next, at once.
+    ::std::size_t batch = 64;
+
+    // Whether to pin stage i to core first_core + i, modulo the number of
+    // cores.
+    bool pin = false;
+    ::std::size_t first_core = 0;
+};
+
+namespace detail {
+
+struct discard {
+    template <typename T>
+    void operator()(T&&) const { }
+};
+
+template <typename Stage, typename In>
+struct stage_output {
+    template <typename S>
+    static typename S::template output_type<In> test(int);
+
+    template <typename S>
+    static typename ::std::decay<result_of_t<S&(In&&)>>::type test(...);
+
+    using type = decltype(test<Stage>(0));
+};
+
+// The types each stage takes, as a std::tuple.
+template <typename In, typename... Stages>
+struct stage_inputs {
+    using type = ::std::tuple<>;
+};
+
+template <typename In, typename Stage, typename... Stages>
+struct stage_inputs<In, Stage, Stages...> {
+    template <typename... Ts>
+    static ::std::tuple<In, Ts...> prepend(::std::tuple<Ts...>);
+
+    using type = decltype(prepend(
+            ::std::declval<typename stage_inputs<typename stage_output<Stage, In>::type, Stages...>::type>()));
+};
+
+// Calls an emitting stage with `emit`, and any other with its value,
+// emitting the result.
+template <typename Stage, typename In, typename Emit>
+auto call_stage(Stage& stage, In&& in, Emit& emit, int)
+        -> decltype(stage(optimus::forward<In>(in), emit), void()) {
+    stage(optimus::forward<In>(in), emit);
+}
+
+template <typename Stage, typename In, typename Emit>
+void call_stage(Stage& stage, In&& in, Emit& emit, long) {
+    emit(stage(optimus::forward<In>(in)));
+}
+
+// The last stage's results, if any, are dropped.
+template <typename Stage, typename In>
+auto call_last_stage(Stage& stage, In&& in, int)
+        -> decltype(stage(optimus::forward<In>(in), ::std::declval<discard&>()), void()) {
+    discard emit;
+    stage(optimus::forward<In>(in), emit);
+}
+
+template <typename Stage, typename In>
+void call_last_stage(Stage& stage, In&& in, long) {
+    stage(optimus::forward<In>(in));
+}
+
+} // namespace detail
+
+/**
+ * Runs values of type `In` through `Stages`, each a function object on a
+ * thread of its own, with a spsc_ring between each stage and the next:
+ *
+ *   optimus::pipeline<std::string, parse, project, optimus::keep_if<valid>, sum> p;
+ *   for (const auto& line : lines) p.push(line);
+ *   p.close();
+ *   total = p.stage<3>().total;
+ *
+ * A stage is called with each value as an rvalue and its result is passed
+ * on; a stage may instead emit any number of values, as keep_if does. The
+ * last stage's results are dropped, so it is where results are kept, and
+ * stage<I>() reads them once the pipeline is closed. Each stage is only
+ * ever called from its own thread, so it needs no locks.
+ *
+ * A stage takes values from its ring, and passes them on, in batches. A
+ * full ring stalls the stage feeding it, back to push, so a slow stage
+ * bounds the memory used rather than queueing without limit.
+ *
+ * If a stage throws, every stage stops, push returns false, and close
+ * rethrows the exception.
+ */
+template <typename In, typename... Stages>
+class pipeline {
+    static_assert(sizeof...(Stages) > 0, "a pipeline needs a stage");
+
+    using inputs = typename detail::stage_inputs<In, Stages...>::type;
+
+    template <::std::size_t I>
+    using input_at = typename ::std::tuple_element<I, inputs>::type;
+
+    static constexpr ::std::size_t stages = sizeof...(Stages);
+
+  public:
+    template <::std::size_t I>
+    using stage_type = typename ::std::tuple_element<I, ::std::tuple<Stages...>>::type;
+
+    // Default constructs each stage, if they all can be.
+    template <bool Default = all_of<::std::is_default_constructible<Stages>...>::value,
+              typename = typename ::std::enable_if<Default>::type>
+    pipeline() : pipeline(pipeline_options{}, Stages()...) { }
+
+    explicit pipeline(Stages... stage) : pipeline(pipeline_options{}, optimus::move(stage)...) { }
+
+    explicit pipeline(pipeline_options options, Stages... stage)
+            : options_(options), stages_(optimus::move(stage)...), errors_(stages),
+              failed_(false), closed_(false) {
+        options_.batch = ::std::max<::std::size_t>(1, ::std::min(options_.batch, options_.capacity));
+        make_rings(make_index_sequence<stages>{});
+        start(make_index_sequence<stages>{});
+    }
+
+    pipeline(const pipeline&) = delete;
+    pipeline& operator=(const pipeline&) = delete;
+
+    // Closes the pipeline if close was not called, dropping any exception.
+    ~pipeline() {
+        if (!closed_) {
+            finish();
+        }
+    }
+
+    /**
+     * Hands `value` to the first stage, waiting while its ring is full.
+     * Returns false, without passing it on, once a stage has thrown.
+     */
+    bool push(In value) {
+        return push_n(::std::make_move_iterator(&value), 1);
+    }
+
+    // As push for each of [first, last), in batches.
+    template <typename Iterator>
+    bool push(Iterator first, Iterator last) {
+        ::std::vector<In> batch;
+        batch.reserve(options_.batch);
+        for (;;) {
+            batch.clear();
+            for (; first != last && batch.size() < options_.batch; ++first) {
+                batch.push_back(*first);
+            }
+            if (batch.empty()) {
+                return !failed_.load(::std::memory_order_acquire);
+            }
+            if (!push_n(::std::make_move_iterator(batch.begin()), batch.size())) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * Signals the end of input, waits for every value to pass through
+     * every stage, and rethrows the exception of the first stage which
+     * threw. Call once.
+     */
+    void close() {
+        finish();
+        for (const ::std::exception_ptr& error : errors_) {
+            if (error) {
+                ::std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Stage I, to read once the pipeline is closed.
+    template <::std::size_t I>
+    stage_type<I>& stage() {
+        return ::std::get<I>(stages_);
+    }
+
+    template <::std::size_t I>
+    const stage_type<I>& stage() const {
+        return ::std::get<I>(stages_);
+    }
+
+  private:
+    template <typename... Ts>
+    static ::std::tuple<::std::unique_ptr<spsc_ring<Ts>>...> ring_tuple(::std::tuple<Ts...>);
+
+    using rings = decltype(ring_tuple(::std::declval<inputs>()));
+
+    template <::std::size_t... I>
+    void make_rings(index_sequence<I...>) {
+        rings_ = rings{::std::unique_ptr<spsc_ring<input_at<I>>>(
+                new spsc_ring<input_at<I>>(options_.capacity))...};
+    }
+
+    template <::std::size_t... I>
+    void start(index_sequence<I...>) {
+        threads_.reserve(stages);
+        const int expand[] = {(threads_.emplace_back([this] { run<I>(); }), 0)...};
+        (void)expand;
+    }
+
+    template <typename Iterator>
+    bool push_n(Iterator first, ::std::size_t n) {
+        spsc_ring<In>& ring = *::std::get<0>(rings_);
+        detail::backoff wait;
+        while (n != 0) {
+            if (failed_.load(::std::memory_order_acquire)) {
+                return false;
+            }
+            const ::std::size_t pushed = ring.try_push(first, n);
+            if (pushed == 0) {
+                wait();
+            } else {
+                ::std::advance(first, pushed);
+                n -= pushed;
+                wait.reset();
+            }
+        }
+        return true;
+    }
+
+    void finish() {
+        ::std::get<0>(rings_)->close();
+        for (::std::thread& thread : threads_) {
+            thread.join();
+        }
+        closed_ = true;
+    }
+
+    template <::std::size_t I>
+    void run() {
+        if (options_.pin) {
+            detail::pin_to_core(options_.first_core + I);
+        }
+        try {
+            run<I>(::std::integral_constant<bool, I + 1 == stages>{});
+        } catch (...) {
+            errors_[I] = ::std::current_exception();
+            failed_.store(true, ::std::memory_order_release);
+        }
+    }
+
+    // Takes batches from the ring until it is closed and empty, with
+    // `take` passing each value to the stage.
+    template <::std::size_t I, typename Take>
+    void drain(Take take) {
+        spsc_ring<input_at<I>>& in = *::std::get<I>(rings_);
+        detail::backoff wait;
+        for (;;) {
+            if (failed_.load(::std::memory_order_acquire)) {
+                return;
+            }
+            if (in.try_pop(options_.batch, take) != 0) {
+                wait.reset();
+                continue;
+            }
+            // Values pushed before the ring was closed are visible once
+            // it is seen to be closed.
+            if (in.closed()) {
+                if (in.try_pop(options_.batch, take) == 0) {
+                    return;
+                }
+                continue;
+            }
+            wait();
+        }
+    }
+
+    template <::std::size_t I>
+    void run(::std::true_type) {
+        stage_type<I>& stage = ::std::get<I>(stages_);
+        drain<I>([&stage](input_at<I>&& value) {
+            detail::call_last_stage(stage, optimus::move(value), 0);
+        });
+    }
+
+    template <::std::size_t I>
+    void run(::std::false_type) {
+        using output = input_at<I + 1>;
+        stage_type<I>& stage = ::std::get<I>(stages_);
+        spsc_ring<output>& out = *::std::get<I + 1>(rings_);
+        ::std::vector<output> batch;
+        batch.reserve(options_.batch);
+        auto emit = [&batch](output value) {
+            batch.push_back(optimus::move(value));
+        };
+
+        // Hands the batch on, waiting while the next ring is full.
+        auto flush = [&] {
+            detail::backoff wait;
+            ::std::size_t done = 0;
+            while (done != batch.size() && !failed_.load(::std::memory_order_acquire)) {
+                const ::std::size_t pushed = out.try_push(
+                        ::std::make_move_iterator(batch.begin() + ::std::ptrdiff_t(done)), batch.size() - done);
+                done += pushed;
+                if (pushed == 0) {
+                    wait();
+                }
+            }
+            batch.clear();
+        };
+
+        struct closer {
+            spsc_ring<output>& ring;
+
+            ~closer() {
+                ring.close();
+            }
+        } close_out{out};
+
+        drain<I>([&](input_at<I>&& value) {
+            detail::call_stage(stage, optimus::move(value), emit, 0);
+            if (batch.size() >= options_.batch) {
+                flush();
+            }
+        });
+        flush();
+    }
+
+    pipeline_options options_;
+    ::std::tuple<Stages...> stages_;
+    rings rings_;
+    ::std::vector<::std::exception_ptr> errors_;
+    ::std::atomic<bool> failed_;
+    bool closed_;
+    ::std::vector<::std::thread> threads_;
+};
+
+} // namespace optimus
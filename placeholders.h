@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <optimus/functional.h>
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+namespace detail {
+
+// Returns the argument at position `Index`.
+template <::std::size_t Index>
+struct select_argument {
+    template <typename Arg, typename... Args>
+    constexpr auto operator()(Arg&&, Args&&... args) const noexcept
+            -> decltype(select_argument<Index - 1>{}(optimus::forward<Args>(args)...)) {
+        return select_argument<Index - 1>{}(optimus::forward<Args>(args)...);
+    }
+};
+
+template <>
+struct select_argument<0> {
+    template <typename Arg, typename... Args>
+    constexpr Arg&& operator()(Arg&& arg, Args&&...) const noexcept {
+        return optimus::forward<Arg>(arg);
+    }
+};
+
+// The functional.h operator which is applied to arguments of types `Ts`.
+template <template <typename> class Op, typename... Ts>
+using operation_t = Op<typename ::std::common_type<typename ::std::decay<Ts>::type...>::type>;
+
+} // namespace detail
+
+/**
+ * A function object which returns its argument at position `Index`
+ * (zero based). Placeholders combine with the usual operators into
+ * expressions, each node of which applies the matching operator from
+ * functional.h, e.g. `_1 * _2 + _3` is a function object equivalent to
+ *
+ *   plus<T>{}(multiplies<T>{}(a, b), c)
+ *
+ * where `T` is the common type of the operands. The whole tree is a single
+ * constexpr function object with no indirection, so the compiler sees one
+ * body and is free to contract it (fused multiply-add) or to evaluate
+ * `&&` and `||` without branches. Note that, like `logical_and` and
+ * `logical_or`, both operands are always evaluated.
+ *
+ * Operands which are not expressions are captured by value as a
+ * `constant`, so `_1 < 5` compares its argument with a stored 5. Operands
+ * which are not scalars are held in a `constant_ref`, so that
+ * `_1 == std::string("x")` does not copy the string on every call.
+ */
+template <::std::size_t Index>
+struct placeholder {
+    constexpr placeholder() noexcept { }
+    constexpr placeholder(const placeholder&) = default;
+    constexpr placeholder(placeholder&&) = default;
+
+    template <typename... Args, typename = typename ::std::enable_if<(Index < sizeof...(Args))>::type>
+    constexpr auto operator()(Args&&... args) const noexcept
+            -> decltype(detail::select_argument<Index>{}(optimus::forward<Args>(args)...)) {
+        return detail::select_argument<Index>{}(optimus::forward<Args>(args)...);
+    }
+};
+
+template <template <typename> class Op, typename Arg>
+struct unary_expression {
+    constexpr unary_expression() = default;
+    constexpr unary_expression(const unary_expression&) = default;
+    constexpr unary_expression(unary_expression&&) = default;
+
+    explicit constexpr unary_expression(Arg arg) noexcept(::std::is_nothrow_move_constructible<Arg>::value)
+            : arg_(optimus::move(arg)) { }
+
+    Arg arg_;
+
+    template <typename... Args>
+    constexpr auto operator()(Args&&... args) const
+            noexcept(noexcept(detail::operation_t<Op, result_of_t<const Arg(Args&...)>>{}(
+                ::std::declval<const Arg&>()(::std::declval<Args&>()...))))
+            -> result_of_t<const detail::operation_t<Op, result_of_t<const Arg(Args&...)>>(
+                    result_of_t<const Arg(Args&...)>)> {
+        return detail::operation_t<Op, result_of_t<const Arg(Args&...)>>{}(arg_(args...));
+    }
+};
+
+template <template <typename> class Op, typename Lhs, typename Rhs>
+struct binary_expression {
+    constexpr binary_expression() = default;
+    constexpr binary_expression(const binary_expression&) = default;
+    constexpr binary_expression(binary_expression&&) = default;
+
+    constexpr binary_expression(Lhs lhs, Rhs rhs)
+            noexcept(::std::is_nothrow_move_constructible<Lhs>::value &&
+                     ::std::is_nothrow_move_constructible<Rhs>::value)
+            : lhs_(optimus::move(lhs)), rhs_(optimus::move(rhs)) { }
+
+    Lhs lhs_;
+    Rhs rhs_;
+
+    // Arguments are passed on as lvalues, since more than one placeholder
+    // may refer to the same argument.
+    template <typename... Args>
+    constexpr auto operator()(Args&&... args) const
+            noexcept(noexcept(detail::operation_t<
+                    Op,
+                    result_of_t<const Lhs(Args&...)>,
+                    result_of_t<const Rhs(Args&...)>
+                >{}(::std::declval<const Lhs&>()(::std::declval<Args&>()...),
+                    ::std::declval<const Rhs&>()(::std::declval<Args&>()...))))
+            -> result_of_t<const detail::operation_t<
+                    Op,
+                    result_of_t<const Lhs(Args&...)>,
+                    result_of_t<const Rhs(Args&...)>
+                >(result_of_t<const Lhs(Args&...)>, result_of_t<const Rhs(Args&...)>)> {
+        return detail::operation_t<
+                Op,
+                result_of_t<const Lhs(Args&...)>,
+                result_of_t<const Rhs(Args&...)>
+            >{}(lhs_(args...), rhs_(args...));
+    }
+};
+
+template <typename T>
+struct is_expression : ::std::false_type { };
+
+template <::std::size_t Index>
+struct is_expression<placeholder<Index>> : ::std::true_type { };
+
+template <template <typename> class Op, typename Arg>
+struct is_expression<unary_expression<Op, Arg>> : ::std::true_type { };
+
+template <template <typename> class Op, typename Lhs, typename Rhs>
+struct is_expression<binary_expression<Op, Lhs, Rhs>> : ::std::true_type { };
+
+namespace detail {
+
+template <typename T>
+using is_decayed_expression = is_expression<typename ::std::decay<T>::type>;
+
+template <typename T>
+constexpr typename ::std::decay<T>::type to_expression(T&& v, ::std::true_type /* is_expression */) {
+    return optimus::forward<T>(v);
+}
+
+// Scalars are returned by value; anything else, such as a string, by
+// reference, so that it is not copied on every call.
+template <typename T>
+using captured_t = typename ::std::conditional<
+    ::std::is_scalar<typename ::std::decay<T>::type>::value,
+    optimus::constant<typename ::std::decay<T>::type>,
+    optimus::constant_ref<typename ::std::decay<T>::type>
+>::type;
+
+template <typename T>
+constexpr captured_t<T> to_expression(T&& v, ::std::false_type /* is_expression */) {
+    return captured_t<T>{optimus::forward<T>(v)};
+}
+
+template <typename Integral, Integral Value>
+constexpr optimus::constant<::std::integral_constant<Integral, Value>>
+to_expression(::std::integral_constant<Integral, Value>, ::std::false_type /* is_expression */) {
+    return optimus::constant<::std::integral_constant<Integral, Value>>{};
+}
+
+template <typename T>
+constexpr auto to_expression(T&& v)
+        -> decltype(to_expression(optimus::forward<T>(v), is_decayed_expression<T>{})) {
+    return to_expression(optimus::forward<T>(v), is_decayed_expression<T>{});
+}
+
+template <typename T>
+using expression_t = decltype(to_expression(::std::declval<T>()));
+
+template <typename Lhs, typename Rhs>
+using enable_if_expression_t = typename ::std::enable_if<
+    is_decayed_expression<Lhs>::value || is_decayed_expression<Rhs>::value
+>::type;
+
+} // namespace detail
+
+#define OPTIMUS_UNARY_EXPRESSION_OPERATOR(Function, Op) \
+    template <typename Arg, typename = detail::enable_if_expression_t<Arg, Arg>> \
+    constexpr unary_expression<Op, detail::expression_t<Arg>> operator Function(Arg&& arg) { \
+        return unary_expression<Op, detail::expression_t<Arg>>{ \
+            detail::to_expression(optimus::forward<Arg>(arg))}; \
+    }
+
+#define OPTIMUS_BINARY_EXPRESSION_OPERATOR(Function, Op) \
+    template <typename Lhs, typename Rhs, typename = detail::enable_if_expression_t<Lhs, Rhs>> \
+    constexpr binary_expression<Op, detail::expression_t<Lhs>, detail::expression_t<Rhs>> \
+    operator Function(Lhs&& lhs, Rhs&& rhs) { \
+        return binary_expression<Op, detail::expression_t<Lhs>, detail::expression_t<Rhs>>{ \
+            detail::to_expression(optimus::forward<Lhs>(lhs)), \
+            detail::to_expression(optimus::forward<Rhs>(rhs))}; \
+    }
+
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(+, plus)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(-, minus)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(*, multiplies)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(/, divides)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(%, modulus)
+OPTIMUS_UNARY_EXPRESSION_OPERATOR(-, negate)
+
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(==, equal_to)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(!=, not_equal_to)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(>, greater)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(<, less)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(>=, greater_equal)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(<=, less_equal)
+
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(&&, logical_and)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(||, logical_or)
+OPTIMUS_UNARY_EXPRESSION_OPERATOR(!, logical_not)
+
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(&, bit_and)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(|, bit_or)
+OPTIMUS_BINARY_EXPRESSION_OPERATOR(^, bit_xor)
+
+#undef OPTIMUS_UNARY_EXPRESSION_OPERATOR
+#undef OPTIMUS_BINARY_EXPRESSION_OPERATOR
+
+namespace placeholders {
+
+constexpr placeholder<0> _1{};
+constexpr placeholder<1> _2{};
+constexpr placeholder<2> _3{};
+constexpr placeholder<3> _4{};
+constexpr placeholder<4> _5{};
+constexpr placeholder<5> _6{};
+constexpr placeholder<6> _7{};
+constexpr placeholder<7> _8{};
+constexpr placeholder<8> _9{};
+
+} // namespace placeholders
+
+} // namespace optimus
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Defined in tuple_core.h. This header only reads the public `head_` and
+// `tail_` members, so it does not include tuple.h and can be used alongside
+// the get<I> transformers of transformers.h.
+template <typename... Types>
+struct tuple;
+
+namespace detail {
+
+constexpr ::std::size_t align_up(::std::size_t n, ::std::size_t alignment) {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+// Offset of field `I` when the fields `Types` are laid out from `Offset`.
+template <::std::size_t I, ::std::size_t Offset, typename... Types>
+struct field_offset;
+
+template <::std::size_t I, ::std::size_t Offset, typename T, typename... Types>
+struct field_offset<I, Offset, T, Types...>
+    : field_offset<I - 1, align_up(Offset, alignof(T)) + sizeof(T), Types...> { };
+
+template <::std::size_t Offset, typename T, typename... Types>
+struct field_offset<0, Offset, T, Types...>
+    : ::std::integral_constant<::std::size_t, align_up(Offset, alignof(T))> { };
+
+// One past the last field when the fields `Types` are laid out from `Offset`.
+template <::std::size_t Offset, typename... Types>
+struct fields_end : ::std::integral_constant<::std::size_t, Offset> { };
+
+template <::std::size_t Offset, typename T, typename... Types>
+struct fields_end<Offset, T, Types...>
+    : fields_end<align_up(Offset, alignof(T)) + sizeof(T), Types...> { };
+
+template <typename... Types>
+struct max_alignment : ::std::integral_constant<::std::size_t, 1> { };
+
+template <typename T, typename... Types>
+struct max_alignment<T, Types...> : ::std::integral_constant<
+    ::std::size_t,
+    (alignof(T) > max_alignment<Types...>::value) ? alignof(T) : max_alignment<Types...>::value
+> { };
+
+template <::std::size_t I, typename T, typename... Types>
+struct field_type : field_type<I - 1, Types...> { };
+
+template <typename T, typename... Types>
+struct field_type<0, T, Types...> {
+    using type = T;
+};
+
+// Describes a field well enough that a reader compiled with a different
+// record type notices: size, alignment and a coarse kind.
+template <typename T>
+constexpr ::std::uint64_t field_descriptor() {
+    return ::std::uint64_t(sizeof(T))
+        | (::std::uint64_t(alignof(T)) << 16)
+        | (::std::uint64_t(
+                ::std::is_floating_point<T>::value ? 1 :
+                ::std::is_signed<T>::value ? 2 :
+                ::std::is_unsigned<T>::value ? 3 :
+                ::std::is_enum<T>::value ? 4 : 5) << 32);
+}
+
+// FNV-1a over the field descriptors.
+constexpr ::std::uint64_t schema_hash(::std::uint64_t hash) {
+    return hash;
+}
+
+template <typename... Descriptors>
+constexpr ::std::uint64_t schema_hash(::std::uint64_t hash, ::std::uint64_t descriptor,
+                                      Descriptors... descriptors) {
+    return schema_hash((hash ^ descriptor) * 0x100000001b3ull, descriptors...);
+}
+
+// The fields of a record: optimus::tuple is walked through its members, and
+// anything else (std::tuple, std::pair, std::array) through ::std::get.
+template <::std::size_t I>
+struct record_field {
+    template <typename T, typename... Types>
+    static constexpr auto get(const optimus::tuple<T, Types...>& t)
+            -> decltype(record_field<I - 1>::get(t.tail_)) {
+        return record_field<I - 1>::get(t.tail_);
+    }
+
+    template <typename Record>
+    static constexpr auto get(const Record& r) -> decltype(::std::get<I>(r)) {
+        return ::std::get<I>(r);
+    }
+};
+
+template <>
+struct record_field<0> {
+    template <typename T, typename... Types>
+    static constexpr const T& get(const optimus::tuple<T, Types...>& t) {
+        return t.head_;
+    }
+
+    template <typename Record>
+    static constexpr auto get(const Record& r) -> decltype(::std::get<0>(r)) {
+        return ::std::get<0>(r);
+    }
+};
+
+} // namespace detail
+
+/**
+ * The flat layout of a record with fields `Types`: each field at its
+ * natural alignment, in order, with the record padded to the largest
+ * alignment so that records can be packed back to back. This is the layout
+ * a struct with the same members would have on the common ABIs.
+ *
+ * All fields must be trivially copyable, since they are written and read as
+ * raw bytes. The layout is that of the host, so files are only portable
+ * between machines with the same byte order and type sizes; the file header
+ * records both and the reader refuses anything else.
+ */
+template <typename... Types>
+struct record_layout {
+    static_assert(all_of<::std::is_trivially_copyable<Types>...>::value,
+                  "record fields must be trivially copyable");
+
+    template <::std::size_t I>
+    using type = typename detail::field_type<I, Types...>::type;
+
+    template <::std::size_t I>
+    static constexpr ::std::size_t offset() {
+        return detail::field_offset<I, 0, Types...>::value;
+    }
+
+    static constexpr ::std::size_t alignment = detail::max_alignment<Types...>::value;
+    static constexpr ::std::size_t size =
+        detail::align_up(detail::fields_end<0, Types...>::value, alignment);
+    static constexpr ::std::uint64_t schema =
+        detail::schema_hash(0xcbf29ce484222325ull, detail::field_descriptor<Types>()...);
+};
+
+template <typename... Types>
+constexpr ::std::size_t record_layout<Types...>::alignment;
+
+template <typename... Types>
+constexpr ::std::size_t record_layout<Types...>::size;
+
+template <typename... Types>
+constexpr ::std::uint64_t record_layout<Types...>::schema;
+
+/**
+ * The 64 byte header at the start of a record file, followed (at
+ * `data_offset`) by `record_count` records of `record_size` bytes each.
+ */
+struct record_file_header {
+    static constexpr ::std::uint64_t file_magic = 0x3143455253554d4full; // "OMUSREC1"
+    static constexpr ::std::uint32_t current_version = 1;
+    static constexpr ::std::uint32_t native_byte_order = 0x01020304;
+
+    ::std::uint64_t magic;
+    ::std::uint32_t version;
+    ::std::uint32_t byte_order;
+    ::std::uint64_t schema;
+    ::std::uint64_t record_size;
+    ::std::uint64_t record_count;
+    ::std::uint64_t data_offset;
+    ::std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(record_file_header) == 64, "record_file_header must be 64 bytes");
+
+namespace detail {
+
+template <typename... Types, typename Record, ::std::size_t... Indices>
+void serialize_record(const Record& record, unsigned char* out, index_sequence<Indices...>) {
+    static_assert(all_of<::std::is_same<
+                      typename ::std::decay<decltype(record_field<Indices>::get(record))>::type,
+                      typename record_layout<Types...>::template type<Indices>>...>::value,
+                  "record fields must be exactly of the layout's types");
+    using swallow = int[];
+    (void)swallow{0, (::std::memcpy(
+            out + record_layout<Types...>::template offset<Indices>(),
+            &record_field<Indices>::get(record),
+            sizeof(typename record_layout<Types...>::template type<Indices>)), 0)...};
+}
+
+} // namespace detail
+
+/**
+ * Writes `record` into the `record_layout<Types...>::size` bytes at `out`.
+ * `record` is an optimus::tuple, or anything else whose fields ::std::get
+ * can reach, whose fields are exactly of the types `Types`.
+ * Padding bytes are zeroed so that files are reproducible.
+ */
+template <typename... Types, typename Record>
+void serialize_record(const Record& record, void* out) {
+    unsigned char* bytes = static_cast<unsigned char*>(out);
+    ::std::memset(bytes, 0, record_layout<Types...>::size);
+    detail::serialize_record<Types...>(record, bytes, index_sequence_for<Types...>{});
+}
+
+/**
+ * Writes a record file holding the records in [first, last) to `out`.
+ * Records are serialized in blocks, so memory use does not grow with the
+ * input. Returns whether the stream is still good.
+ */
+template <typename... Types, typename ForwardIterator>
+bool write_record_file(::std::ostream& out, ForwardIterator first, ForwardIterator last) {
+    using layout = record_layout<Types...>;
+
+    record_file_header header;
+    ::std::memset(&header, 0, sizeof(header));
+    header.magic = record_file_header::file_magic;
+    header.version = record_file_header::current_version;
+    header.byte_order = record_file_header::native_byte_order;
+    header.schema = layout::schema;
+    header.record_size = layout::size;
+    header.record_count = ::std::uint64_t(::std::distance(first, last));
+    header.data_offset = detail::align_up(sizeof(header), layout::alignment);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[layout::alignment] = { };
+    out.write(padding, ::std::streamsize(header.data_offset - sizeof(header)));
+
+    constexpr ::std::size_t block_records = (64 * 1024 + layout::size - 1) / layout::size;
+    ::std::vector<unsigned char> block(block_records * layout::size);
+    while (first != last && out) {
+        ::std::size_t n = 0;
+        for (; n < block_records && first != last; ++n, ++first) {
+            serialize_record<Types...>(*first, block.data() + n * layout::size);
+        }
+        out.write(reinterpret_cast<const char*>(block.data()), ::std::streamsize(n * layout::size));
+    }
+    return bool(out);
+}
+
+/**
+ * A read-only reference to a record in place. Fields are reached through
+ * `get<I>`, found by argument dependent lookup, so `optimus::get<I>` and
+ * its transformers apply to it as they do to tuples, without copying the
+ * record.
+ */
+template <typename... Types>
+class record_ref : public detail::tuple_like_adl::tuple_like<record_ref<Types...>> {
+  public:
+    using layout = record_layout<Types...>;
+
+    explicit constexpr record_ref(const unsigned char* data) : data_(data) { }
+
+    template <::std::size_t I>
+    const typename layout::template type<I>& get() const noexcept {
+        return *reinterpret_cast<const typename layout::template type<I>*>(
+            data_ + layout::template offset<I>());
+    }
+
+    const unsigned char* data() const {
+        return data_;
+    }
+
+  private:
+    friend class detail::tuple_like_adl::tuple_like<record_ref>;
+
+    // Read by the `get<I>` of tuple_like for every value category, since the
+    // fields belong to the buffer rather than to the reference.
+    template <::std::size_t I>
+    static const typename layout::template type<I>& get_element(const record_ref& r) noexcept {
+        return r.template get<I>();
+    }
+
+    const unsigned char* data_;
+};
+
+/**
+ * A view of a record file which reads the records in place, typically from
+ * a mapped_file. Nothing is parsed or copied: opening a view only checks
+ * the header, and each record is read when its fields are.
+ *
+ * A view of a buffer which is not a record file of `Types`, whether it is
+ * truncated, misaligned, of another version or written with another record
+ * type or byte order, is not `valid()` and is empty.
+ */
+template <typename... Types>
+class record_file_view {
+  public:
+    using layout = record_layout<Types...>;
+    using value_type = record_ref<Types...>;
+
+    class iterator {
+      public:
+        using iterator_category = ::std::random_access_iterator_tag;
+        using value_type = record_ref<Types...>;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = void;
+        using reference = record_ref<Types...>;
+
+        iterator() : data_(nullptr) { }
+        explicit iterator(const unsigned char* data) : data_(data) { }
+
+        reference operator*() const { return reference{data_}; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        iterator& operator++() { data_ += layout::size; return *this; }
+        iterator& operator--() { data_ -= layout::size; return *this; }
+        iterator operator++(int) { iterator it = *this; ++*this; return it; }
+        iterator operator--(int) { iterator it = *this; --*this; return it; }
+        iterator& operator+=(difference_type n) { data_ += n * difference_type(layout::size); return *this; }
+        iterator& operator-=(difference_type n) { data_ -= n * difference_type(layout::size); return *this; }
+
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const iterator& lhs, const iterator& rhs) {
+            return (lhs.data_ - rhs.data_) / difference_type(layout::size);
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) { return lhs.data_ == rhs.data_; }
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) { return lhs.data_ != rhs.data_; }
+        friend bool operator<(const iterator& lhs, const iterator& rhs) { return lhs.data_ < rhs.data_; }
+        friend bool operator>(const iterator& lhs, const iterator& rhs) { return lhs.data_ > rhs.data_; }
+        friend bool operator<=(const iterator& lhs, const iterator& rhs) { return lhs.data_ <= rhs.data_; }
+        friend bool operator>=(const iterator& lhs, const iterator& rhs) { return lhs.data_ >= rhs.data_; }
+
+      private:
+        const unsigned char* data_;
+    };
+
+    record_file_view(const void* data, ::std::size_t size) : records_(nullptr), size_(0) {
+        record_file_header header;
+        if (data == nullptr || size < sizeof(header)) {
+            return;
+        }
+        ::std::memcpy(&header, data, sizeof(header));
+        if (header.magic != record_file_header::file_magic
+                || header.version != record_file_header::current_version
+                || header.byte_order != record_file_header::native_byte_order
+                || header.schema != layout::schema
+                || header.record_size != layout::size
+                || header.data_offset < sizeof(header)
+                || header.data_offset > size
+                || header.record_count > (size - header.data_offset) / layout::size) {
+            return;
+        }
+        const unsigned char* records = static_cast<const unsigned char*>(data) + header.data_offset;
+        if (reinterpret_cast<::std::uintptr_t>(records) % layout::alignment != 0) {
+            return;
+        }
+        records_ = records;
+        size_ = ::std::size_t(header.record_count);
+    }
+
+    bool valid() const {
+        return records_ != nullptr;
+    }
+
+    ::std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    record_ref<Types...> operator[](::std::size_t i) const {
+        return record_ref<Types...>{records_ + i * layout::size};
+    }
+
+    iterator begin() const {
+        return iterator{records_};
+    }
+
+    iterator end() const {
+        return iterator{records_ + size_ * layout::size};
+    }
+
+  private:
+    const unsigned char* records_;
+    ::std::size_t size_;
+};
+
+} // namespace optimus
+
+namespace std {
+
+template <typename... Types>
+struct tuple_size<optimus::record_ref<Types...>>
+    : ::std::integral_constant<::std::size_t, sizeof...(Types)> { };
+
+template <std::size_t I, typename... Types>
+struct tuple_element<I, optimus::record_ref<Types...>> {
+    using type = const typename optimus::record_layout<Types...>::template type<I>;
+};
+
+} // namespace std
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <optimus/functional.h>
+#include <optimus/parallel.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Elements below which a scan is not worth splitting between threads.
+constexpr ::std::size_t scan_parallel_min = ::std::size_t(1) << 18;
+
+// Blocks a parallel scan makes per thread, so that a thread which falls
+// behind can be helped by the others.
+constexpr ::std::size_t scan_blocks_per_thread = 4;
+
+namespace detail {
+
+// Makes T a non-deduced context, so that an initial value such as 0
+// converts to the element type.
+template <typename T>
+struct scan_value {
+    using type = T;
+};
+
+// The SIMD operation which scans T with Op in register, or void.
+template <typename T, typename Op>
+struct scan_lane {
+    using type = void;
+};
+
+template <bool Inclusive, typename Lane>
+struct vector_scan;
+
+#if defined(__SSE2__)
+struct sse_plus32 {
+    static __m128i apply(__m128i a, __m128i b) {
+        return _mm_add_epi32(a, b);
+    }
+};
+
+struct sse_plus64 {
+    static __m128i apply(__m128i a, __m128i b) {
+        return _mm_add_epi64(a, b);
+    }
+};
+
+struct sse_xor {
+    static __m128i apply(__m128i a, __m128i b) {
+        return _mm_xor_si128(a, b);
+    }
+};
+
+template <typename T>
+struct is_scan_integer
+    : ::std::integral_constant<bool, ::std::is_integral<T>::value && !::std::is_same<T, bool>::value &&
+                                         (sizeof(T) == 4 || sizeof(T) == 8)> { };
+
+template <typename T>
+struct scan_lane<T, plus<T>> {
+    using type = typename ::std::conditional<
+        is_scan_integer<T>::value, typename ::std::conditional<sizeof(T) == 4, sse_plus32, sse_plus64>::type,
+        void>::type;
+};
+
+template <typename T>
+struct scan_lane<T, bit_xor<T>> {
+    using type = typename ::std::conditional<is_scan_integer<T>::value, sse_xor, void>::type;
+};
+
+/**
+ * Scans the whole vectors of `in` into `out`, folding them into `carry`,
+ * and returns how many elements that was. Each vector is scanned in
+ * register by combining it with itself shifted by one lane and then by
+ * two, which shifts in zeroes, the identity of plus and bit_xor; then the
+ * carry, broadcast to every lane, is combined in.
+ */
+template <bool Inclusive, typename Lane>
+struct vector_scan {
+    template <typename T>
+    static ::std::size_t run(const T* in, ::std::size_t n, T* out, T& carry) {
+        constexpr ::std::size_t lanes = sizeof(__m128i) / sizeof(T);
+        T lane_values[lanes];
+        ::std::fill(lane_values, lane_values + lanes, carry);
+        __m128i carries = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane_values));
+        ::std::size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            x = Lane::apply(x, _mm_slli_si128(x, sizeof(T)));
+            if (lanes == 4) {
+                x = Lane::apply(x, _mm_slli_si128(x, 8));
+            }
+            const __m128i scanned = Inclusive ? x : _mm_slli_si128(x, sizeof(T));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Lane::apply(scanned, carries));
+            carries = Lane::apply(carries, _mm_shuffle_epi32(x, lanes == 4 ? 0xff : 0xee));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_values), carries);
+        carry = lane_values[0];
+        return i;
+    }
+};
+#endif
+
+// No SIMD form: everything is left to the scalar loop.
+template <bool Inclusive>
+struct vector_scan<Inclusive, void> {
+    template <typename T>
+    static ::std::size_t run(const T*, ::std::size_t, T*, T&) {
+        return 0;
+    }
+};
+
+/**
+ * Scans `n` elements of `in` into `out`, starting from `carry`, and
+ * returns the fold of `carry` and the elements. An inclusive scan writes
+ * op(carry, in[0]) first and an exclusive one `carry`. `in` may be `out`.
+ */
+template <bool Inclusive, typename T, typename Op>
+T scan_from(const T* in, ::std::size_t n, T* out, T carry, const Op& op) {
+    ::std::size_t i = vector_scan<Inclusive, typename scan_lane<T, Op>::type>::run(in, n, out, carry);
+    for (; i < n; ++i) {
+        const T value = in[i];
+        if (Inclusive) {
+            carry = op(carry, value);
+            out[i] = carry;
+        } else {
+            out[i] = carry;
+            carry = op(carry, value);
+        }
+    }
+    return carry;
+}
+
+// An inclusive scan with no carry to start from, or an exclusive scan
+// starting from `*init`.
+template <bool Inclusive, typename T, typename Op>
+void scan_serial(const T* in, ::std::size_t n, T* out, const T* init, const Op& op) {
+    if (init != nullptr) {
+        scan_from<Inclusive>(in, n, out, *init, op);
+    } else if (n != 0) {
+        const T head = in[0];
+        out[0] = head;
+        scan_from<Inclusive>(in + 1, n - 1, out + 1, head, op);
+    }
+}
+
+/**
+ * A scan in three phases on `pool`: every block is folded in parallel,
+ * the folds are scanned on this thread to give the carry into each block,
+ * and every block is scanned from its carry in parallel. Each element is
+ * read twice and written once, so the scan may be in place.
+ */
+template <bool Inclusive, typename T, typename Op>
+void scan_blocks(work_stealing_pool& pool, const T* in, ::std::size_t n, T* out, const T* init, const Op& op) {
+    const ::std::size_t target = ::std::min((pool.size() + 1) * scan_blocks_per_thread, n);
+    const ::std::size_t block = (n + target - 1) / target;
+    const ::std::size_t blocks = (n + block - 1) / block;
+
+    ::std::vector<T> carries(blocks, in[0]);
+    pool.for_each_index(blocks, [in, n, block, &carries, &op](::std::size_t b) {
+        const ::std::size_t begin = b * block;
+        const ::std::size_t end = ::std::min(n, begin + block);
+        T fold = in[begin];
+        for (::std::size_t i = begin + 1; i < end; ++i) {
+            fold = op(fold, in[i]);
+        }
+        carries[b] = fold;
+    });
+
+    T running = init != nullptr ? *init : carries[0];
+    for (::std::size_t b = init != nullptr ? 0 : 1; b < blocks; ++b) {
+        const T fold = carries[b];
+        carries[b] = running;
+        running = op(running, fold);
+    }
+
+    pool.for_each_index(blocks, [in, n, out, block, init, &carries, &op](::std::size_t b) {
+        const ::std::size_t begin = b * block;
+        const ::std::size_t end = ::std::min(n, begin + block);
+        if (b == 0 && init == nullptr) {
+            scan_serial<Inclusive>(in, end, out, init, op);
+        } else {
+            scan_from<Inclusive>(in + begin, end - begin, out + begin, carries[b], op);
+        }
+    });
+}
+
+template <bool Inclusive, typename T, typename Op>
+void scan(work_stealing_pool* pool, const T* in, ::std::size_t n, T* out, const T* init, const Op& op) {
+    if (n < scan_parallel_min) {
+        scan_serial<Inclusive>(in, n, out, init, op);
+        return;
+    }
+    if (pool == nullptr) {
+        pool = &work_stealing_pool::shared();
+    }
+    if (pool->size() == 0) {
+        scan_serial<Inclusive>(in, n, out, init, op);
+    } else {
+        scan_blocks<Inclusive>(*pool, in, n, out, init, op);
+    }
+}
+
+} // namespace detail
+
+/**
+ * Writes to `out` the running fold with `Op` of [first, last): out[i] is
+ * first[0] op ... op first[i]. Returns the end of `out`. `out` may be
+ * `first`. Op must be associative.
+ *
+ * Scans of 32 and 64 bit integers with optimus::plus or optimus::bit_xor
+ * run four or two elements at a time in SIMD registers. Arrays of at
+ * least scan_parallel_min elements are split between the threads of
+ * `pool`, by default work_stealing_pool::shared(); for floating point this
+ * groups the additions differently from a serial scan.
+ */
+template <typename T, typename Op = plus<T>>
+T* inclusive_scan(work_stealing_pool& pool, const T* first, const T* last, T* out, Op op = Op{}) {
+    detail::scan<true>(&pool, first, ::std::size_t(last - first), out, static_cast<const T*>(nullptr), op);
+    return out + (last - first);
+}
+
+template <typename T, typename Op = plus<T>>
+T* inclusive_scan(const T* first, const T* last, T* out, Op op = Op{}) {
+    detail::scan<true>(nullptr, first, ::std::size_t(last - first), out, static_cast<const T*>(nullptr), op);
+    return out + (last - first);
+}
+
+/**
+ * As inclusive_scan, but out[i] is init op first[0] op ... op first[i - 1],
+ * so out[0] is `init`.
+ */
+template <typename T, typename Op = plus<T>>
+T* exclusive_scan(work_stealing_pool& pool, const T* first, const T* last, T* out,
+                  typename detail::scan_value<T>::type init, Op op = Op{}) {
+    detail::scan<false>(&pool, first, ::std::size_t(last - first), out, &init, op);
+    return out + (last - first);
+}
+
+template <typename T, typename Op = plus<T>>
+T* exclusive_scan(const T* first, const T* last, T* out, typename detail::scan_value<T>::type init, Op op = Op{}) {
+    detail::scan<false>(nullptr, first, ::std::size_t(last - first), out, &init, op);
+    return out + (last - first);
+}
+
+} // namespace optimus
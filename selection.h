@@ -0,0 +1,346 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Rows a predicate_selector evaluates at once, a multiple of 64.
+constexpr ::std::size_t selection_block = 1024;
+
+// Blocks between reorderings of a predicate_selector's predicates.
+constexpr ::std::size_t selection_reorder_blocks = 8;
+
+namespace detail {
+
+// The predicates of an all_of_pred or any_of_pred, held so that a constexpr
+// function can reach them, which std::get cannot before C++14.
+template <typename... Preds>
+struct predicate_list {
+    constexpr predicate_list() { }
+
+    template <typename... Args>
+    constexpr bool all(const Args&...) const {
+        return true;
+    }
+
+    template <typename... Args>
+    constexpr bool any(const Args&...) const {
+        return false;
+    }
+};
+
+template <typename Pred, typename... Preds>
+struct predicate_list<Pred, Preds...> {
+    constexpr predicate_list() : head_(), tail_() { }
+
+    template <typename P, typename... Ps, typename = safe_forwarding_constructor_t<predicate_list, P, Ps...>>
+    explicit constexpr predicate_list(P&& head, Ps&&... tail)
+            : head_(optimus::forward<P>(head)), tail_(optimus::forward<Ps>(tail)...) { }
+
+    // Every predicate is evaluated: `&` and `|` on bools do not branch.
+    template <typename... Args>
+    constexpr bool all(const Args&... args) const {
+        return bool(head_(args...)) & tail_.all(args...);
+    }
+
+    template <typename... Args>
+    constexpr bool any(const Args&... args) const {
+        return bool(head_(args...)) | tail_.any(args...);
+    }
+
+    Pred head_;
+    predicate_list<Preds...> tail_;
+};
+
+template <::std::size_t Index>
+struct predicate_at {
+    template <typename Pred, typename... Preds>
+    static auto get(const predicate_list<Pred, Preds...>& preds)
+            -> decltype(predicate_at<Index - 1>::get(preds.tail_)) {
+        return predicate_at<Index - 1>::get(preds.tail_);
+    }
+};
+
+template <>
+struct predicate_at<0> {
+    template <typename Pred, typename... Preds>
+    static const Pred& get(const predicate_list<Pred, Preds...>& preds) {
+        return preds.head_;
+    }
+};
+
+// Packs eight bytes, each 0 or 1, into the low eight bits, the first byte
+// lowest: the multiply sums a shifted copy of each byte into the top byte.
+inline ::std::uint64_t pack_bytes(const unsigned char* bytes) {
+    ::std::uint64_t word;
+    ::std::memcpy(&word, bytes, sizeof(word));
+    return (word * 0x0102040810204080ull) >> 56;
+}
+
+/**
+ * Sets bit j of out[w] to predicate `Index` of `preds` on row 64w + j of
+ * the `n` rows from `rows`, for each word w with a bit set in live[w];
+ * other words are left 0. A full word is evaluated into 64 bytes by a
+ * fixed count loop without branches, which vectorizes for simple
+ * predicates, and the bytes are then packed into bits.
+ */
+template <::std::size_t Index, typename List, typename Iterator>
+void evaluate_predicate(const List& preds, Iterator rows, ::std::size_t n,
+                        const ::std::uint64_t* live, ::std::uint64_t* out) {
+    const auto& pred = predicate_at<Index>::get(preds);
+    for (::std::size_t w = 0; w * 64 < n; ++w) {
+        ::std::uint64_t bits = 0;
+        if (live[w] != 0) {
+            const Iterator row = rows + ::std::ptrdiff_t(w * 64);
+            if (n - w * 64 >= 64) {
+                unsigned char bytes[64];
+                for (unsigned j = 0; j < 64; ++j) {
+                    bytes[j] = static_cast<unsigned char>(bool(pred(row[j])));
+                }
+                for (unsigned j = 0; j < 8; ++j) {
+                    bits |= pack_bytes(bytes + 8 * j) << (8 * j);
+                }
+            } else {
+                for (unsigned j = 0; j < n - w * 64; ++j) {
+                    bits |= ::std::uint64_t(bool(pred(row[j]))) << j;
+                }
+            }
+        }
+        out[w] = bits;
+    }
+}
+
+} // namespace detail
+
+/**
+ * A predicate which holds when all of `Preds` hold for its arguments.
+ * Unlike logical_and, every predicate is evaluated and the results are
+ * combined with a bitwise and, so there is no branch to mispredict on
+ * unpredictable data. predicate_selector evaluates it over blocks of rows.
+ *
+ *   auto in_range = optimus::make_all_of_pred(_1 >= 10, _1 < 20);
+ */
+template <typename... Preds>
+struct all_of_pred {
+    static constexpr bool is_any = false;
+
+    constexpr all_of_pred() { }
+
+    template <typename... Ps, typename = safe_forwarding_constructor_t<all_of_pred, Ps...>>
+    explicit constexpr all_of_pred(Ps&&... preds) : preds_(optimus::forward<Ps>(preds)...) { }
+
+    template <typename... Args>
+    constexpr bool operator()(const Args&... args) const {
+        return preds_.all(args...);
+    }
+
+    detail::predicate_list<Preds...> preds_;
+};
+
+// As all_of_pred, for when any of `Preds` holds.
+template <typename... Preds>
+struct any_of_pred {
+    static constexpr bool is_any = true;
+
+    constexpr any_of_pred() { }
+
+    template <typename... Ps, typename = safe_forwarding_constructor_t<any_of_pred, Ps...>>
+    explicit constexpr any_of_pred(Ps&&... preds) : preds_(optimus::forward<Ps>(preds)...) { }
+
+    template <typename... Args>
+    constexpr bool operator()(const Args&... args) const {
+        return preds_.any(args...);
+    }
+
+    detail::predicate_list<Preds...> preds_;
+};
+
+template <typename... Preds>
+constexpr all_of_pred<typename ::std::decay<Preds>::type...> make_all_of_pred(Preds&&... preds) {
+    return all_of_pred<typename ::std::decay<Preds>::type...>{optimus::forward<Preds>(preds)...};
+}
+
+template <typename... Preds>
+constexpr any_of_pred<typename ::std::decay<Preds>::type...> make_any_of_pred(Preds&&... preds) {
+    return any_of_pred<typename ::std::decay<Preds>::type...>{optimus::forward<Preds>(preds)...};
+}
+
+template <typename Combined>
+class predicate_selector;
+
+/**
+ * Evaluates an all_of_pred or any_of_pred over rows a block at a time,
+ * into a bitmask or a selection vector (the indices of the rows it holds
+ * for). Each predicate fills a mask of the block, 64 rows to a word
+ * without branching, and the masks are combined word by word. Words whose
+ * result is already known (no row left for all_of, every row in for
+ * any_of) are not evaluated, and a block stops once all of them are.
+ *
+ * So that as little as possible is evaluated, the predicates are
+ * reordered every selection_reorder_blocks blocks by the share of rows
+ * they passed: for all_of_pred, the one which fails most rows goes first,
+ * and for any_of_pred, the one which passes most. The counts decay at
+ * each reordering so that the order follows drifting data.
+ */
+template <typename... Preds, template <typename...> class Combined>
+class predicate_selector<Combined<Preds...>> {
+    static constexpr ::std::size_t size = sizeof...(Preds);
+    static constexpr ::std::size_t block_words = selection_block / 64;
+    static constexpr bool is_any = Combined<Preds...>::is_any;
+
+    static_assert(selection_block % 64 == 0, "selection_block must be a multiple of 64");
+    static_assert(size > 0, "predicate_selector needs a predicate");
+
+  public:
+    using predicate_type = Combined<Preds...>;
+
+    explicit predicate_selector(predicate_type pred = predicate_type{})
+            : pred_(optimus::move(pred)), blocks_(0) {
+        for (::std::size_t i = 0; i < size; ++i) {
+            order_[i] = i;
+            passed_[i] = 0;
+            evaluated_[i] = 0;
+        }
+    }
+
+    const predicate_type& predicate() const {
+        return pred_;
+    }
+
+    // The order in which the predicates are evaluated, by their position.
+    const ::std::array<::std::size_t, size>& order() const {
+        return order_;
+    }
+
+    /**
+     * Sets bit i % 64 of word i / 64 from `out` to whether the predicate
+     * holds for row i of [first, last), and returns the end of the words
+     * written. Bits past the last row are 0.
+     */
+    template <typename Iterator>
+    ::std::uint64_t* mask(Iterator first, Iterator last, ::std::uint64_t* out) {
+        const ::std::size_t n = ::std::size_t(last - first);
+        for (::std::size_t i = 0; i < n; i += selection_block) {
+            evaluate(first + ::std::ptrdiff_t(i), ::std::min(selection_block, n - i), out + i / 64);
+        }
+        return out + (n + 63) / 64;
+    }
+
+    /**
+     * Writes the position in [first, last) of each row the predicate holds
+     * for, in order, from `out`, and returns the end of the positions.
+     */
+    template <typename Iterator, typename Index>
+    Index* select(Iterator first, Iterator last, Index* out) {
+        const ::std::size_t n = ::std::size_t(last - first);
+        ::std::uint64_t words[block_words];
+        for (::std::size_t i = 0; i < n; i += selection_block) {
+            const ::std::size_t rows = ::std::min(selection_block, n - i);
+            evaluate(first + ::std::ptrdiff_t(i), rows, words);
+            for (::std::size_t w = 0; w * 64 < rows; ++w) {
+                for (::std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                    *out++ = Index(i + w * 64 + detail::count_trailing_zeros(bits));
+                }
+            }
+        }
+        return out;
+    }
+
+  private:
+    using list = detail::predicate_list<Preds...>;
+
+    template <typename Iterator>
+    using evaluator = void (*)(const list&, Iterator, ::std::size_t, const ::std::uint64_t*, ::std::uint64_t*);
+
+    template <typename Iterator, ::std::size_t... Indices>
+    static const evaluator<Iterator>* evaluators(index_sequence<Indices...>) {
+        static const evaluator<Iterator> table[] = {&detail::evaluate_predicate<Indices, list, Iterator>...};
+        return table;
+    }
+
+    // Evaluates `n` rows, at most a block, into acc.
+    template <typename Iterator>
+    void evaluate(Iterator rows, ::std::size_t n, ::std::uint64_t* acc) {
+        const evaluator<Iterator>* table = evaluators<Iterator>(make_index_sequence<size>{});
+        const ::std::size_t words = (n + 63) / 64;
+        ::std::uint64_t valid[block_words];
+        ::std::uint64_t live[block_words];
+        ::std::uint64_t bits[block_words];
+        for (::std::size_t w = 0; w < words; ++w) {
+            valid[w] = n - w * 64 >= 64 ? ~::std::uint64_t(0) : (::std::uint64_t(1) << (n - w * 64)) - 1;
+            acc[w] = is_any ? 0 : valid[w];
+        }
+
+        for (::std::size_t k = 0; k < size; ++k) {
+            ::std::uint64_t any_live = 0;
+            ::std::uint64_t live_rows = 0;
+            for (::std::size_t w = 0; w < words; ++w) {
+                live[w] = is_any ? valid[w] & ~acc[w] : acc[w];
+                any_live |= live[w];
+                live_rows += detail::popcount(live[w]);
+            }
+            if (any_live == 0) {
+                break;
+            }
+
+            const ::std::size_t p = order_[k];
+            table[p](pred_.preds_, rows, n, live, bits);
+            ::std::uint64_t passed = 0;
+            for (::std::size_t w = 0; w < words; ++w) {
+                passed += detail::popcount(bits[w] & live[w]);
+                acc[w] = is_any ? acc[w] | bits[w] : acc[w] & bits[w];
+            }
+            passed_[p] += passed;
+            evaluated_[p] += live_rows;
+        }
+
+        if (++blocks_ % selection_reorder_blocks == 0) {
+            reorder();
+        }
+    }
+
+    // Whether predicate a should be evaluated before b, by their smoothed
+    // pass rates, compared without division.
+    bool before(::std::size_t a, ::std::size_t b) const {
+        const ::std::uint64_t rate_a = (passed_[a] + 1) * (evaluated_[b] + 2);
+        const ::std::uint64_t rate_b = (passed_[b] + 1) * (evaluated_[a] + 2);
+        return is_any ? rate_a > rate_b : rate_a < rate_b;
+    }
+
+    void reorder() {
+        for (::std::size_t i = 1; i < size; ++i) {
+            const ::std::size_t p = order_[i];
+            ::std::size_t j = i;
+            for (; j > 0 && before(p, order_[j - 1]); --j) {
+                order_[j] = order_[j - 1];
+            }
+            order_[j] = p;
+        }
+        for (::std::size_t i = 0; i < size; ++i) {
+            passed_[i] /= 2;
+            evaluated_[i] /= 2;
+        }
+    }
+
+    predicate_type pred_;
+    ::std::array<::std::size_t, size> order_;
+    ::std::array<::std::uint64_t, size> passed_;
+    ::std::array<::std::uint64_t, size> evaluated_;
+    ::std::size_t blocks_;
+};
+
+template <typename Combined>
+predicate_selector<typename ::std::decay<Combined>::type> make_selector(Combined&& pred) {
+    return predicate_selector<typename ::std::decay<Combined>::type>{optimus::forward<Combined>(pred)};
+}
+
+} // namespace optimus
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#include <optimus/functional.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Bytes per cache line, the size of a shard of a sharded_accumulator so
+// that no two threads write to the same line.
+constexpr ::std::size_t shard_cache_line = 64;
+
+// Accumulators whose shard a thread remembers at once. A thread which
+// updates more than this many in turn finds its shard again by a search
+// of the accumulator's claimed shards.
+constexpr ::std::size_t shard_cache_size = 16;
+
+namespace detail {
+
+// Ids of accumulators and of threads, never reused and never zero.
+inline ::std::uint64_t next_shard_owner_id() {
+    static ::std::atomic<::std::uint64_t> next{1};
+    return next.fetch_add(1, ::std::memory_order_relaxed);
+}
+
+inline ::std::uint64_t this_thread_shard_owner() {
+    static thread_local const ::std::uint64_t id = next_shard_owner_id();
+    return id;
+}
+
+// Which shard of which accumulator this thread updated. Ids are never
+// reused, so an entry of a destroyed accumulator never matches again.
+struct shard_cache_entry {
+    ::std::uint64_t accumulator;
+    void* shard;
+};
+
+inline shard_cache_entry* shard_cache() {
+    static thread_local shard_cache_entry cache[shard_cache_size] = {};
+    return cache;
+}
+
+// The entry for `accumulator`, probing linearly from its home slot, or
+// null if the probe reaches an empty entry or has seen them all.
+inline shard_cache_entry* find_shard_cache_entry(::std::uint64_t accumulator) {
+    shard_cache_entry* cache = shard_cache();
+    for (::std::size_t probe = 0; probe < shard_cache_size; ++probe) {
+        shard_cache_entry& entry = cache[(accumulator + probe) % shard_cache_size];
+        if (entry.accumulator == accumulator) {
+            return &entry;
+        }
+        if (entry.accumulator == 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+// Remembers `shard` for `accumulator` in the first empty entry of its
+// probe sequence, or in its home slot if the cache is full.
+inline void insert_shard_cache_entry(::std::uint64_t accumulator, void* shard) {
+    shard_cache_entry* cache = shard_cache();
+    shard_cache_entry* slot = &cache[accumulator % shard_cache_size];
+    for (::std::size_t probe = 0; probe < shard_cache_size; ++probe) {
+        shard_cache_entry& entry = cache[(accumulator + probe) % shard_cache_size];
+        if (entry.accumulator == 0) {
+            slot = &entry;
+            break;
+        }
+    }
+    slot->accumulator = accumulator;
+    slot->shard = shard;
+}
+
+} // namespace detail
+
+/**
+ * A value which many threads reduce into with `Op`, e.g. a counter with
+ * optimus::plus<std::uint64_t> or a set of flags with optimus::bit_or.
+ * Every thread which adds claims a shard of its own, on a cache line of
+ * its own, and updates it with a plain load and store: no atomic
+ * read-modify-write and no line shared between threads. read() folds the
+ * shards with Op, so Op must be associative and commutative.
+ *
+ * Shards start at the identity element of Op, identity_element<Op> unless
+ * another is given. If more threads add than there are shards, the
+ * threads left over share one more shard and update it with a
+ * compare-and-swap loop, which is correct but contended.
+ *
+ * T must be trivially copyable, so that a shard is a lock-free atomic
+ * which read() can load while its owner stores to it. Before C++17, which
+ * can ask the atomic, that is taken to mean a power of two size of at
+ * most 8 bytes.
+ */
+template <typename T, typename Op>
+class sharded_accumulator {
+    static_assert(::std::is_trivially_copyable<T>::value, "sharded_accumulator requires a trivially copyable type");
+#if defined(__cpp_lib_atomic_is_always_lock_free)
+    static_assert(::std::atomic<T>::is_always_lock_free, "sharded_accumulator requires a lock-free atomic<T>");
+#else
+    static_assert(sizeof(T) <= 8 && (sizeof(T) & (sizeof(T) - 1)) == 0,
+                  "sharded_accumulator requires a lock-free atomic<T>");
+#endif
+    static_assert(sizeof(::std::atomic<T>) <= shard_cache_line, "a shard must fit in a cache line");
+
+  public:
+    using value_type = T;
+
+    explicit sharded_accumulator(::std::size_t shards = default_shards())
+            : sharded_accumulator(shards, identity_element<Op>::value()) { }
+
+    sharded_accumulator(::std::size_t shards, T identity, Op op = Op{})
+            : id_(detail::next_shard_owner_id()), shards_(::std::max<::std::size_t>(shards, 1)),
+              claimed_(0), identity_(identity), op_(optimus::move(op)),
+              owners_(new ::std::atomic<::std::uint64_t>[shards_]) {
+        memory_.reset(new char[(shards_ + 2) * shard_cache_line]);
+        const ::std::uintptr_t base = reinterpret_cast<::std::uintptr_t>(memory_.get());
+        const ::std::uintptr_t aligned = (base + shard_cache_line - 1) / shard_cache_line * shard_cache_line;
+        slots_ = reinterpret_cast<shard*>(memory_.get() + (aligned - base));
+        for (::std::size_t i = 0; i <= shards_; ++i) {
+            ::new (static_cast<void*>(slots_ + i)) shard;
+            slots_[i].value.store(identity, ::std::memory_order_relaxed);
+        }
+        for (::std::size_t i = 0; i < shards_; ++i) {
+            owners_[i].store(0, ::std::memory_order_relaxed);
+        }
+    }
+
+    sharded_accumulator(const sharded_accumulator&) = delete;
+    sharded_accumulator& operator=(const sharded_accumulator&) = delete;
+
+    // Shards for threads which add, not counting the shared one.
+    ::std::size_t shards() const {
+        return shards_;
+    }
+
+    // Shards claimed by a thread so far, at most shards().
+    ::std::size_t claimed_shards() const {
+        return ::std::min(claimed_.load(::std::memory_order_acquire), shards_);
+    }
+
+    // Reduces `value` into this thread's shard.
+    void add(const T& value) {
+        shard& own = own_shard();
+        if (&own != overflow()) {
+            own.value.store(op_(own.value.load(::std::memory_order_relaxed), value), ::std::memory_order_relaxed);
+        } else {
+            T current = own.value.load(::std::memory_order_relaxed);
+            while (!own.value.compare_exchange_weak(current, op_(current, value), ::std::memory_order_relaxed)) { }
+        }
+    }
+
+    /**
+     * The identity reduced with every value added so far. Values being
+     * added while it runs may or may not be counted, but each value is
+     * counted whole or not at all.
+     */
+    T read() const {
+        T result = identity_;
+        const ::std::size_t claimed = ::std::min(claimed_.load(::std::memory_order_acquire), shards_);
+        for (::std::size_t i = 0; i < claimed; ++i) {
+            result = op_(result, slots_[i].value.load(::std::memory_order_relaxed));
+        }
+        return op_(result, overflow()->value.load(::std::memory_order_relaxed));
+    }
+
+  private:
+    struct shard {
+        ::std::atomic<T> value;
+        char pad[shard_cache_line - sizeof(::std::atomic<T>)];
+    };
+
+    static ::std::size_t default_shards() {
+        return 4 * ::std::max(1u, ::std::thread::hardware_concurrency());
+    }
+
+    shard* overflow() const {
+        return slots_ + shards_;
+    }
+
+    shard& own_shard() {
+        if (detail::shard_cache_entry* entry = detail::find_shard_cache_entry(id_)) {
+            return *static_cast<shard*>(entry->shard);
+        }
+        shard* own = find_or_claim_shard();
+        detail::insert_shard_cache_entry(id_, own);
+        return *own;
+    }
+
+    // The shard this thread claimed before, if it was evicted from the
+    // cache since, or else a new one. Only this thread stores its id, so
+    // it finds no other thread's shard.
+    shard* find_or_claim_shard() {
+        const ::std::uint64_t owner = detail::this_thread_shard_owner();
+        const ::std::size_t claimed = claimed_shards();
+        for (::std::size_t i = 0; i < claimed; ++i) {
+            if (owners_[i].load(::std::memory_order_relaxed) == owner) {
+                return slots_ + i;
+            }
+        }
+        const ::std::size_t i = claimed_.fetch_add(1, ::std::memory_order_acq_rel);
+        if (i >= shards_) {
+            return overflow();
+        }
+        owners_[i].store(owner, ::std::memory_order_relaxed);
+        return slots_ + i;
+    }
+
+    const ::std::uint64_t id_;
+    const ::std::size_t shards_;
+    ::std::atomic<::std::size_t> claimed_;
+    const T identity_;
+    Op op_;
+    // The thread which claimed each shard, which looks it up on a miss of
+    // its cache.
+    ::std::unique_ptr<::std::atomic<::std::uint64_t>[]> owners_;
+    ::std::unique_ptr<char[]> memory_;
+    shard* slots_;
+};
+
+} // namespace optimus
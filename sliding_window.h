@@ -0,0 +1,175 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <optimus/utility.h>
+
+namespace optimus {
+
+/**
+ * The fold with `Op` of a queue of values, e.g. with optimus::plus<T> or
+ * optimus::bit_or<T>, updated as values are pushed at the back and evicted
+ * from the front. Op must be associative but need not be commutative or
+ * have an inverse, so it can be a maximum or a concatenation.
+ *
+ * Two stacks: values are pushed onto the back, which keeps the fold of
+ * everything on it; the front holds, for each value, the fold from it to
+ * the end of the front. Evicting pops the front, and when the front is
+ * empty the back is turned over into it, folding each value once. So push
+ * and evict take one application of Op amortized, and query at most one.
+ *
+ * count_window and time_window evict by count and by age.
+ */
+template <typename T, typename Op>
+class sliding_window {
+  public:
+    using value_type = T;
+
+    explicit sliding_window(Op op = Op{}) : op_(optimus::move(op)), back_fold_() { }
+
+    ::std::size_t size() const {
+        return front_.size() + back_.size();
+    }
+
+    bool empty() const {
+        return front_.empty() && back_.empty();
+    }
+
+    void push(T value) {
+        back_fold_ = back_.empty() ? value : op_(back_fold_, value);
+        back_.push_back(optimus::move(value));
+    }
+
+    // Removes the oldest value. The window must not be empty.
+    void evict() {
+        if (front_.empty()) {
+            turn_over();
+        }
+        front_.pop_back();
+    }
+
+    // The fold of the values, oldest first. The window must not be empty.
+    T query() const {
+        if (front_.empty()) {
+            return back_fold_;
+        }
+        if (back_.empty()) {
+            return front_.back();
+        }
+        return op_(front_.back(), back_fold_);
+    }
+
+    void clear() {
+        front_.clear();
+        back_.clear();
+    }
+
+  private:
+    // Moves the back onto the front, newest at the bottom.
+    void turn_over() {
+        front_.reserve(back_.size());
+        for (::std::size_t i = back_.size(); i-- > 0;) {
+            front_.push_back(front_.empty() ? optimus::move(back_[i]) : op_(back_[i], front_.back()));
+        }
+        back_.clear();
+    }
+
+    Op op_;
+    ::std::vector<T> front_;
+    ::std::vector<T> back_;
+    T back_fold_;
+};
+
+// A sliding_window over the last `capacity` values pushed.
+template <typename T, typename Op>
+class count_window {
+  public:
+    using value_type = T;
+
+    explicit count_window(::std::size_t capacity, Op op = Op{})
+            : capacity_(capacity), window_(optimus::move(op)) { }
+
+    ::std::size_t capacity() const {
+        return capacity_;
+    }
+
+    ::std::size_t size() const {
+        return window_.size();
+    }
+
+    bool empty() const {
+        return window_.empty();
+    }
+
+    void push(T value) {
+        window_.push(optimus::move(value));
+        if (window_.size() > capacity_) {
+            window_.evict();
+        }
+    }
+
+    T query() const {
+        return window_.query();
+    }
+
+  private:
+    ::std::size_t capacity_;
+    sliding_window<T, Op> window_;
+};
+
+/**
+ * A sliding_window over the values pushed within `span` of the latest
+ * time: those with times in (now - span, now]. Times must not decrease.
+ * `Time` may be a std::chrono time point or a plain number.
+ */
+template <typename T, typename Op, typename Time = ::std::chrono::steady_clock::time_point,
+          typename Duration = decltype(::std::declval<Time>() - ::std::declval<Time>())>
+class time_window {
+  public:
+    using value_type = T;
+    using time_type = Time;
+    using duration_type = Duration;
+
+    explicit time_window(Duration span, Op op = Op{}) : span_(span), window_(optimus::move(op)) { }
+
+    Duration span() const {
+        return span_;
+    }
+
+    ::std::size_t size() const {
+        return window_.size();
+    }
+
+    bool empty() const {
+        return window_.empty();
+    }
+
+    void push(Time time, T value) {
+        advance(time);
+        times_.push_back(time);
+        window_.push(optimus::move(value));
+    }
+
+    // Evicts the values which are too old at `now`.
+    void advance(Time now) {
+        while (!times_.empty() && !(now - times_.front() < span_)) {
+            times_.pop_front();
+            window_.evict();
+        }
+    }
+
+    T query() const {
+        return window_.query();
+    }
+
+  private:
+    Duration span_;
+    ::std::deque<Time> times_;
+    sliding_window<T, Op> window_;
+};
+
+} // namespace optimus
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include <optimus/utility.h>
+
+namespace optimus {
+
+namespace detail {
+
+// What iter_move gives for an iterator whose reference is `Reference`: an
+// rvalue reference to what a reference refers to, a proxy as it is.
+template <typename Reference>
+using iter_rvalue_t = typename ::std::conditional<
+    ::std::is_reference<Reference>::value,
+    typename ::std::remove_reference<Reference>::type&&,
+    Reference
+>::type;
+
+namespace iter_move_lookup {
+
+// The element at `it` as an rvalue, unless ADL finds an iter_move for the
+// iterator, as it does for zip_iterator (see zip.h).
+template <typename Iterator>
+iter_rvalue_t<typename ::std::iterator_traits<Iterator>::reference> iter_move(const Iterator& it) {
+    return static_cast<iter_rvalue_t<typename ::std::iterator_traits<Iterator>::reference>>(*it);
+}
+
+template <typename Iterator>
+auto move_at(const Iterator& it) -> decltype(iter_move(it)) {
+    return iter_move(it);
+}
+
+} // namespace iter_move_lookup
+
+// Ranges this short are left to the insertion sort at the end.
+constexpr ::std::ptrdiff_t sort_threshold = 16;
+
+// Sorts [first, last), moving each element that is out of place aside and
+// the greater ones before it up one.
+template <typename Iterator, typename Compare>
+void insertion_sort(Iterator first, Iterator last, Compare& compare) {
+    using value_type = typename ::std::iterator_traits<Iterator>::value_type;
+    for (Iterator it = first; it != last; ++it) {
+        if (it == first || !compare(*it, *(it - 1))) {
+            continue;
+        }
+        value_type value(iter_move_lookup::move_at(it));
+        Iterator hole = it;
+        do {
+            *hole = iter_move_lookup::move_at(hole - 1);
+            --hole;
+        } while (hole != first && compare(value, *(hole - 1)));
+        *hole = optimus::move(value);
+    }
+}
+
+// Swaps the median of *a, *b and *c into *result.
+template <typename Iterator, typename Compare>
+void move_median_to_first(Iterator result, Iterator a, Iterator b, Iterator c, Compare& compare) {
+    if (compare(*a, *b)) {
+        if (compare(*b, *c)) {
+            ::std::iter_swap(result, b);
+        } else if (compare(*a, *c)) {
+            ::std::iter_swap(result, c);
+        } else {
+            ::std::iter_swap(result, a);
+        }
+    } else if (compare(*a, *c)) {
+        ::std::iter_swap(result, a);
+    } else if (compare(*b, *c)) {
+        ::std::iter_swap(result, c);
+    } else {
+        ::std::iter_swap(result, b);
+    }
+}
+
+// Partitions (first, last) around *first, the median of three elements,
+// which are also what stops the scans from running off either end.
+template <typename Iterator, typename Compare>
+Iterator partition_pivot(Iterator first, Iterator last, Compare& compare) {
+    move_median_to_first(first, first + 1, first + (last - first) / 2, last - 1, compare);
+    Iterator lo = first + 1;
+    Iterator hi = last;
+    for (;;) {
+        while (compare(*lo, *first)) {
+            ++lo;
+        }
+        --hi;
+        while (compare(*first, *hi)) {
+            --hi;
+        }
+        if (!(lo < hi)) {
+            return lo;
+        }
+        ::std::iter_swap(lo, hi);
+        ++lo;
+    }
+}
+
+template <typename Iterator, typename Compare>
+void sift_down(Iterator first, ::std::ptrdiff_t n, ::std::ptrdiff_t i, Compare& compare) {
+    for (::std::ptrdiff_t child = 2 * i + 1; child < n; i = child, child = 2 * i + 1) {
+        if (child + 1 < n && compare(*(first + child), *(first + child + 1))) {
+            ++child;
+        }
+        if (!compare(*(first + i), *(first + child))) {
+            return;
+        }
+        ::std::iter_swap(first + i, first + child);
+    }
+}
+
+// The fallback when partitions keep coming out lopsided.
+template <typename Iterator, typename Compare>
+void heap_sort(Iterator first, Iterator last, Compare& compare) {
+    const ::std::ptrdiff_t n = last - first;
+    for (::std::ptrdiff_t i = n / 2; i-- > 0;) {
+        sift_down(first, n, i, compare);
+    }
+    for (::std::ptrdiff_t end = n; end-- > 1;) {
+        ::std::iter_swap(first, first + end);
+        sift_down(first, end, 0, compare);
+    }
+}
+
+template <typename Iterator, typename Compare>
+void introsort_loop(Iterator first, Iterator last, unsigned depth, Compare& compare) {
+    while (last - first > sort_threshold) {
+        if (depth == 0) {
+            heap_sort(first, last, compare);
+            return;
+        }
+        --depth;
+        const Iterator cut = partition_pivot(first, last, compare);
+        introsort_loop(cut, last, depth, compare);
+        last = cut;
+    }
+}
+
+struct less_than {
+    template <typename T, typename U>
+    bool operator()(const T& lhs, const U& rhs) const {
+        return lhs < rhs;
+    }
+};
+
+} // namespace detail
+
+/**
+ * Sorts [first, last) by `compare`, as std::sort does, but sets elements
+ * aside and puts them back with iter_move, and otherwise swaps them. For
+ * a zip that moves each element of a row rather than copying it, so
+ * sorting parallel arrays makes no copies of their elements, e.g.
+ * optimus::sort(rows.begin(), rows.end(), get<0>::apply<less<A>>{}).
+ * Not stable.
+ */
+template <typename Iterator, typename Compare>
+void sort(Iterator first, Iterator last, Compare compare) {
+    const ::std::ptrdiff_t n = last - first;
+    unsigned depth = 0;
+    for (::std::ptrdiff_t m = n; m > 1; m /= 2) {
+        depth += 2;
+    }
+    detail::introsort_loop(first, last, depth, compare);
+    detail::insertion_sort(first, last, compare);
+}
+
+// Sorts [first, last) by `<`.
+template <typename Iterator>
+void sort(Iterator first, Iterator last) {
+    optimus::sort(first, last, detail::less_than{});
+}
+
+} // namespace optimus
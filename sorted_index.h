@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Bytes per cache line, which the Eytzinger search prefetches ahead by.
+constexpr ::std::size_t index_cache_line = 64;
+
+namespace detail {
+
+// Prefetches the line at `address` for reading. `address` may be past the
+// end of the array it points into, so it is computed as an integer.
+inline void prefetch(::std::uintptr_t address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(reinterpret_cast<const void*>(address));
+#else
+    (void)address;
+#endif
+}
+
+} // namespace detail
+
+/**
+ * A read-only index over the rows of [first, last) by the key `KeyFn`
+ * projects out of them, e.g. optimus::get<0> or optimus::compose<...>,
+ * for point and range lookups. Made by index_by. The rows are not copied,
+ * so they must outlive the index.
+ *
+ * The keys are stored in Eytzinger order, the breadth-first order of a
+ * complete binary search tree: node i has children 2i and 2i + 1, so the
+ * first levels of every search share the same few cache lines, and the
+ * descendants several levels down are contiguous and are prefetched while
+ * the current level is compared. The descent has no data-dependent branch.
+ * On indexes much larger than the cache this is two to three times faster
+ * than std::lower_bound over the sorted keys, whose every probe in the
+ * last levels is a cache miss.
+ *
+ * Keys are ordered by operator<. Lookups return iterators over the rows in
+ * key order, rows with equal keys in their original order, dereferencing to
+ * the rows themselves.
+ */
+template <typename Iterator, typename KeyFn>
+class sorted_index {
+  public:
+    using reference = typename ::std::iterator_traits<Iterator>::reference;
+    using key_type = typename ::std::decay<result_of_t<const KeyFn(reference)>>::type;
+
+    class iterator {
+      public:
+        using iterator_category = ::std::random_access_iterator_tag;
+        using value_type = typename ::std::iterator_traits<Iterator>::value_type;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = typename ::std::iterator_traits<Iterator>::pointer;
+        using reference = typename ::std::iterator_traits<Iterator>::reference;
+
+        iterator() = default;
+
+        reference operator*() const {
+            return **row_;
+        }
+
+        pointer operator->() const {
+            return &**row_;
+        }
+
+        reference operator[](difference_type n) const {
+            return *row_[n];
+        }
+
+        iterator& operator++() {
+            ++row_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++row_;
+            return old;
+        }
+
+        iterator& operator--() {
+            --row_;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator old = *this;
+            --row_;
+            return old;
+        }
+
+        iterator& operator+=(difference_type n) {
+            row_ += n;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type n) {
+            row_ -= n;
+            return *this;
+        }
+
+        friend iterator operator+(iterator it, difference_type n) {
+            return it += n;
+        }
+
+        friend iterator operator+(difference_type n, iterator it) {
+            return it += n;
+        }
+
+        friend iterator operator-(iterator it, difference_type n) {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const iterator& a, const iterator& b) {
+            return a.row_ - b.row_;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) {
+            return a.row_ == b.row_;
+        }
+
+        friend bool operator!=(const iterator& a, const iterator& b) {
+            return a.row_ != b.row_;
+        }
+
+        friend bool operator<(const iterator& a, const iterator& b) {
+            return a.row_ < b.row_;
+        }
+
+        friend bool operator>(const iterator& a, const iterator& b) {
+            return a.row_ > b.row_;
+        }
+
+        friend bool operator<=(const iterator& a, const iterator& b) {
+            return a.row_ <= b.row_;
+        }
+
+        friend bool operator>=(const iterator& a, const iterator& b) {
+            return a.row_ >= b.row_;
+        }
+
+      private:
+        friend class sorted_index;
+
+        explicit iterator(const Iterator* row) : row_(row) { }
+
+        const Iterator* row_ = nullptr;
+    };
+
+    using const_iterator = iterator;
+
+    sorted_index(Iterator first, Iterator last, KeyFn key = KeyFn{}) : key_(optimus::move(key)) {
+        ::std::vector<::std::pair<key_type, Iterator>> sorted;
+        for (; first != last; ++first) {
+            sorted.emplace_back(key_(*first), first);
+        }
+        ::std::stable_sort(sorted.begin(), sorted.end(),
+                           [](const ::std::pair<key_type, Iterator>& a, const ::std::pair<key_type, Iterator>& b) {
+                               return a.first < b.first;
+                           });
+
+        const ::std::size_t n = sorted.size();
+        rows_.reserve(n);
+        for (const auto& entry : sorted) {
+            rows_.push_back(entry.second);
+        }
+
+        // The tree is padded out to a perfect one with copies of the largest
+        // key, so that every search takes the same number of steps and ends
+        // at the rank it found. Slot 0 of keys_ is unused.
+        levels_ = 0;
+        while ((::std::size_t(1) << levels_) - 1 < n) {
+            ++levels_;
+        }
+        if (n != 0) {
+            keys_.assign(::std::size_t(1) << levels_, sorted.back().first);
+            ::std::size_t rank = 0;
+            fill(sorted, rank, 1);
+        }
+    }
+
+    ::std::size_t size() const {
+        return rows_.size();
+    }
+
+    bool empty() const {
+        return rows_.empty();
+    }
+
+    // All rows, in key order.
+    iterator begin() const {
+        return iterator{rows_.data()};
+    }
+
+    iterator end() const {
+        return iterator{rows_.data() + rows_.size()};
+    }
+
+    // The first row whose key is not less than `key`.
+    iterator lower_bound(const key_type& key) const {
+        return begin() + ::std::ptrdiff_t(search(key, [](const key_type& node, const key_type& key) {
+            return node < key;
+        }));
+    }
+
+    // The first row whose key is greater than `key`.
+    iterator upper_bound(const key_type& key) const {
+        return begin() + ::std::ptrdiff_t(search(key, [](const key_type& node, const key_type& key) {
+            return !(key < node);
+        }));
+    }
+
+    ::std::pair<iterator, iterator> equal_range(const key_type& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // The first row whose key is `key`, or end().
+    iterator find(const key_type& key) const {
+        const iterator it = lower_bound(key);
+        return it != end() && !(key < key_(*it)) ? it : end();
+    }
+
+    ::std::size_t count(const key_type& key) const {
+        const auto range = equal_range(key);
+        return ::std::size_t(range.second - range.first);
+    }
+
+  private:
+    // Keys to a cache line. The descendants of node i log2(prefetch_nodes)
+    // levels down start at node prefetch_nodes * i and are contiguous.
+    static constexpr ::std::size_t prefetch_nodes =
+            index_cache_line / sizeof(key_type) == 0 ? 1 : index_cache_line / sizeof(key_type);
+
+    // In-order traversal of the implicit tree, handing out sorted keys.
+    void fill(const ::std::vector<::std::pair<key_type, Iterator>>& sorted, ::std::size_t& rank,
+              ::std::size_t node) {
+        if (node < keys_.size()) {
+            fill(sorted, rank, 2 * node);
+            if (rank < sorted.size()) {
+                keys_[node] = sorted[rank++].first;
+            }
+            fill(sorted, rank, 2 * node + 1);
+        }
+    }
+
+    // The rank of the first key for which `goes_right` is false. The bits
+    // of i below its leading one are the path taken, right being 1, which
+    // in a perfect tree is the number of keys passed.
+    template <typename GoesRight>
+    ::std::size_t search(const key_type& key, GoesRight goes_right) const {
+        const key_type* keys = keys_.data();
+        ::std::size_t i = 1;
+        for (unsigned level = 0; level < levels_; ++level) {
+            detail::prefetch(::std::uintptr_t(keys) + prefetch_nodes * i * sizeof(key_type));
+            i = 2 * i + ::std::size_t(goes_right(keys[i], key));
+        }
+        return ::std::min(i - (::std::size_t(1) << levels_), rows_.size());
+    }
+
+    KeyFn key_;
+    unsigned levels_;
+    ::std::vector<key_type> keys_;
+    ::std::vector<Iterator> rows_;
+};
+
+template <typename Iterator, typename KeyFn>
+constexpr ::std::size_t sorted_index<Iterator, KeyFn>::prefetch_nodes;
+
+/**
+ * Indexes the rows of [first, last) by `KeyFn`, for lookups:
+ *
+ *   auto index = optimus::index_by<optimus::get<0>>(rows);
+ *   auto matches = index.equal_range(42);
+ *   for (auto it = matches.first; it != matches.second; ++it) ...
+ *
+ * Sorting costs O(n log n) once; every lookup after is O(log n) with about
+ * one cache miss per cache line of keys rather than one per level.
+ */
+template <typename KeyFn, typename Iterator>
+sorted_index<Iterator, KeyFn> index_by(Iterator first, Iterator last, KeyFn key = KeyFn{}) {
+    return sorted_index<Iterator, KeyFn>{first, last, optimus::move(key)};
+}
+
+template <typename KeyFn, typename Range>
+auto index_by(const Range& range, KeyFn key = KeyFn{})
+        -> sorted_index<decltype(::std::begin(range)), KeyFn> {
+    return sorted_index<decltype(::std::begin(range)), KeyFn>{
+        ::std::begin(range), ::std::end(range), optimus::move(key)};
+}
+
+} // namespace optimus
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Seeds tried for each hash of a static_keys before giving up, which
+// happens only for duplicate keys.
+constexpr ::std::size_t static_key_seed_limit = 1 << 12;
+
+namespace detail {
+
+constexpr ::std::uint64_t static_key_fnv_basis = 0xcbf29ce484222325ull;
+constexpr ::std::uint64_t static_key_fnv_prime = 0x100000001b3ull;
+
+constexpr ::std::uint64_t static_key_shift_xor(::std::uint64_t h) {
+    return h ^ (h >> 33);
+}
+
+// The finalizer of MurmurHash3, so that every bit of the hash depends on
+// every bit of the key.
+constexpr ::std::uint64_t static_key_mix(::std::uint64_t h) {
+    return static_key_shift_xor(
+        static_key_shift_xor(static_key_shift_xor(h) * 0xff51afd7ed558ccdull) * 0xc4ceb9fe1a85ec53ull);
+}
+
+constexpr ::std::uint64_t static_key_fnv(const char* key, ::std::size_t size, ::std::uint64_t h) {
+    return size == 0 ? h : static_key_fnv(key + 1, size - 1,
+                                          (h ^ static_cast<unsigned char>(*key)) * static_key_fnv_prime);
+}
+
+// FNV-1a, mixed. This recurses once per character; static_key_hash_loop
+// is the same hash for run time.
+constexpr ::std::uint64_t static_key_hash(const char* key, ::std::size_t size) {
+    return static_key_mix(static_key_fnv(key, size, static_key_fnv_basis));
+}
+
+inline ::std::uint64_t static_key_hash_loop(const char* key, ::std::size_t size) {
+    ::std::uint64_t h = static_key_fnv_basis;
+    for (::std::size_t i = 0; i < size; ++i) {
+        h = (h ^ static_cast<unsigned char>(key[i])) * static_key_fnv_prime;
+    }
+    return static_key_mix(h);
+}
+
+constexpr ::std::uint64_t static_key_multiplier(::std::size_t seed) {
+    return static_key_mix(seed * 0x9e3779b97f4a7c15ull) | 1;
+}
+
+// Maps `hash` to [0, n) by the high bits of its product with `multiplier`.
+constexpr ::std::size_t static_key_reduce(::std::uint64_t hash, ::std::uint64_t multiplier, ::std::size_t n) {
+    return ::std::size_t((((hash * multiplier) >> 32) * n) >> 32);
+}
+
+constexpr bool static_key_equal(const char* lhs, const char* rhs, ::std::size_t size) {
+    return size == 0 || (*lhs == *rhs && static_key_equal(lhs + 1, rhs + 1, size - 1));
+}
+
+// fn(first) + ... + fn(last - 1), split in halves so that the recursion
+// is only logarithmically deep.
+template <typename Fn>
+constexpr ::std::size_t static_sum(const Fn& fn, ::std::size_t first, ::std::size_t last) {
+    return last - first == 0 ? 0
+         : last - first == 1 ? fn(first)
+         : static_sum(fn, first, first + (last - first) / 2) + static_sum(fn, first + (last - first) / 2, last);
+}
+
+template <typename Fn>
+constexpr ::std::size_t static_find(const Fn& fn, ::std::size_t first, ::std::size_t last);
+
+template <typename Fn>
+constexpr ::std::size_t static_find_after(const Fn& fn, ::std::size_t found, ::std::size_t middle, ::std::size_t last) {
+    return found != middle ? found : static_find(fn, middle, last);
+}
+
+// The first i in [first, last) with fn(i), or `last`.
+template <typename Fn>
+constexpr ::std::size_t static_find(const Fn& fn, ::std::size_t first, ::std::size_t last) {
+    return last - first == 0 ? last
+         : last - first == 1 ? (fn(first) ? first : last)
+         : static_find_after(fn, static_find(fn, first, first + (last - first) / 2),
+                             first + (last - first) / 2, last);
+}
+
+// The first i in [first, last) with fn(i), where fn is false and then true.
+template <typename Fn>
+constexpr ::std::size_t static_partition_point(const Fn& fn, ::std::size_t first, ::std::size_t last) {
+    return first == last ? first
+         : fn(first + (last - first) / 2) ? static_partition_point(fn, first, first + (last - first) / 2)
+         : static_partition_point(fn, first + (last - first) / 2 + 1, last);
+}
+
+template <::std::size_t N>
+struct static_key_list {
+    const char* data[N];
+    ::std::size_t size[N];
+    ::std::uint64_t hash[N];
+};
+
+/**
+ * Building a static_keys, in stages since a C++11 constexpr function can
+ * only compute one value: the keys go into buckets by a first hash, and
+ * each bucket of n keys gets its own n * n slots and a second hash which
+ * puts its keys in different ones. The first hash is retried until there
+ * are at most 4 slots per key in all, which half of all hashes manage.
+ */
+template <::std::size_t N>
+struct static_key_bucket_index {
+    ::std::size_t bucket[N];
+};
+
+template <::std::size_t N, ::std::size_t... Indices>
+constexpr static_key_bucket_index<N> make_static_key_bucket_index(const static_key_list<N>& keys,
+                                                                  ::std::uint64_t multiplier,
+                                                                  optimus::index_sequence<Indices...>) {
+    return static_key_bucket_index<N>{{static_key_reduce(keys.hash[Indices], multiplier, N)...}};
+}
+
+template <::std::size_t N>
+struct static_key_same_bucket {
+    const static_key_bucket_index<N>& index;
+    ::std::size_t i;
+
+    constexpr ::std::size_t operator()(::std::size_t j) const {
+        return index.bucket[i] == index.bucket[j] ? 1 : 0;
+    }
+};
+
+template <::std::size_t N>
+struct static_key_load {
+    const static_key_bucket_index<N>& index;
+
+    constexpr ::std::size_t operator()(::std::size_t i) const {
+        return static_sum(static_key_same_bucket<N>{index, i}, 0, N);
+    }
+};
+
+// The sum of the squares of the bucket sizes, counted as pairs of keys
+// in the same bucket, is the number of slots.
+template <::std::size_t N>
+constexpr bool static_key_fits(const static_key_bucket_index<N>& index) {
+    return static_sum(static_key_load<N>{index}, 0, N) <= 4 * N;
+}
+
+template <::std::size_t N>
+struct static_key_first_fits {
+    const static_key_list<N>& keys;
+
+    constexpr bool operator()(::std::size_t seed) const {
+        return static_key_fits(
+            make_static_key_bucket_index(keys, static_key_multiplier(seed), optimus::make_index_sequence<N>{}));
+    }
+};
+
+constexpr ::std::size_t static_key_checked_seed(::std::size_t seed) {
+    return seed < static_key_seed_limit ? seed : throw ::std::logic_error("optimus::static_keys: duplicate keys");
+}
+
+template <::std::size_t N>
+constexpr ::std::uint64_t static_key_first_multiplier(const static_key_list<N>& keys) {
+    return static_key_multiplier(
+        static_key_checked_seed(static_find(static_key_first_fits<N>{keys}, 1, static_key_seed_limit)));
+}
+
+// Key j comes before key i when sorted by bucket, then by index.
+template <::std::size_t N>
+struct static_key_precedes {
+    const static_key_bucket_index<N>& index;
+    ::std::size_t i;
+
+    constexpr ::std::size_t operator()(::std::size_t j) const {
+        return index.bucket[j] < index.bucket[i] || (index.bucket[j] == index.bucket[i] && j < i) ? 1 : 0;
+    }
+};
+
+template <::std::size_t N>
+struct static_key_positions {
+    ::std::size_t position[N];
+};
+
+template <::std::size_t N, ::std::size_t... Indices>
+constexpr static_key_positions<N> make_static_key_positions(const static_key_bucket_index<N>& index,
+                                                            optimus::index_sequence<Indices...>) {
+    return static_key_positions<N>{{static_sum(static_key_precedes<N>{index, Indices}, 0, N)...}};
+}
+
+template <::std::size_t N>
+struct static_key_at_position {
+    const static_key_positions<N>& positions;
+    ::std::size_t p;
+
+    constexpr bool operator()(::std::size_t i) const {
+        return positions.position[i] == p;
+    }
+};
+
+template <::std::size_t N>
+struct static_key_below {
+    const static_key_bucket_index<N>& index;
+    ::std::size_t b;
+
+    constexpr ::std::size_t operator()(::std::size_t i) const {
+        return index.bucket[i] < b ? 1 : 0;
+    }
+};
+
+// The keys sorted by bucket, and where each bucket starts among them.
+template <::std::size_t N>
+struct static_key_buckets {
+    ::std::size_t order[N];
+    ::std::size_t first[N + 1];
+};
+
+template <::std::size_t N, ::std::size_t... Indices, ::std::size_t... Buckets>
+constexpr static_key_buckets<N> make_static_key_buckets(const static_key_bucket_index<N>& index,
+                                                        const static_key_positions<N>& positions,
+                                                        optimus::index_sequence<Indices...>,
+                                                        optimus::index_sequence<Buckets...>) {
+    return static_key_buckets<N>{
+        {static_find(static_key_at_position<N>{positions, Indices}, 0, N)...},
+        {static_sum(static_key_below<N>{index, Buckets}, 0, N)...}};
+}
+
+template <::std::size_t N>
+struct static_key_bucket_slots {
+    const static_key_buckets<N>& buckets;
+
+    constexpr ::std::size_t operator()(::std::size_t b) const {
+        return (buckets.first[b + 1] - buckets.first[b]) * (buckets.first[b + 1] - buckets.first[b]);
+    }
+};
+
+// Whether the keys at positions p and q collide in bucket b's slots.
+template <::std::size_t N>
+struct static_key_collides_with {
+    const static_key_list<N>& keys;
+    const static_key_buckets<N>& buckets;
+    ::std::uint64_t multiplier;
+    ::std::size_t slots;
+    ::std::size_t p;
+
+    constexpr ::std::size_t operator()(::std::size_t q) const {
+        return static_key_reduce(keys.hash[buckets.order[p]], multiplier, slots) ==
+               static_key_reduce(keys.hash[buckets.order[q]], multiplier, slots) ? 1 : 0;
+    }
+};
+
+template <::std::size_t N>
+struct static_key_collisions {
+    const static_key_list<N>& keys;
+    const static_key_buckets<N>& buckets;
+    ::std::uint64_t multiplier;
+    ::std::size_t slots;
+    ::std::size_t first;
+
+    constexpr ::std::size_t operator()(::std::size_t p) const {
+        return static_sum(static_key_collides_with<N>{keys, buckets, multiplier, slots, p}, first, p);
+    }
+};
+
+template <::std::size_t N>
+struct static_key_bucket_fits {
+    const static_key_list<N>& keys;
+    const static_key_buckets<N>& buckets;
+    ::std::size_t b;
+
+    constexpr bool operator()(::std::size_t seed) const {
+        return static_sum(static_key_collisions<N>{keys, buckets, static_key_multiplier(seed),
+                                                   static_key_bucket_slots<N>{buckets}(b), buckets.first[b]},
+                          buckets.first[b], buckets.first[b + 1]) == 0;
+    }
+};
+
+// Where each bucket's slots start, and its second hash.
+template <::std::size_t N>
+struct static_key_tables {
+    ::std::uint32_t offset[N + 1];
+    ::std::uint64_t multiplier[N];
+};
+
+template <::std::size_t N, ::std::size_t... Indices, ::std::size_t... Buckets>
+constexpr static_key_tables<N> make_static_key_tables(const static_key_list<N>& keys,
+                                                      const static_key_buckets<N>& buckets,
+                                                      optimus::index_sequence<Indices...>,
+                                                      optimus::index_sequence<Buckets...>) {
+    return static_key_tables<N>{
+        {::std::uint32_t(static_sum(static_key_bucket_slots<N>{buckets}, 0, Buckets))...},
+        {static_key_multiplier(static_key_checked_seed(
+            static_find(static_key_bucket_fits<N>{keys, buckets, Indices}, 1, static_key_seed_limit)))...}};
+}
+
+template <::std::size_t N>
+struct static_key_ends_after {
+    const static_key_tables<N>& tables;
+    ::std::size_t slot;
+
+    constexpr bool operator()(::std::size_t b) const {
+        return tables.offset[b + 1] > slot;
+    }
+};
+
+template <::std::size_t N>
+struct static_key_lands_on {
+    const static_key_list<N>& keys;
+    const static_key_buckets<N>& buckets;
+    const static_key_tables<N>& tables;
+    ::std::size_t b;
+    ::std::size_t slot;
+
+    constexpr bool operator()(::std::size_t p) const {
+        return tables.offset[b] + static_key_reduce(keys.hash[buckets.order[p]], tables.multiplier[b],
+                                                    tables.offset[b + 1] - tables.offset[b]) == slot;
+    }
+};
+
+// The key in `slot` of bucket `b`, or 0 if it is empty: a lookup which
+// lands there compares against key 0 and finds it is not that.
+template <::std::size_t N>
+constexpr ::std::uint32_t static_key_in_bucket(const static_key_buckets<N>& buckets, ::std::size_t b, ::std::size_t p) {
+    return p == buckets.first[b + 1] ? 0 : ::std::uint32_t(buckets.order[p]);
+}
+
+template <::std::size_t N>
+constexpr ::std::uint32_t static_key_in_slot(const static_key_list<N>& keys, const static_key_buckets<N>& buckets,
+                                             const static_key_tables<N>& tables, ::std::size_t b,
+                                             ::std::size_t slot) {
+    return b == N ? 0 : static_key_in_bucket(buckets, b,
+                                             static_find(static_key_lands_on<N>{keys, buckets, tables, b, slot},
+                                                         buckets.first[b], buckets.first[b + 1]));
+}
+
+} // namespace detail
+
+/**
+ * A fixed set of string keys with a perfect hash computed at compile
+ * time, made by make_static_keys. find(key) hashes the key, reads two
+ * small tables and compares against the one key which can match, without
+ * probing or branching on collisions; index_of(key) with a string literal
+ * is a constant expression, so a slot can be resolved at compile time.
+ *
+ * The hash takes two levels: a first hash splits the keys into N buckets,
+ * and a second hash, one per bucket, places the n keys of a bucket in n * n
+ * slots without collisions. There are at most 4 * N slots in all.
+ *
+ * Building one is quadratic in the number of keys: keys of more than a
+ * few hundred characters exceed the default depth of constexpr recursion,
+ * and sets of more than about 200 keys its default number of operations.
+ * Duplicate keys fail to compile.
+ */
+template <::std::size_t N>
+class static_keys {
+    static_assert(N > 0, "static_keys requires at least one key");
+
+  public:
+    static constexpr ::std::size_t slots = 4 * N + 1;
+
+    constexpr explicit static_keys(const detail::static_key_list<N>& keys)
+            : static_keys(keys, detail::static_key_first_multiplier(keys)) { }
+
+    constexpr ::std::size_t size() const {
+        return N;
+    }
+
+    constexpr const char* key(::std::size_t i) const {
+        return data_[i];
+    }
+
+    constexpr ::std::size_t key_size(::std::size_t i) const {
+        return size_[i];
+    }
+
+    // The index of `key`, which must be one of the keys: in a constant
+    // expression anything else fails to compile.
+    template <::std::size_t M>
+    constexpr ::std::size_t index_of(const char (&key)[M]) const {
+        return checked_index(detail::static_find(key_equals{data_, size_, key, M - 1}, 0, N));
+    }
+
+    // The index of `key`, or size() if it is not one of the keys.
+    ::std::size_t find(const char* key, ::std::size_t size) const {
+        const ::std::uint64_t hash = detail::static_key_hash_loop(key, size);
+        const ::std::size_t bucket = detail::static_key_reduce(hash, multiplier_, N);
+        const ::std::uint32_t offset = offset_[bucket];
+        const ::std::uint32_t i =
+            slot_[offset + detail::static_key_reduce(hash, bucket_multiplier_[bucket], offset_[bucket + 1] - offset)];
+        return hash_[i] == hash && size_[i] == size && ::std::memcmp(data_[i], key, size) == 0 ? i : N;
+    }
+
+    ::std::size_t find(const ::std::string& key) const {
+        return find(key.data(), key.size());
+    }
+
+    template <::std::size_t M>
+    ::std::size_t find(const char (&key)[M]) const {
+        return find(key, M - 1);
+    }
+
+  private:
+    struct key_equals {
+        const char* const* data;
+        const ::std::size_t* size;
+        const char* key;
+        ::std::size_t key_size;
+
+        constexpr bool operator()(::std::size_t i) const {
+            return size[i] == key_size && detail::static_key_equal(data[i], key, key_size);
+        }
+    };
+
+    static constexpr ::std::size_t checked_index(::std::size_t i) {
+        return i < N ? i : throw ::std::out_of_range("optimus::static_keys: not one of the keys");
+    }
+
+    constexpr static_keys(const detail::static_key_list<N>& keys, ::std::uint64_t multiplier)
+            : static_keys(keys, multiplier,
+                          detail::make_static_key_bucket_index(keys, multiplier, optimus::make_index_sequence<N>{})) { }
+
+    constexpr static_keys(const detail::static_key_list<N>& keys, ::std::uint64_t multiplier,
+                          const detail::static_key_bucket_index<N>& index)
+            : static_keys(keys, multiplier,
+                          detail::make_static_key_buckets(
+                              index, detail::make_static_key_positions(index, optimus::make_index_sequence<N>{}),
+                              optimus::make_index_sequence<N>{}, optimus::make_index_sequence<N + 1>{})) { }
+
+    constexpr static_keys(const detail::static_key_list<N>& keys, ::std::uint64_t multiplier,
+                          const detail::static_key_buckets<N>& buckets)
+            : static_keys(keys, multiplier, buckets,
+                          detail::make_static_key_tables(keys, buckets, optimus::make_index_sequence<N>{},
+                                                         optimus::make_index_sequence<N + 1>{}),
+                          optimus::make_index_sequence<N>{}, optimus::make_index_sequence<N + 1>{},
+                          optimus::make_index_sequence<slots>{}) { }
+
+    template <::std::size_t... Indices, ::std::size_t... Buckets, ::std::size_t... Slots>
+    constexpr static_keys(const detail::static_key_list<N>& keys, ::std::uint64_t multiplier,
+                          const detail::static_key_buckets<N>& buckets, const detail::static_key_tables<N>& tables,
+                          optimus::index_sequence<Indices...>, optimus::index_sequence<Buckets...>,
+                          optimus::index_sequence<Slots...>)
+            : data_{keys.data[Indices]...},
+              size_{keys.size[Indices]...},
+              hash_{keys.hash[Indices]...},
+              multiplier_(multiplier),
+              offset_{tables.offset[Buckets]...},
+              bucket_multiplier_{tables.multiplier[Indices]...},
+              slot_{detail::static_key_in_slot(
+                  keys, buckets, tables,
+                  detail::static_partition_point(detail::static_key_ends_after<N>{tables, Slots}, 0, N), Slots)...} { }
+
+    const char* data_[N];
+    ::std::size_t size_[N];
+    ::std::uint64_t hash_[N];
+    ::std::uint64_t multiplier_;
+    ::std::uint32_t offset_[N + 1];
+    ::std::uint64_t bucket_multiplier_[N];
+    ::std::uint32_t slot_[slots];
+};
+
+template <::std::size_t N>
+constexpr ::std::size_t static_keys<N>::slots;
+
+// The static_keys of string literals, e.g.
+// `constexpr auto fields = make_static_keys("id", "price", "quantity");`.
+template <::std::size_t... Sizes>
+constexpr static_keys<sizeof...(Sizes)> make_static_keys(const char (&... keys)[Sizes]) {
+    return static_keys<sizeof...(Sizes)>(detail::static_key_list<sizeof...(Sizes)>{
+        {keys...}, {(Sizes - 1)...}, {detail::static_key_hash(keys, Sizes - 1)...}});
+}
+
+/**
+ * A value for each of a static_keys, which it refers to and must outlive.
+ * at(key) with a string finds the slot with the perfect hash, so
+ * optimus::at<std::string> projects out of a static_map without probing;
+ * at(i) with an index takes the slot directly, so
+ * `at_index<fields.index_of("price")>` resolves it at compile time.
+ */
+template <typename Value, ::std::size_t N>
+class static_map {
+  public:
+    using key_set = static_keys<N>;
+    using mapped_type = Value;
+
+    constexpr explicit static_map(const static_keys<N>& keys) : keys_(&keys), values_() { }
+
+    template <typename... Values, typename = typename ::std::enable_if<sizeof...(Values) == N>::type>
+    constexpr static_map(const static_keys<N>& keys, Values&&... values)
+            : keys_(&keys), values_{optimus::forward<Values>(values)...} { }
+
+    constexpr const static_keys<N>& keys() const {
+        return *keys_;
+    }
+
+    constexpr ::std::size_t size() const {
+        return N;
+    }
+
+    Value& at(::std::size_t i) {
+        return values_[i];
+    }
+
+    constexpr const Value& at(::std::size_t i) const {
+        return values_[i];
+    }
+
+    Value& operator[](::std::size_t i) {
+        return values_[i];
+    }
+
+    constexpr const Value& operator[](::std::size_t i) const {
+        return values_[i];
+    }
+
+    // The value of `key`. Throws std::out_of_range if it is not one of the
+    // keys.
+    Value& at(const ::std::string& key) {
+        return values_[checked_find(key)];
+    }
+
+    const Value& at(const ::std::string& key) const {
+        return values_[checked_find(key)];
+    }
+
+    template <::std::size_t M>
+    Value& at(const char (&key)[M]) {
+        return values_[checked_find(key)];
+    }
+
+    template <::std::size_t M>
+    const Value& at(const char (&key)[M]) const {
+        return values_[checked_find(key)];
+    }
+
+    // The value of `key`, or nullptr if it is not one of the keys.
+    Value* find(const ::std::string& key) {
+        const ::std::size_t i = keys_->find(key);
+        return i < N ? values_ + i : nullptr;
+    }
+
+    const Value* find(const ::std::string& key) const {
+        const ::std::size_t i = keys_->find(key);
+        return i < N ? values_ + i : nullptr;
+    }
+
+    ::std::size_t count(const ::std::string& key) const {
+        return keys_->find(key) < N ? 1 : 0;
+    }
+
+  private:
+    template <typename Key>
+    ::std::size_t checked_find(const Key& key) const {
+        const ::std::size_t i = keys_->find(key);
+        if (i == N) {
+            throw ::std::out_of_range("optimus::static_map: not one of the keys");
+        }
+        return i;
+    }
+
+    const static_keys<N>* keys_;
+    Value values_[N];
+};
+
+} // namespace optimus
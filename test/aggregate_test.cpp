@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/aggregate.h>
+#include <optimus/functional.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+using row = std::tuple<std::uint32_t, std::string, std::int64_t>;
+
+std::vector<row> make_rows(std::size_t n, std::uint32_t groups) {
+    std::mt19937 gen{7};
+    std::vector<row> rows;
+    rows.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint32_t key = gen() % groups;
+        rows.emplace_back(key, "k" + std::to_string(key % 10), std::int64_t(gen() % 1000) - 500);
+    }
+    return rows;
+}
+
+std::map<std::uint32_t, std::int64_t> expected_sums(const std::vector<row>& rows) {
+    std::map<std::uint32_t, std::int64_t> sums;
+    for (const row& r : rows) {
+        sums[std::get<0>(r)] += std::get<2>(r);
+    }
+    return sums;
+}
+
+} // namespace
+
+TEST(group_by, sum) {
+    const auto rows = make_rows(10000, 100);
+    const auto sums = optimus::group_by<optimus::get<0>>(rows)
+        .aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{});
+    const auto expected = expected_sums(rows);
+    ASSERT_EQ(expected.size(), sums.size());
+    for (const auto& entry : expected) {
+        EXPECT_EQ(entry.second, sums.find(entry.first)->second);
+    }
+}
+
+TEST(group_by, count_and_max) {
+    const std::vector<row> rows{
+        row{1, "a", 5}, row{2, "b", 3}, row{1, "a", 9}, row{3, "a", -1}, row{2, "b", 4}};
+    const auto counts = optimus::group_by<optimus::get<1>>(rows.begin(), rows.end())
+        .aggregate(optimus::constant<std::integral_constant<int, 1>>{}, optimus::plus<int>{});
+    EXPECT_EQ(2u, counts.size());
+    EXPECT_EQ(3, counts.find("a")->second);
+    EXPECT_EQ(2, counts.find("b")->second);
+
+    const auto maxima = optimus::group_by(rows, optimus::get<0>{})
+        .aggregate(optimus::get<2>{}, [](std::int64_t a, std::int64_t b) { return a < b ? b : a; });
+    EXPECT_EQ(9, maxima.find(1)->second);
+    EXPECT_EQ(4, maxima.find(2)->second);
+    EXPECT_EQ(-1, maxima.find(3)->second);
+}
+
+TEST(group_by, key_types) {
+    const std::vector<row> rows = make_rows(10, 4);
+    using grouping = decltype(optimus::group_by<optimus::get<1>>(rows));
+    EXPECT_TRUE((std::is_same<std::string, grouping::key_type>::value));
+    EXPECT_TRUE((std::is_same<std::int64_t, grouping::value_type<optimus::get<2>>>::value));
+}
+
+TEST(group_by, presized) {
+    const auto rows = make_rows(100000, 1000);
+    const auto estimated = optimus::group_by<optimus::get<0>>(rows)
+        .aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{});
+    // The estimate is close enough that the table never grows past the
+    // capacity it would need anyway.
+    optimus::flat_hash_map<std::uint32_t, std::int64_t> exact{1000};
+    EXPECT_EQ(1000u, estimated.size());
+    EXPECT_LE(estimated.capacity(), 2 * exact.capacity());
+
+    const auto given = optimus::group_by<optimus::get<0>>(rows).expect_groups(1000)
+        .aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{});
+    EXPECT_EQ(exact.capacity(), given.capacity());
+}
+
+TEST(estimate_groups, accuracy) {
+    for (std::uint32_t groups : {10u, 1000u, 100000u}) {
+        std::vector<std::uint32_t> keys(200000);
+        std::mt19937 gen{groups};
+        for (auto& key : keys) {
+            key = gen() % groups;
+        }
+        const std::size_t estimate = optimus::detail::estimate_groups(
+            keys.begin(), keys.size(), optimus::id{}, std::hash<std::uint32_t>{});
+        EXPECT_GE(estimate, groups / 3) << groups;
+        EXPECT_LE(estimate, groups * 3) << groups;
+    }
+}
+
+TEST(group_by, parallel) {
+    for (std::uint32_t groups : {1u, 37u, 5000u, 200000u}) {
+        const auto rows = make_rows(300000, groups);
+        const auto sums = optimus::group_by<optimus::get<0>>(rows)
+            .parallel_aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{}, 4);
+        const auto expected = expected_sums(rows);
+        ASSERT_EQ(expected.size(), sums.size()) << groups;
+        for (const auto& entry : expected) {
+            EXPECT_EQ(entry.second, sums.find(entry.first)->second);
+        }
+    }
+}
+
+// Throws from the key projection on one row, read by a worker thread.
+struct throwing_key {
+    std::uint32_t operator()(const row& r) const {
+        if (std::get<2>(r) == 1000) {
+            throw std::runtime_error("key");
+        }
+        return std::get<0>(r);
+    }
+};
+
+TEST(group_by, parallel_rethrows) {
+    auto rows = make_rows(300000, 37);
+    std::get<2>(rows[rows.size() - 1]) = 1000;
+    EXPECT_THROW((optimus::group_by<throwing_key>(rows)
+                      .parallel_aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{}, 4)),
+                 std::runtime_error);
+}
+
+TEST(group_by, parallel_small_input) {
+    const auto rows = make_rows(100, 10);
+    const auto sums = optimus::group_by<optimus::get<0>>(rows)
+        .parallel_aggregate(optimus::get<2>{}, optimus::plus<std::int64_t>{}, 8);
+    EXPECT_EQ(expected_sums(rows).size(), sums.size());
+}
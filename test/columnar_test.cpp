@@ -0,0 +1,232 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/columnar.h>
+#include <optimus/functional.h>
+#include <optimus/mapped_file.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+using row = std::tuple<std::int32_t, double, std::uint8_t, std::int64_t>;
+using view_type = optimus::columnar_file_view<std::int32_t, double, std::uint8_t, std::int64_t>;
+
+std::vector<row> make_rows(int n) {
+    std::vector<row> rows;
+    for (int i = 0; i < n; ++i) {
+        rows.emplace_back(i, i * 0.25, std::uint8_t(i % 7), std::int64_t(i) * -3);
+    }
+    return rows;
+}
+
+// Serializes `rows` into a buffer aligned for every column type.
+std::vector<std::uint64_t> write_rows(const std::vector<row>& rows, std::size_t block_rows,
+                                      std::size_t* size) {
+    std::ostringstream out;
+    EXPECT_TRUE((optimus::write_columnar_file<std::int32_t, double, std::uint8_t, std::int64_t>(
+            out, rows.begin(), rows.end(), block_rows)));
+    const std::string bytes = out.str();
+    std::vector<std::uint64_t> buffer((bytes.size() + 7) / 8);
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    *size = bytes.size();
+    return buffer;
+}
+
+struct collect {
+    std::vector<std::int64_t> values;
+
+    template <typename... Args>
+    void operator()(const Args&... args) {
+        using swallow = int[];
+        (void)swallow{0, (values.push_back(std::int64_t(args)), 0)...};
+    }
+};
+
+} // namespace
+
+TEST(columnar_file_view, columns) {
+    const auto rows = make_rows(10000);
+    std::size_t size;
+    const auto buffer = write_rows(rows, 256, &size);
+
+    view_type view{buffer.data(), size};
+    ASSERT_TRUE(view.valid());
+    ASSERT_EQ(rows.size(), view.size());
+    EXPECT_EQ(256u, view.block_rows());
+    EXPECT_EQ(40u, view.block_count());
+
+    const auto c0 = view.column<0>();
+    const auto c1 = view.column<1>();
+    const auto c2 = view.column<2>();
+    const auto c3 = view.column<3>();
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(std::get<0>(rows[i]), c0[i]);
+        EXPECT_EQ(std::get<1>(rows[i]), c1[i]);
+        EXPECT_EQ(std::get<2>(rows[i]), c2[i]);
+        EXPECT_EQ(std::get<3>(rows[i]), c3[i]);
+    }
+    // Columns live in separate, page aligned segments.
+    const char* base = reinterpret_cast<const char*>(buffer.data());
+    EXPECT_EQ(0, (reinterpret_cast<const char*>(c1.data()) - base) % 4096);
+    EXPECT_GE(reinterpret_cast<const char*>(c1.data()) - reinterpret_cast<const char*>(c0.data()),
+              std::ptrdiff_t(rows.size() * sizeof(std::int32_t)));
+}
+
+TEST(columnar_file_view, statistics) {
+    const auto rows = make_rows(1000);
+    std::size_t size;
+    const auto buffer = write_rows(rows, 300, &size);
+
+    view_type view{buffer.data(), size};
+    ASSERT_TRUE(view.valid());
+    const auto c0 = view.column<0>();
+    const auto c3 = view.column<3>();
+    ASSERT_EQ(4u, c0.block_count());
+    EXPECT_EQ(0, c0.block_min(0));
+    EXPECT_EQ(299, c0.block_max(0));
+    EXPECT_EQ(900, c0.block_min(3));
+    EXPECT_EQ(999, c0.block_max(3));
+    EXPECT_EQ(-897, c3.block_min(0));
+    EXPECT_EQ(0, c3.block_max(0));
+    EXPECT_EQ(0, view.column<2>().block_min(1));
+    EXPECT_EQ(6, view.column<2>().block_max(1));
+}
+
+TEST(columnar_file_view, rejects_invalid) {
+    const auto rows = make_rows(100);
+    std::size_t size;
+    auto buffer = write_rows(rows, 16, &size);
+
+    EXPECT_TRUE((view_type{buffer.data(), size}.valid()));
+    EXPECT_FALSE((view_type{buffer.data(), size / 2}.valid()));
+    EXPECT_FALSE((view_type{buffer.data(), 64}.valid()));
+    EXPECT_FALSE((view_type{nullptr, 0}.valid()));
+    EXPECT_FALSE((optimus::columnar_file_view<std::int32_t, double, std::uint8_t>{buffer.data(), size}.valid()));
+    EXPECT_FALSE((optimus::columnar_file_view<std::int32_t, float, std::uint8_t, std::int64_t>{
+            buffer.data(), size}.valid()));
+
+    auto* header = reinterpret_cast<optimus::columnar_file_header*>(buffer.data());
+    header->version = 2;
+    const view_type invalid{buffer.data(), size};
+    EXPECT_FALSE(invalid.valid());
+    EXPECT_EQ(0u, invalid.size());
+    EXPECT_TRUE(invalid.column<1>().empty());
+}
+
+TEST(scan, projection) {
+    const auto rows = make_rows(5000);
+    std::size_t size;
+    const auto buffer = write_rows(rows, 128, &size);
+    view_type view{buffer.data(), size};
+
+    const auto one = optimus::scan<optimus::get<3>>(view, collect{});
+    ASSERT_EQ(rows.size(), one.values.size());
+    EXPECT_EQ(-3 * 4999, one.values.back());
+
+    const auto two = optimus::scan<optimus::variadic<optimus::get<0>, optimus::get<2>>>(view, collect{});
+    ASSERT_EQ(2 * rows.size(), two.values.size());
+    EXPECT_EQ(4999, two.values[2 * 4999]);
+    EXPECT_EQ(4999 % 7, two.values[2 * 4999 + 1]);
+}
+
+TEST(scan, where) {
+    const auto rows = make_rows(5000);
+    std::size_t size;
+    const auto buffer = write_rows(rows, 128, &size);
+    view_type view{buffer.data(), size};
+
+    EXPECT_EQ(100u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>(optimus::less<std::int32_t>{}, 100), collect{}).values.size());
+    EXPECT_EQ(10u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>(optimus::greater_equal<std::int32_t>{}, 4990), collect{}).values.size());
+    EXPECT_EQ(4989u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<3>(optimus::less<std::int64_t>{}, -3 * 10), collect{}).values.size());
+    const auto sevens = optimus::scan<optimus::get<0>>(
+            view, optimus::where<2>(optimus::equal_to<std::uint8_t>{}, 6), collect{});
+    EXPECT_EQ(714u, sevens.values.size());
+    EXPECT_EQ(6, sevens.values[0]);
+    const auto none = optimus::scan<optimus::get<1>>(
+            view, optimus::where<0>(optimus::greater<std::int32_t>{}, 5000), collect{});
+    EXPECT_TRUE(none.values.empty());
+    // Not a functional.h comparison, so no blocks are skipped.
+    const auto odd = optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>([](std::int32_t v, int m) { return v % m == 1; }, 2), collect{});
+    EXPECT_EQ(2500u, odd.values.size());
+}
+
+TEST(scan, skips_blocks) {
+    const auto rows = make_rows(1024);
+    std::size_t size;
+    auto buffer = write_rows(rows, 256, &size);
+    view_type view{buffer.data(), size};
+
+    // Rows of blocks which the statistics rule out are never read: overwrite
+    // the last block with matching values behind the statistics' back.
+    auto* c0 = const_cast<std::int32_t*>(view.column<0>().data());
+    for (int i = 768; i < 1024; ++i) {
+        c0[i] = -1;
+    }
+    EXPECT_EQ(10u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>(optimus::less<std::int32_t>{}, 10), collect{}).values.size());
+    EXPECT_EQ(10u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>(optimus::less_equal<std::int32_t>{}, 9), collect{}).values.size());
+    // A block which can match is read as it is.
+    EXPECT_EQ(1024u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<0>(optimus::less<std::int32_t>{}, 800), collect{}).values.size());
+}
+
+TEST(scan, nan_values) {
+    auto rows = make_rows(1024);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    // The first block starts with a NaN, and the second is all NaN.
+    std::get<1>(rows[0]) = nan;
+    for (int i = 256; i < 512; ++i) {
+        std::get<1>(rows[i]) = nan;
+    }
+    std::size_t size;
+    const auto buffer = write_rows(rows, 256, &size);
+    view_type view{buffer.data(), size};
+
+    const auto c1 = view.column<1>();
+    EXPECT_EQ(0.25, c1.block_min(0));
+    EXPECT_EQ(255 * 0.25, c1.block_max(0));
+    EXPECT_EQ(10u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<1>(optimus::less<double>{}, 11 * 0.25), collect{}).values.size());
+    EXPECT_EQ(1u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<1>(optimus::equal_to<double>{}, 0.25), collect{}).values.size());
+    EXPECT_EQ(1024u - 257u, optimus::scan<optimus::get<0>>(
+            view, optimus::where<1>(optimus::greater_equal<double>{}, 0.0), collect{}).values.size());
+}
+
+TEST(mapped_file, columnar_file) {
+    char path[] = "/tmp/optimus_columnar_test_XXXXXX";
+    const int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    const auto rows = make_rows(20000);
+    {
+        std::ofstream out(path, std::ios::binary);
+        ASSERT_TRUE((optimus::write_columnar_file<std::int32_t, double, std::uint8_t, std::int64_t>(
+                out, rows.begin(), rows.end())));
+    }
+    optimus::mapped_file file{path};
+    ASSERT_TRUE(file.valid());
+    view_type view{file.data(), file.size()};
+    ASSERT_TRUE(view.valid());
+    EXPECT_EQ(optimus::columnar_default_block_rows, view.block_rows());
+
+    double sum = 0;
+    optimus::scan<optimus::get<1>>(view, [&sum](double v) { sum += v; });
+    EXPECT_DOUBLE_EQ(0.25 * 19999 * 20000 / 2, sum);
+    std::remove(path);
+}
@@ -1,7 +1,10 @@
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <random>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -84,6 +87,20 @@ TEST(constant, integral_constant_constexpr) {
     EXPECT_EQ(42, (std::integral_constant<char, c(4, 5, A{9})>::value));
 }
 
+TEST(constant_ref, returns_a_reference) {
+    const optimus::constant_ref<std::string> c{3, 'x'};
+    EXPECT_SAME_TYPE(const std::string&, decltype(c(1, A{2})));
+    EXPECT_EQ(&c(), &c(inplace{}, 4));
+    EXPECT_EQ("xxx", c());
+    static_assert(noexcept(c()), "");
+    static_assert(!std::is_default_constructible<optimus::constant_ref<int>>::value, "");
+}
+
+TEST(constant_ref, constexpr) {
+    constexpr optimus::constant_ref<A> c{4};
+    EXPECT_EQ(4, (std::integral_constant<int, c(4, 5, A{9}).value>::value));
+}
+
 template <typename, typename>
 struct add;
 
@@ -143,5 +160,154 @@ TEST(foldl, first_argument) {
     EXPECT_EQ(10, (optimus::foldl1<store_first, mi<10>, mi<12>>::type::value));
 }
 
+template <typename T>
+void expect_divides_like_builtin(T n, T d) {
+    EXPECT_EQ(T(n / d), optimus::divides_by<T>{d}(n)) << +n << " / " << +d;
+    EXPECT_EQ(T(n % d), optimus::modulus_by<T>{d}(n)) << +n << " % " << +d;
+}
+
+template <typename T>
+void expect_divides_exhaustive() {
+    for (int d = std::numeric_limits<T>::min(); d <= std::numeric_limits<T>::max(); ++d) {
+        if (d == 0) {
+            continue;
+        }
+        for (int n = std::numeric_limits<T>::min(); n <= std::numeric_limits<T>::max(); ++n) {
+            expect_divides_like_builtin<T>(T(n), T(d));
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> interesting_values() {
+    // Neighbours are worked out unsigned, where they wrap rather than
+    // overflow at the ends of the range.
+    using U = typename std::make_unsigned<T>::type;
+    std::vector<T> values;
+    for (unsigned i = 0; i < 8 * sizeof(T); ++i) {
+        const U p = U(U(1) << i);
+        values.insert(values.end(), {T(p), T(U(p - 1)), T(U(p + 1)), T(U(-p))});
+    }
+    values.insert(values.end(), {
+            std::numeric_limits<T>::min(), T(std::numeric_limits<T>::min() + 1),
+            std::numeric_limits<T>::max(), T(std::numeric_limits<T>::max() - 1),
+            T(3), T(7), T(10), T(641), T(6700417)});
+
+    static std::mt19937_64 gen(42);
+    std::uniform_int_distribution<T> dis(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    for (std::size_t i = 0; i < 64; ++i) {
+        values.push_back(dis(gen));
+    }
+    return values;
+}
+
+template <typename T>
+void expect_divides_interesting() {
+    const auto values = interesting_values<T>();
+    for (const T d : values) {
+        for (const T n : values) {
+            if (d == 0 || (std::is_signed<T>::value && d == T(-1) && n == std::numeric_limits<T>::min())) {
+                continue;
+            }
+            expect_divides_like_builtin<T>(n, d);
+        }
+    }
+}
+
+TEST(divides_by, exhaustive_8_bit) {
+    expect_divides_exhaustive<std::uint8_t>();
+    expect_divides_exhaustive<std::int8_t>();
+}
+
+TEST(divides_by, interesting_values) {
+    expect_divides_interesting<std::uint16_t>();
+    expect_divides_interesting<std::int16_t>();
+    expect_divides_interesting<std::uint32_t>();
+    expect_divides_interesting<std::int32_t>();
+    expect_divides_interesting<std::uint64_t>();
+    expect_divides_interesting<std::int64_t>();
+    expect_divides_interesting<unsigned long long>();
+    expect_divides_interesting<long long>();
+}
+
+TEST(divides_by, constexpr) {
+    constexpr optimus::divides_by<unsigned> d{7};
+    constexpr optimus::modulus_by<int> m{-7};
+    EXPECT_EQ(6u, (std::integral_constant<unsigned, d(45)>::value));
+    EXPECT_EQ(-3, (std::integral_constant<int, m(-45)>::value));
+    EXPECT_EQ(7u, (std::integral_constant<unsigned, d.divisor()>::value));
+}
+
+TEST(divides_by, integral_constant) {
+    constexpr optimus::divides_by<std::integral_constant<std::uint64_t, 1000>> d;
+    constexpr optimus::modulus_by<std::integral_constant<int, 16>> m;
+    EXPECT_EQ(12u, (std::integral_constant<std::uint64_t, d(12345)>::value));
+    EXPECT_EQ(-9, (std::integral_constant<int, m(-25)>::value));
+    EXPECT_EQ(16, (std::integral_constant<int, m.divisor()>::value));
+}
+
+TEST(divides_by, batch) {
+    std::vector<std::uint32_t> in(1000), quotients(in.size()), remainders(in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        in[i] = std::uint32_t(i * 2654435761u);
+    }
+    const optimus::divides_by<std::uint32_t> d{97};
+    const optimus::modulus_by<std::uint32_t> m{97};
+    EXPECT_EQ(quotients.data() + in.size(), d(in.data(), in.data() + in.size(), quotients.data()));
+    EXPECT_EQ(remainders.data() + in.size(), m(in.data(), in.data() + in.size(), remainders.data()));
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(in[i] / 97, quotients[i]);
+        EXPECT_EQ(in[i] % 97, remainders[i]);
+    }
+
+    const optimus::modulus_by<std::integral_constant<std::uint32_t, 97>> cm;
+    cm(in.data(), in.data() + in.size(), quotients.data());
+    EXPECT_EQ(remainders, quotients);
+}
+
+TEST(identity_element, values) {
+    static_assert(optimus::identity_element<optimus::plus<int>>::value() == 0, "");
+    static_assert(optimus::identity_element<optimus::multiplies<double>>::value() == 1.0, "");
+    static_assert(optimus::identity_element<optimus::bit_and<std::uint8_t>>::value() == 0xff, "");
+    static_assert(optimus::identity_element<optimus::bit_or<std::uint64_t>>::value() == 0, "");
+    static_assert(optimus::identity_element<optimus::logical_and<bool>>::value(), "");
+    static_assert(!optimus::identity_element<optimus::logical_or<bool>>::value(), "");
+
+    for (std::uint32_t x : {0u, 1u, 12345u, 0xffffffffu}) {
+        EXPECT_EQ(x, optimus::bit_and<std::uint32_t>{}(optimus::identity_element<optimus::bit_and<std::uint32_t>>::value(), x));
+        EXPECT_EQ(x, optimus::bit_xor<std::uint32_t>{}(optimus::identity_element<optimus::bit_xor<std::uint32_t>>::value(), x));
+    }
+}
+
+namespace {
+
+// Compares with operators which may throw.
+struct throwing_less {
+    int value;
+
+    bool operator<(const throwing_less& other) const {
+        return value < other.value;
+    }
+};
+
+} // namespace
+
+TEST(functional, noexcept) {
+    static_assert(noexcept(optimus::less<int>{}(1, 2)), "builtin comparisons cannot throw");
+    static_assert(noexcept(optimus::plus<double>{}(1.0, 2.0)), "builtin arithmetic cannot throw");
+    static_assert(noexcept(optimus::logical_not<bool>{}(true)), "builtin operators cannot throw");
+    static_assert(!noexcept(optimus::less<throwing_less>{}(throwing_less{1}, throwing_less{2})),
+                  "follows the operator");
+    static_assert(noexcept(optimus::divides_by<int>{3}(7)), "division by a fixed divisor cannot throw");
+    static_assert(noexcept(optimus::modulus_by<std::integral_constant<unsigned, 3>>{}(7u)), "");
+    static_assert(noexcept(optimus::constant<int>{1}()), "");
+    static_assert(noexcept(optimus::constant<std::integral_constant<int, 1>>{}()), "");
+    static_assert(std::is_nothrow_default_constructible<optimus::less<int>>::value, "");
+    static_assert(std::is_nothrow_copy_constructible<optimus::less<throwing_less>>::value, "");
+    static_assert(std::is_nothrow_move_constructible<optimus::divides_by<int>>::value, "");
+    static_assert(optimus::is_nothrow_call<const optimus::greater<int>&(int&, int&)>::value, "");
+    EXPECT_TRUE(optimus::less<throwing_less>{}(throwing_less{1}, throwing_less{2}));
+}
+
 #undef EXPECT_SAME_TYPE
 #undef EXPECT_SAME_TYPE_AS
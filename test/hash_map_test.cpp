@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/hash_map.h>
+
+TEST(flat_hash_map, insert_find) {
+    optimus::flat_hash_map<int, int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.find(1) == map.end());
+
+    EXPECT_TRUE(map.try_emplace(1, 10).second);
+    EXPECT_FALSE(map.try_emplace(1, 20).second);
+    EXPECT_EQ(10, map.find(1)->second);
+    map[2] = 30;
+    EXPECT_EQ(30, map[2]);
+    EXPECT_EQ(2u, map.size());
+    EXPECT_EQ(1u, map.count(2));
+    EXPECT_EQ(0u, map.count(3));
+}
+
+TEST(flat_hash_map, grows) {
+    optimus::flat_hash_map<std::uint64_t, std::uint64_t> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> expected;
+    std::mt19937_64 gen{42};
+    for (int i = 0; i < 100000; ++i) {
+        const std::uint64_t key = gen() % 50000;
+        map[key] += i;
+        expected[key] += i;
+    }
+    ASSERT_EQ(expected.size(), map.size());
+    EXPECT_LE(map.size(), map.capacity() - map.capacity() / 8);
+    for (const auto& entry : expected) {
+        auto it = map.find(entry.first);
+        ASSERT_TRUE(it != map.end());
+        EXPECT_EQ(entry.second, it->second);
+    }
+    std::size_t visited = 0;
+    for (const auto& entry : map) {
+        EXPECT_EQ(expected[entry.first], entry.second);
+        ++visited;
+    }
+    EXPECT_EQ(expected.size(), visited);
+}
+
+TEST(flat_hash_map, reserve) {
+    optimus::flat_hash_map<int, int> map{1000};
+    const std::size_t capacity = map.capacity();
+    EXPECT_GE(capacity - capacity / 8, 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        map.try_emplace(i, i);
+    }
+    EXPECT_EQ(capacity, map.capacity());
+}
+
+namespace {
+
+// Fails any allocation of more than this many bytes.
+std::size_t allocation_limit = std::size_t(-1);
+
+template <typename T>
+struct limited_allocator {
+    using value_type = T;
+
+    limited_allocator() = default;
+
+    template <typename U>
+    limited_allocator(const limited_allocator<U>&) { }
+
+    T* allocate(std::size_t n) {
+        if (n * sizeof(T) > allocation_limit) {
+            throw std::bad_alloc{};
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const limited_allocator<T>&, const limited_allocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const limited_allocator<T>&, const limited_allocator<U>&) {
+    return false;
+}
+
+} // namespace
+
+TEST(flat_hash_map, failed_rehash) {
+    optimus::flat_hash_map<int, int, std::hash<int>, limited_allocator<std::pair<int, int>>> map;
+    for (int i = 0; i < 10; ++i) {
+        map.try_emplace(i, i);
+    }
+    const std::size_t capacity = map.capacity();
+    // Growing to 2048 slots fails first on the slots, with the control bytes
+    // under the limit, then on the control bytes.
+    for (std::size_t limit : {std::size_t(4096), std::size_t(0)}) {
+        allocation_limit = limit;
+        EXPECT_THROW(map.reserve(1000), std::bad_alloc);
+        allocation_limit = std::size_t(-1);
+
+        EXPECT_EQ(capacity, map.capacity());
+        EXPECT_EQ(10u, map.size());
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(map.find(i) != map.end());
+            EXPECT_EQ(i, map.find(i)->second);
+        }
+    }
+    map.reserve(1000);
+    EXPECT_EQ(2048u, map.capacity());
+    EXPECT_EQ(9, map.find(9)->second);
+}
+
+TEST(flat_hash_map, accumulate) {
+    optimus::flat_hash_map<std::string, int> map;
+    const std::vector<std::pair<std::string, int>> rows{{"a", 1}, {"b", 2}, {"a", 3}, {"c", 4}, {"b", 5}};
+    for (const auto& row : rows) {
+        map.accumulate(row.first, row.second, optimus::plus<int>{});
+    }
+    EXPECT_EQ(3u, map.size());
+    EXPECT_EQ(4, map["a"]);
+    EXPECT_EQ(7, map["b"]);
+    EXPECT_EQ(4, map["c"]);
+}
+
+TEST(flat_hash_map, copy_move) {
+    optimus::flat_hash_map<std::string, std::string> map;
+    for (int i = 0; i < 100; ++i) {
+        map.try_emplace(std::to_string(i), std::string(i, 'x'));
+    }
+    auto copy = map;
+    EXPECT_EQ(100u, copy.size());
+    EXPECT_EQ(std::string(42, 'x'), copy["42"]);
+
+    auto moved = std::move(map);
+    EXPECT_EQ(100u, moved.size());
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.begin() == map.end());
+
+    map = moved;
+    EXPECT_EQ(std::string(7, 'x'), map["7"]);
+}
+
+TEST(flat_hash_map, colliding_hashes) {
+    struct constant_hash {
+        std::size_t operator()(int) const { return 7; }
+    };
+    optimus::flat_hash_map<int, int, constant_hash> map;
+    for (int i = 0; i < 200; ++i) {
+        map.try_emplace(i, -i);
+    }
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(-i, map.find(i)->second);
+    }
+    EXPECT_TRUE(map.find(200) == map.end());
+}
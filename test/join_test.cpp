@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/join.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+using left_row = std::tuple<std::uint32_t, std::int64_t>;
+using right_row = std::pair<std::string, std::uint32_t>;
+
+// (left index, right index) of every matching pair, sorted.
+using pairs = std::vector<std::pair<std::size_t, std::size_t>>;
+
+pairs nested_loop_join(const std::vector<left_row>& left, const std::vector<right_row>& right) {
+    pairs result;
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        for (std::size_t j = 0; j < right.size(); ++j) {
+            if (std::get<0>(left[i]) == right[j].second) {
+                result.emplace_back(i, j);
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Pair>
+std::pair<std::size_t, std::size_t> indices(const Pair& pair, const std::vector<left_row>& left,
+                                            const std::vector<right_row>& right) {
+    return {std::size_t(&std::get<0>(pair) - left.data()), std::size_t(&std::get<1>(pair) - right.data())};
+}
+
+template <typename Join>
+pairs collect(const Join& join, const std::vector<left_row>& left, const std::vector<right_row>& right) {
+    pairs result;
+    for (auto pair : join) {
+        result.push_back(indices(pair, left, right));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template <typename Join>
+pairs parallel_collect(const Join& join, const std::vector<left_row>& left,
+                       const std::vector<right_row>& right, std::size_t threads) {
+    pairs result;
+    std::mutex mutex;
+    join.parallel_for_each([&](typename Join::value_type pair) {
+        std::lock_guard<std::mutex> lock{mutex};
+        result.push_back(indices(pair, left, right));
+    }, threads);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void make_rows(std::size_t left_size, std::size_t right_size, std::uint32_t keys,
+               std::vector<left_row>& left, std::vector<right_row>& right) {
+    std::mt19937 gen{left_size + right_size};
+    left.clear();
+    right.clear();
+    for (std::size_t i = 0; i < left_size; ++i) {
+        left.emplace_back(gen() % keys, std::int64_t(i));
+    }
+    for (std::size_t i = 0; i < right_size; ++i) {
+        right.emplace_back("r" + std::to_string(i), gen() % keys);
+    }
+}
+
+using left_key = optimus::get<0>;
+using right_key = optimus::snd;
+
+} // namespace
+
+TEST(hash_join, small) {
+    const std::vector<left_row> left{left_row{1, 10}, left_row{2, 20}, left_row{3, 30}, left_row{2, 40}};
+    const std::vector<right_row> right{{"a", 2}, {"b", 3}, {"c", 2}, {"d", 5}};
+    const auto join = optimus::hash_join<left_key, right_key>(left, right);
+    EXPECT_EQ((pairs{{1, 0}, {1, 2}, {2, 1}, {3, 0}, {3, 2}}), collect(join, left, right));
+
+    using reference = decltype(*join.begin());
+    EXPECT_TRUE((std::is_same<optimus::tuple<const left_row&, const right_row&>, reference>::value));
+    for (auto pair : join) {
+        EXPECT_EQ(std::get<0>(std::get<0>(pair)), std::get<1>(std::get<1>(pair)));
+        EXPECT_EQ(optimus::fst{}(optimus::fst{}(pair)), optimus::snd{}(optimus::snd{}(pair)));
+    }
+}
+
+TEST(hash_join, empty) {
+    std::vector<left_row> left;
+    std::vector<right_row> right;
+    EXPECT_TRUE(collect(optimus::hash_join<left_key, right_key>(left, right), left, right).empty());
+    left.emplace_back(1, 1);
+    EXPECT_TRUE(collect(optimus::hash_join<left_key, right_key>(left, right), left, right).empty());
+    right.emplace_back("a", 2);
+    EXPECT_TRUE(collect(optimus::hash_join<left_key, right_key>(left, right), left, right).empty());
+}
+
+TEST(hash_join, matches_nested_loops) {
+    std::vector<left_row> left;
+    std::vector<right_row> right;
+    for (std::uint32_t keys : {1u, 10u, 1000u}) {
+        make_rows(700, 300, keys, left, right);
+        EXPECT_EQ(nested_loop_join(left, right),
+                  collect(optimus::hash_join<left_key, right_key>(left, right), left, right)) << keys;
+    }
+}
+
+TEST(hash_join, partitioned) {
+    std::vector<left_row> left;
+    std::vector<right_row> right;
+    make_rows(200000, 100000, 150000, left, right);
+    const auto expected = collect(optimus::hash_join<left_key, right_key>(left, right), left, right);
+
+    std::map<std::uint32_t, std::size_t> right_counts;
+    for (const auto& row : right) {
+        ++right_counts[row.second];
+    }
+    std::size_t matches = 0;
+    for (const auto& row : left) {
+        auto it = right_counts.find(std::get<0>(row));
+        matches += it == right_counts.end() ? 0 : it->second;
+    }
+    EXPECT_EQ(matches, expected.size());
+
+    const auto threaded = optimus::hash_join<left_key, right_key>(left, right, left_key{}, right_key{}, 4);
+    EXPECT_EQ(expected, collect(threaded, left, right));
+    EXPECT_EQ(expected, parallel_collect(threaded, left, right, 4));
+}
+
+TEST(merge_join, small) {
+    const std::vector<left_row> left{left_row{1, 10}, left_row{2, 20}, left_row{2, 40}, left_row{3, 30}};
+    const std::vector<right_row> right{{"a", 2}, {"c", 2}, {"b", 3}, {"d", 5}};
+    const auto join = optimus::merge_join<left_key, right_key>(left, right);
+    pairs in_order;
+    for (auto pair : join) {
+        in_order.push_back(indices(pair, left, right));
+    }
+    EXPECT_EQ((pairs{{1, 0}, {1, 1}, {2, 0}, {2, 1}, {3, 2}}), in_order);
+}
+
+TEST(merge_join, matches_nested_loops) {
+    std::vector<left_row> left;
+    std::vector<right_row> right;
+    for (std::uint32_t keys : {1u, 10u, 1000u}) {
+        make_rows(700, 300, keys, left, right);
+        std::sort(left.begin(), left.end());
+        std::sort(right.begin(), right.end(),
+                  [](const right_row& a, const right_row& b) { return a.second < b.second; });
+        EXPECT_EQ(nested_loop_join(left, right),
+                  collect(optimus::merge_join<left_key, right_key>(left, right), left, right)) << keys;
+    }
+}
+
+TEST(merge_join, parallel) {
+    std::vector<left_row> left;
+    std::vector<right_row> right;
+    for (std::uint32_t keys : {2000u, 100000u}) {
+        make_rows(100000, 50000, keys, left, right);
+        std::sort(left.begin(), left.end());
+        std::sort(right.begin(), right.end(),
+                  [](const right_row& a, const right_row& b) { return a.second < b.second; });
+        const auto join = optimus::merge_join<left_key, right_key>(left, right);
+        EXPECT_EQ(collect(join, left, right), parallel_collect(join, left, right, 4)) << keys;
+    }
+}
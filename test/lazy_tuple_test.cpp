@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/lazy_tuple.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+// Parses field `I` of a comma separated line, and counts how often it does.
+template <std::size_t I>
+struct csv_int {
+    int* calls;
+
+    long operator()(const char* line) const {
+        ++*calls;
+        for (std::size_t i = 0; i < I; ++i) {
+            while (*line++ != ',') { }
+        }
+        return std::strtol(line, nullptr, 10);
+    }
+};
+
+struct csv_text {
+    std::string operator()(const char* line) const {
+        const char* end = line;
+        while (*end != ',' && *end != '\0') {
+            ++end;
+        }
+        return std::string(line, end);
+    }
+};
+
+using row = optimus::lazy_tuple<const char*, csv_text, csv_int<1>, csv_int<2>, csv_int<3>>;
+
+struct ignore {
+    template <typename T>
+    int operator()(const T&) const {
+        return 0;
+    }
+};
+
+using wide = optimus::lazy_tuple<int, ignore, ignore, ignore, ignore, ignore, ignore, ignore, ignore, ignore>;
+
+static_assert(std::is_same<row::mask_type, std::uint8_t>::value, "a bit per element");
+static_assert(std::is_same<wide::mask_type, std::uint16_t>::value, "a bit per element");
+static_assert(std::tuple_size<row>::value == 4, "an element per function");
+static_assert(std::is_same<std::tuple_element<0, row>::type, std::string>::value, "decayed results");
+static_assert(std::is_same<std::tuple_element<3, row>::type, long>::value, "decayed results");
+
+struct counted {
+    static int live;
+
+    explicit counted(int) {
+        ++live;
+    }
+    counted(const counted&) {
+        ++live;
+    }
+    ~counted() {
+        --live;
+    }
+};
+
+int counted::live = 0;
+
+struct make_counted {
+    counted operator()(int source) const {
+        return counted(source);
+    }
+};
+
+} // namespace
+
+TEST(lazy_tuple, works_out_only_what_is_read) {
+    int calls[3] = {};
+    row r("ibm,10,20,30", csv_text{}, csv_int<1>{calls}, csv_int<2>{calls + 1}, csv_int<3>{calls + 2});
+    EXPECT_EQ(0, r.mask());
+
+    EXPECT_EQ(30, optimus::get<3>{}(r));
+    EXPECT_EQ(30, r.get<3>());
+    EXPECT_EQ(0, calls[0]);
+    EXPECT_EQ(0, calls[1]);
+    EXPECT_EQ(1, calls[2]);
+    EXPECT_EQ(0x8, r.mask());
+    EXPECT_TRUE(r.initialized<3>());
+    EXPECT_FALSE(r.initialized<1>());
+
+    const row& c = r;
+    EXPECT_EQ("ibm", optimus::get<0>{}(c));
+    EXPECT_EQ(0x9, r.mask());
+}
+
+TEST(lazy_tuple, get_transformers) {
+    int calls[3] = {};
+    row a("a,5,1,0", csv_text{}, csv_int<1>{calls}, csv_int<2>{calls + 1}, csv_int<3>{calls + 2});
+    row b("b,7,0,0", csv_text{}, csv_int<1>{calls}, csv_int<2>{calls + 1}, csv_int<3>{calls + 2});
+
+    optimus::get<1>::apply<optimus::less<long>> by_second;
+    EXPECT_TRUE(by_second(a, b));
+    EXPECT_FALSE(by_second(b, a));
+    EXPECT_EQ("b", optimus::get<0>{}(b));
+    EXPECT_EQ(2, calls[0]);
+    EXPECT_EQ(0, calls[1]);
+    EXPECT_EQ(0, calls[2]);
+}
+
+TEST(lazy_tuple, reset_and_copy) {
+    int calls[3] = {};
+    row r("x,1,2,3", csv_text{}, csv_int<1>{calls}, csv_int<2>{calls + 1}, csv_int<3>{calls + 2});
+    EXPECT_EQ(2, optimus::get<2>{}(r));
+
+    row copy = r;
+    EXPECT_EQ(r.mask(), copy.mask());
+    EXPECT_EQ(2, optimus::get<2>{}(copy));
+    EXPECT_EQ(1, calls[1]);
+
+    r.reset("y,4,5,6");
+    EXPECT_EQ(0, r.mask());
+    EXPECT_EQ(5, optimus::get<2>{}(r));
+    EXPECT_EQ("y", optimus::get<0>{}(r));
+    EXPECT_EQ(2, calls[1]);
+
+    copy = r;
+    EXPECT_EQ("y", optimus::get<0>{}(copy));
+    EXPECT_EQ(r.mask(), copy.mask());
+
+    row moved = std::move(copy);
+    EXPECT_EQ("y", optimus::get<0>{}(moved));
+    EXPECT_EQ(2, calls[1]);
+}
+
+TEST(lazy_tuple, destroys_what_was_made) {
+    {
+        auto t = optimus::make_lazy_tuple(7, make_counted{}, make_counted{}, make_counted{});
+        EXPECT_EQ(0, counted::live);
+        optimus::get<0>{}(t);
+        optimus::get<2>{}(t);
+        optimus::get<2>{}(t);
+        EXPECT_EQ(2, counted::live);
+
+        auto copy = t;
+        EXPECT_EQ(4, counted::live);
+
+        t.reset(8);
+        EXPECT_EQ(2, counted::live);
+    }
+    EXPECT_EQ(0, counted::live);
+}
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/parallel.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+std::size_t fib(optimus::work_stealing_pool& pool, std::size_t n) {
+    if (n < 2) {
+        return n;
+    }
+    std::size_t results[2];
+    pool.for_each_index(2, [&](std::size_t i) {
+        results[i] = fib(pool, n - 1 - i);
+    });
+    return results[0] + results[1];
+}
+
+struct length {
+    std::size_t operator()(const std::string& s) const {
+        return s.size();
+    }
+};
+
+struct negate {
+    int operator()(int x) const {
+        return -x;
+    }
+};
+
+struct cheap_negate {
+    static constexpr std::size_t cost = 10;
+
+    int operator()(int x) const {
+        return -x;
+    }
+};
+
+struct take_ownership {
+    std::unique_ptr<int> operator()(std::unique_ptr<int>&& p) const {
+        return std::move(p);
+    }
+};
+
+struct first_char {
+    const char& operator()(const std::string& s) const {
+        return s[0];
+    }
+};
+
+struct throws {
+    int operator()(int) const {
+        throw std::runtime_error("throws");
+    }
+};
+
+struct sum {
+    template <typename... Args>
+    std::size_t operator()(Args&&... args) const {
+        std::size_t total = 0;
+        for (std::size_t x : {std::size_t(args)...}) {
+            total += x;
+        }
+        return total;
+    }
+};
+
+} // namespace
+
+TEST(work_stealing_pool, runs_every_index_once) {
+    optimus::work_stealing_pool pool{3};
+    EXPECT_EQ(3u, pool.size());
+    std::vector<std::atomic<int>> runs(1000);
+    pool.for_each_index(runs.size(), [&](std::size_t i) {
+        ++runs[i];
+    });
+    for (const auto& r : runs) {
+        EXPECT_EQ(1, r.load());
+    }
+}
+
+TEST(work_stealing_pool, tasks_run_concurrently) {
+    // Each task waits for all the others to start, which can only happen
+    // if they run on different threads.
+    optimus::work_stealing_pool pool{3};
+    std::atomic<int> started{0};
+    pool.for_each_index(4, [&](std::size_t) {
+        ++started;
+        while (started.load() < 4) {
+            std::this_thread::yield();
+        }
+    });
+    EXPECT_EQ(4, started.load());
+}
+
+TEST(work_stealing_pool, nested) {
+    optimus::work_stealing_pool pool{2};
+    EXPECT_EQ(6765u, fib(pool, 20));
+
+    optimus::work_stealing_pool alone{0};
+    EXPECT_EQ(610u, fib(alone, 15));
+}
+
+TEST(work_stealing_pool, rethrows) {
+    optimus::work_stealing_pool pool{2};
+    std::atomic<int> runs{0};
+    EXPECT_THROW(pool.for_each_index(8, [&](std::size_t i) {
+        ++runs;
+        if (i == 5) {
+            throw std::runtime_error("5");
+        }
+    }), std::runtime_error);
+    // Every task still ran before the exception left.
+    EXPECT_EQ(8, runs.load());
+}
+
+TEST(run_threads, rethrows) {
+    std::atomic<int> runs{0};
+    EXPECT_THROW(optimus::detail::run_threads(4, [&](std::size_t i) {
+        ++runs;
+        if (i == 2) {
+            throw std::runtime_error("2");
+        }
+    }), std::runtime_error);
+    // Every thread was joined before the exception left.
+    EXPECT_EQ(4, runs.load());
+}
+
+TEST(parallel_variadic, matches_variadic) {
+    const std::string s = "hello";
+    auto parallel = optimus::parallel_variadic<length, negate, optimus::id>::apply<sum>{};
+    auto serial = optimus::variadic<length, negate, optimus::id>::apply<sum>{};
+    EXPECT_EQ(serial(s, -3, 4), parallel(s, -3, 4));
+    EXPECT_EQ(12u, parallel(s, -3, 4));
+
+    auto less = optimus::parallel_variadic<length, length>::apply<optimus::less<std::size_t>>{};
+    EXPECT_TRUE(less(std::string("ab"), s));
+    EXPECT_FALSE(less(s, s));
+}
+
+TEST(parallel_variadic, cheap_fns_stay_inline) {
+    EXPECT_TRUE((optimus::task_cost<negate>::value >= optimus::parallel_min_cost));
+    EXPECT_EQ(10u, optimus::task_cost<cheap_negate>::value);
+
+    auto f = optimus::parallel_variadic<cheap_negate, cheap_negate>::apply<optimus::plus<int>>{};
+    EXPECT_EQ(-5, f(2, 3));
+}
+
+TEST(parallel_variadic, results_are_moved_and_referenced) {
+    const std::string s = "xyz";
+    std::unique_ptr<int> p{new int(7)};
+    int* raw = p.get();
+
+    auto check = [&](std::unique_ptr<int>&& owned, const char& c) {
+        EXPECT_EQ(raw, owned.get());
+        EXPECT_EQ(&s[0], &c);
+        return true;
+    };
+    auto g = optimus::parallel_variadic<take_ownership, first_char>::apply<decltype(check)>{check};
+    EXPECT_TRUE(g(std::move(p), s));
+}
+
+TEST(parallel_variadic, rethrows) {
+    auto f = optimus::parallel_variadic<negate, throws>::apply<optimus::plus<int>>{};
+    EXPECT_THROW(f(1, 2), std::runtime_error);
+}
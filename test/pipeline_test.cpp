@@ -0,0 +1,238 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/pipeline.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+struct parse {
+    std::tuple<std::string, std::int64_t> operator()(const std::string& line) const {
+        const auto comma = line.find(',');
+        return std::make_tuple(line.substr(0, comma), std::stoll(line.substr(comma + 1)));
+    }
+};
+
+struct is_even {
+    bool operator()(std::int64_t x) const {
+        return x % 2 == 0;
+    }
+};
+
+struct sum {
+    std::int64_t total = 0;
+    std::size_t count = 0;
+
+    void operator()(std::int64_t x) {
+        total += x;
+        ++count;
+    }
+};
+
+// Counts live instances, to check that values left in a ring are
+// destroyed with it.
+struct counted {
+    static std::atomic<int> live;
+
+    explicit counted(int v) : value(v) {
+        ++live;
+    }
+
+    counted(const counted& other) : value(other.value) {
+        ++live;
+    }
+
+    ~counted() {
+        --live;
+    }
+
+    int value;
+};
+
+std::atomic<int> counted::live{0};
+
+struct throw_at {
+    int at;
+
+    int operator()(int x) const {
+        if (x == at) {
+            throw std::runtime_error("at");
+        }
+        return x;
+    }
+};
+
+struct collect {
+    std::vector<int> values;
+
+    void operator()(int x) {
+        values.push_back(x);
+    }
+};
+
+} // namespace
+
+TEST(spsc_ring, fifo_across_threads) {
+    optimus::spsc_ring<std::unique_ptr<std::size_t>> ring{100};
+    EXPECT_EQ(128u, ring.capacity());
+    constexpr std::size_t n = 200000;
+
+    std::thread producer([&ring] {
+        for (std::size_t i = 0; i < n;) {
+            std::unique_ptr<std::size_t> batch[7];
+            for (std::size_t j = 0; j < 7; ++j) {
+                batch[j].reset(new std::size_t(i + j));
+            }
+            std::size_t pushed = 0;
+            const std::size_t count = std::min<std::size_t>(7, n - i);
+            while (pushed != count) {
+                const std::size_t more = ring.try_push(std::make_move_iterator(batch + pushed), count - pushed);
+                if (more == 0) {
+                    std::this_thread::yield();
+                }
+                pushed += more;
+            }
+            i += count;
+        }
+        ring.close();
+    });
+
+    std::size_t expected = 0;
+    bool ordered = true;
+    for (;;) {
+        const std::size_t popped = ring.try_pop(5, [&](std::unique_ptr<std::size_t>&& value) {
+            ordered = ordered && *value == expected;
+            ++expected;
+        });
+        if (popped == 0 && ring.closed() && ring.try_pop(5, [&](std::unique_ptr<std::size_t>&&) {
+                ADD_FAILURE();
+            }) == 0) {
+            break;
+        }
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(n, expected);
+}
+
+TEST(spsc_ring, destroys_what_is_left) {
+    {
+        optimus::spsc_ring<counted> ring{4};
+        const counted values[] = {counted{1}, counted{2}, counted{3}, counted{4}, counted{5}};
+        EXPECT_EQ(4u, ring.try_push(values, 5));
+        EXPECT_EQ(0u, ring.try_push(values, 1));
+        EXPECT_EQ(9, counted::live.load());
+        int first = 0;
+        EXPECT_EQ(1u, ring.try_pop(1, [&first](counted&& c) {
+            first = c.value;
+        }));
+        EXPECT_EQ(1, first);
+        EXPECT_EQ(8, counted::live.load());
+    }
+    EXPECT_EQ(0, counted::live.load());
+}
+
+TEST(pipeline, parse_project_filter_aggregate) {
+    std::vector<std::string> lines;
+    std::int64_t expected = 0;
+    std::size_t expected_count = 0;
+    for (std::int64_t i = 0; i < 100000; ++i) {
+        lines.push_back("key" + std::to_string(i % 7) + "," + std::to_string(i));
+        if (i % 2 == 0) {
+            expected += i;
+            ++expected_count;
+        }
+    }
+
+    optimus::pipeline_options options;
+    options.capacity = 256;
+    options.batch = 32;
+    optimus::pipeline<std::string, parse, optimus::get<1>, optimus::keep_if<is_even>, sum> p{
+        options, parse{}, optimus::get<1>{}, optimus::keep_if<is_even>{}, sum{}};
+    EXPECT_TRUE(p.push(lines.begin(), lines.begin() + 500));
+    for (auto it = lines.begin() + 500; it != lines.end(); ++it) {
+        EXPECT_TRUE(p.push(*it));
+    }
+    p.close();
+    EXPECT_EQ(expected, p.stage<3>().total);
+    EXPECT_EQ(expected_count, p.stage<3>().count);
+}
+
+TEST(pipeline, backpressure_keeps_order) {
+    // Rings of one value and batches of one: every push waits on every stage.
+    optimus::pipeline_options options;
+    options.capacity = 1;
+    options.batch = 1;
+    options.pin = true;
+    optimus::pipeline<int, optimus::id, collect> p{options, optimus::id{}, collect{}};
+    for (int i = 0; i < 10000; ++i) {
+        p.push(i);
+    }
+    p.close();
+    std::vector<int> expected(10000);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(expected, p.stage<1>().values);
+}
+
+struct add_to {
+    explicit add_to(int by) : by(by) { }
+
+    int operator()(int x) const {
+        return x + by;
+    }
+
+    int by;
+};
+
+TEST(pipeline, default_constructed_stages) {
+    optimus::pipeline<int, optimus::id, collect> p;
+    for (int i = 0; i < 100; ++i) {
+        p.push(i);
+    }
+    p.close();
+    EXPECT_EQ(100u, p.stage<1>().values.size());
+    EXPECT_EQ(99, p.stage<1>().values.back());
+    static_assert(!std::is_default_constructible<optimus::pipeline<int, add_to, collect>>::value,
+                  "add_to needs an argument");
+}
+
+TEST(pipeline, empty_and_unclosed) {
+    {
+        optimus::pipeline<int, collect> p{collect{}};
+        p.close();
+        EXPECT_TRUE(p.stage<0>().values.empty());
+    }
+    {
+        // Closed by the destructor.
+        optimus::pipeline<int, optimus::id, collect> p{optimus::id{}, collect{}};
+        p.push(1);
+    }
+}
+
+TEST(pipeline, rethrows) {
+    optimus::pipeline_options options;
+    options.capacity = 16;
+    optimus::pipeline<int, throw_at, collect> p{options, throw_at{100}, collect{}};
+    bool accepted = true;
+    for (int i = 0; i < 100000 && accepted; ++i) {
+        accepted = p.push(i);
+    }
+    EXPECT_THROW(p.close(), std::runtime_error);
+    for (std::size_t i = 0; i < p.stage<1>().values.size(); ++i) {
+        EXPECT_EQ(int(i), p.stage<1>().values[i]);
+    }
+    EXPECT_LE(p.stage<1>().values.size(), 100u);
+}
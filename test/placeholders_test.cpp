@@ -0,0 +1,137 @@
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/placeholders.h>
+#include <optimus/transformers.h>
+
+#define EXPECT_SAME_TYPE(T, U) \
+    EXPECT_TRUE((std::is_same<T, U>::value))
+
+#define EXPECT_SAME_TYPE_AS(T, Value) \
+    EXPECT_SAME_TYPE(T, decltype(Value))
+
+using namespace optimus::placeholders;
+
+struct inplace {
+    inplace() { }
+    inplace(const inplace&) {
+        EXPECT_TRUE(false);
+    }
+    inplace(inplace&&) {
+        EXPECT_TRUE(false);
+    }
+};
+
+TEST(placeholder, selects_argument) {
+    EXPECT_EQ(1, _1(1, 2, 3));
+    EXPECT_EQ(2, _2(1, 2, 3));
+    EXPECT_EQ(3, _3(1, 2, 3));
+    EXPECT_EQ(std::string{"b"}, _2(1, std::string{"b"}));
+}
+
+TEST(placeholder, forwarding) {
+    const inplace ci{};
+    inplace i{};
+    EXPECT_SAME_TYPE_AS(const inplace&, _1(ci, i));
+    EXPECT_SAME_TYPE_AS(inplace&, _2(ci, i));
+    EXPECT_SAME_TYPE_AS(inplace&&, _1(inplace{}));
+}
+
+TEST(placeholder, constexpr) {
+    EXPECT_EQ(7, (std::integral_constant<int, _2(5, 7)>::value));
+}
+
+TEST(expression, arithmetic) {
+    const auto fma = _1 * _2 + _3;
+    EXPECT_EQ(11, fma(2, 4, 3));
+    EXPECT_EQ(2.5 * 4.0 + 0.5, fma(2.5, 4.0, 0.5));
+    EXPECT_EQ(-3, (-_1)(3));
+    EXPECT_EQ(1, (_1 % 3)(7));
+    EXPECT_EQ(3, (10 / _1)(3));
+    EXPECT_EQ(5, (_1 - _1)(4) + 5);
+}
+
+TEST(expression, uses_optimus_operators) {
+    using product = optimus::binary_expression<
+        optimus::multiplies, optimus::placeholder<0>, optimus::placeholder<1>>;
+    EXPECT_SAME_TYPE_AS(product, (_1 * _2));
+
+    using not_less = optimus::unary_expression<
+        optimus::logical_not,
+        optimus::binary_expression<optimus::less, optimus::placeholder<0>, optimus::constant<int>>>;
+    EXPECT_SAME_TYPE_AS(not_less, (!(_1 < 3)));
+
+    using equal_to_4 = optimus::binary_expression<
+        optimus::equal_to,
+        optimus::placeholder<0>,
+        optimus::constant<std::integral_constant<int, 4>>>;
+    EXPECT_SAME_TYPE_AS(equal_to_4, (_1 == std::integral_constant<int, 4>{}));
+}
+
+TEST(expression, logical) {
+    const int c = 10;
+    const auto pred = (_1 < c) && (_2 != 0);
+    EXPECT_TRUE(pred(5, 1));
+    EXPECT_FALSE(pred(5, 0));
+    EXPECT_FALSE(pred(10, 1));
+    EXPECT_TRUE(((_1 == 1) || !_2)(0, false));
+    EXPECT_EQ(0x6, ((_1 & 0xE) ^ (_2 | 0x8))(0xF, 0x8));
+}
+
+TEST(expression, strings) {
+    EXPECT_EQ(std::string{"hello world"}, (_1 + std::string{" "} + _2)(std::string{"hello"}, std::string{"world"}));
+    EXPECT_TRUE((_1 < _2)(std::string{"a"}, std::string{"b"}));
+}
+
+TEST(expression, captures_strings_by_reference) {
+    using equal_to_string = optimus::binary_expression<
+        optimus::equal_to, optimus::placeholder<0>, optimus::constant_ref<std::string>>;
+    auto eq = _1 == std::string(1000, 'x');
+    EXPECT_SAME_TYPE_AS(equal_to_string, eq);
+    EXPECT_EQ(&eq.rhs_(), &eq.rhs_(std::string()));
+    EXPECT_TRUE(eq(std::string(1000, 'x')));
+    EXPECT_FALSE(eq(std::string(999, 'x')));
+}
+
+TEST(expression, constexpr) {
+    constexpr auto fn = (_1 * _2 + _3) * 2;
+    EXPECT_EQ(22, (std::integral_constant<int, fn(2, 4, 3)>::value));
+    constexpr auto pred = (_1 < 5) && (_2 != 0);
+    EXPECT_EQ(true, (std::integral_constant<bool, pred(4, 1)>::value));
+    EXPECT_EQ(false, (std::integral_constant<bool, pred(5, 1)>::value));
+}
+
+TEST(expression, with_transformers) {
+    using less = typename std::decay<decltype(_1 < _2)>::type;
+    auto fn = optimus::snd::apply<less>{};
+    EXPECT_TRUE(fn(std::make_tuple(9, 1), std::make_tuple(0, 2)));
+    EXPECT_FALSE(fn(std::make_tuple(0, 2), std::make_tuple(9, 1)));
+
+    using sum = typename std::decay<decltype(_1 + _2)>::type;
+    constexpr auto flipped = optimus::flip::apply<sum>{};
+    EXPECT_EQ(3, (std::integral_constant<int, flipped(1, 2)>::value));
+}
+
+TEST(expression, noexcept) {
+    using less = decltype(_1 < _2);
+    using fma = decltype(_1 * _2 + 3);
+    using concat = decltype(_1 + _2);
+    static_assert(noexcept(_1(1, 2)), "selecting an argument cannot throw");
+    static_assert(noexcept(std::declval<const less&>()(1, 2)), "builtin comparisons cannot throw");
+    static_assert(noexcept(std::declval<const fma&>()(1, 2)), "");
+    static_assert(noexcept(std::declval<const decltype(-_1)&>()(1)), "");
+    static_assert(!noexcept(std::declval<const concat&>()(std::string(), std::string())),
+                  "string concatenation allocates");
+    static_assert(std::is_nothrow_copy_constructible<less>::value, "");
+    static_assert(std::is_nothrow_move_constructible<decltype(_1 < 5)>::value, "");
+    EXPECT_TRUE((_1 < _2)(1, 2));
+}
+
+#undef EXPECT_SAME_TYPE
+#undef EXPECT_SAME_TYPE_AS
@@ -0,0 +1,179 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/mapped_file.h>
+#include <optimus/record.h>
+#include <optimus/tuple.h>
+
+namespace {
+
+struct reference_record {
+    char a;
+    double b;
+    std::int16_t c;
+};
+
+// Copies a serialized file into a buffer aligned like an mmap'd region.
+std::vector<std::uint64_t> aligned_buffer(const std::string& bytes) {
+    std::vector<std::uint64_t> buffer((bytes.size() + 7) / 8);
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+} // namespace
+
+TEST(record_layout, matches_struct) {
+    using layout = optimus::record_layout<char, double, std::int16_t>;
+    EXPECT_EQ(offsetof(reference_record, a), layout::offset<0>());
+    EXPECT_EQ(offsetof(reference_record, b), layout::offset<1>());
+    EXPECT_EQ(offsetof(reference_record, c), layout::offset<2>());
+    EXPECT_EQ(sizeof(reference_record), layout::size);
+    EXPECT_EQ(alignof(reference_record), layout::alignment);
+}
+
+TEST(record_layout, schema) {
+    EXPECT_EQ((optimus::record_layout<int, double>::schema),
+              (optimus::record_layout<int, double>::schema));
+    EXPECT_NE((optimus::record_layout<int, double>::schema),
+              (optimus::record_layout<double, int>::schema));
+    EXPECT_NE((optimus::record_layout<std::int32_t>::schema),
+              (optimus::record_layout<std::uint32_t>::schema));
+    EXPECT_NE((optimus::record_layout<std::int32_t>::schema),
+              (optimus::record_layout<float>::schema));
+}
+
+TEST(record_file_view, round_trip) {
+    std::vector<optimus::tuple<int, double, char>> records;
+    for (int i = 0; i < 100000; ++i) {
+        records.push_back(optimus::make_tuple(i, i * 0.5, char('a' + i % 26)));
+    }
+    std::ostringstream out;
+    ASSERT_TRUE((optimus::write_record_file<int, double, char>(out, records.begin(), records.end())));
+    const auto buffer = aligned_buffer(out.str());
+
+    optimus::record_file_view<int, double, char> view{buffer.data(), out.str().size()};
+    ASSERT_TRUE(view.valid());
+    ASSERT_EQ(records.size(), view.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(optimus::get<0>(records[i]), view[i].get<0>());
+        EXPECT_EQ(optimus::get<1>(records[i]), view[i].get<1>());
+        EXPECT_EQ(optimus::get<2>(records[i]), view[i].get<2>());
+    }
+}
+
+TEST(record_file_view, in_place) {
+    const std::vector<std::tuple<std::uint64_t, float>> records{
+        std::make_tuple(1, 1.5f), std::make_tuple(2, 2.5f), std::make_tuple(3, 3.5f)};
+    std::ostringstream out;
+    ASSERT_TRUE((optimus::write_record_file<std::uint64_t, float>(out, records.begin(), records.end())));
+    const auto buffer = aligned_buffer(out.str());
+
+    optimus::record_file_view<std::uint64_t, float> view{buffer.data(), out.str().size()};
+    ASSERT_TRUE(view.valid());
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(buffer.data());
+    EXPECT_EQ(base + sizeof(optimus::record_file_header),
+              reinterpret_cast<const unsigned char*>(&view[0].get<0>()));
+    EXPECT_EQ(&view[0].get<0>() + 2, &view[1].get<0>());
+}
+
+TEST(record_file_view, iterators) {
+    const std::vector<std::tuple<int, int>> records{
+        std::make_tuple(1, 10), std::make_tuple(2, 20), std::make_tuple(3, 30)};
+    std::ostringstream out;
+    optimus::write_record_file<int, int>(out, records.begin(), records.end());
+    const auto buffer = aligned_buffer(out.str());
+
+    optimus::record_file_view<int, int> view{buffer.data(), out.str().size()};
+    ASSERT_EQ(3, view.end() - view.begin());
+    int sum = 0;
+    for (auto record : view) {
+        sum += record.get<0>() * record.get<1>();
+    }
+    EXPECT_EQ(140, sum);
+    EXPECT_EQ(30, view.begin()[2].get<1>());
+    EXPECT_EQ(20, (*(view.end() - 2)).get<1>());
+}
+
+TEST(record_file_view, empty) {
+    const std::vector<std::tuple<int>> records;
+    std::ostringstream out;
+    optimus::write_record_file<int>(out, records.begin(), records.end());
+    const auto buffer = aligned_buffer(out.str());
+
+    optimus::record_file_view<int> view{buffer.data(), out.str().size()};
+    EXPECT_TRUE(view.valid());
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(view.begin(), view.end());
+}
+
+TEST(record_file_view, rejects_invalid) {
+    const std::vector<std::tuple<int, double>> records{std::make_tuple(1, 1.0), std::make_tuple(2, 2.0)};
+    std::ostringstream out;
+    optimus::write_record_file<int, double>(out, records.begin(), records.end());
+    const std::string bytes = out.str();
+    auto buffer = aligned_buffer(bytes);
+
+    EXPECT_TRUE((optimus::record_file_view<int, double>{buffer.data(), bytes.size()}.valid()));
+    // Truncated.
+    EXPECT_FALSE((optimus::record_file_view<int, double>{buffer.data(), bytes.size() - 1}.valid()));
+    EXPECT_FALSE((optimus::record_file_view<int, double>{buffer.data(), 10}.valid()));
+    EXPECT_FALSE((optimus::record_file_view<int, double>{nullptr, 0}.valid()));
+    // Another record type.
+    EXPECT_FALSE((optimus::record_file_view<double, int>{buffer.data(), bytes.size()}.valid()));
+    EXPECT_FALSE((optimus::record_file_view<int, float>{buffer.data(), bytes.size()}.valid()));
+    EXPECT_EQ(0u, (optimus::record_file_view<double, int>{buffer.data(), bytes.size()}.size()));
+    // Another version.
+    auto* header = reinterpret_cast<optimus::record_file_header*>(buffer.data());
+    header->version = 2;
+    EXPECT_FALSE((optimus::record_file_view<int, double>{buffer.data(), bytes.size()}.valid()));
+    header->version = optimus::record_file_header::current_version;
+    // Another byte order.
+    header->byte_order = 0x04030201;
+    EXPECT_FALSE((optimus::record_file_view<int, double>{buffer.data(), bytes.size()}.valid()));
+    header->byte_order = optimus::record_file_header::native_byte_order;
+    // A record count which overflows the buffer.
+    header->record_count = UINT64_MAX / 8;
+    EXPECT_FALSE((optimus::record_file_view<int, double>{buffer.data(), bytes.size()}.valid()));
+}
+
+TEST(mapped_file, record_file) {
+    char path[] = "/tmp/optimus_record_test_XXXXXX";
+    const int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    std::vector<optimus::tuple<std::int64_t, std::int8_t>> records;
+    for (int i = 0; i < 5000; ++i) {
+        records.push_back(optimus::make_tuple(std::int64_t(i) << 32, std::int8_t(-i)));
+    }
+    {
+        std::ofstream out(path, std::ios::binary);
+        ASSERT_TRUE((optimus::write_record_file<std::int64_t, std::int8_t>(out, records.begin(), records.end())));
+    }
+
+    optimus::mapped_file file{path};
+    ASSERT_TRUE(file.valid());
+    file.advise_sequential();
+    optimus::record_file_view<std::int64_t, std::int8_t> view{file.data(), file.size()};
+    ASSERT_TRUE(view.valid());
+    ASSERT_EQ(records.size(), view.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(optimus::get<0>(records[i]), view[i].get<0>());
+        EXPECT_EQ(optimus::get<1>(records[i]), view[i].get<1>());
+    }
+
+    optimus::mapped_file moved{std::move(file)};
+    EXPECT_FALSE(file.valid());
+    EXPECT_TRUE(moved.valid());
+    std::remove(path);
+
+    EXPECT_FALSE(optimus::mapped_file{"/nonexistent/optimus_record_test"}.valid());
+}
@@ -0,0 +1,147 @@
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/parallel.h>
+#include <optimus/scan.h>
+
+namespace {
+
+// x -> a * x + b, composed first then second: not commutative.
+struct affine {
+    std::uint64_t a;
+    std::uint64_t b;
+};
+
+struct compose_affine {
+    affine operator()(const affine& first, const affine& second) const {
+        return affine{second.a * first.a, second.a * first.b + second.b};
+    }
+};
+
+// Signed values are kept small enough that summing a few thousand of them
+// cannot overflow, which unlike unsigned wrap around is undefined.
+template <typename T>
+std::vector<T> random_values(std::size_t n, std::uint32_t seed) {
+    std::mt19937_64 random(seed);
+    std::vector<T> values(n);
+    const std::int64_t bound = std::int64_t(std::numeric_limits<T>::max() / 4096);
+    for (auto& value : values) {
+        value = std::is_signed<T>::value
+            ? static_cast<T>(std::int64_t(random() % std::uint64_t(2 * bound + 1)) - bound)
+            : static_cast<T>(random());
+    }
+    return values;
+}
+
+template <typename T, typename Op>
+std::vector<T> reference_inclusive(const std::vector<T>& values, Op op) {
+    std::vector<T> result(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        result[i] = i == 0 ? values[0] : op(result[i - 1], values[i]);
+    }
+    return result;
+}
+
+template <typename T, typename Op>
+void check_serial(Op op) {
+    for (std::size_t n : {0, 1, 2, 3, 4, 5, 7, 8, 9, 31, 1000}) {
+        const std::vector<T> values = random_values<T>(n, std::uint32_t(n));
+        const std::vector<T> expected = reference_inclusive(values, op);
+        std::vector<T> out(n);
+        EXPECT_EQ(out.data() + n, optimus::inclusive_scan(values.data(), values.data() + n, out.data(), op));
+        EXPECT_EQ(expected, out) << n;
+
+        std::vector<T> exclusive(n);
+        optimus::exclusive_scan(values.data(), values.data() + n, exclusive.data(), T(5), op);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(i == 0 ? T(5) : op(T(5), expected[i - 1]), exclusive[i]) << n << " " << i;
+        }
+    }
+}
+
+} // namespace
+
+TEST(scan, plus) {
+    check_serial<std::int32_t>(optimus::plus<std::int32_t>{});
+    check_serial<std::uint32_t>(optimus::plus<std::uint32_t>{});
+    check_serial<std::int64_t>(optimus::plus<std::int64_t>{});
+    check_serial<std::uint64_t>(optimus::plus<std::uint64_t>{});
+    check_serial<std::uint16_t>(optimus::plus<std::uint16_t>{});
+}
+
+TEST(scan, bit_xor) {
+    check_serial<std::uint32_t>(optimus::bit_xor<std::uint32_t>{});
+    check_serial<std::uint64_t>(optimus::bit_xor<std::uint64_t>{});
+}
+
+TEST(scan, other_operations) {
+    check_serial<std::uint32_t>(optimus::bit_or<std::uint32_t>{});
+    check_serial<std::uint64_t>(optimus::multiplies<std::uint64_t>{});
+}
+
+TEST(scan, default_plus) {
+    const std::vector<std::int64_t> values{1, 2, 3, 4, 5};
+    std::vector<std::int64_t> out(values.size());
+    optimus::inclusive_scan(values.data(), values.data() + values.size(), out.data());
+    EXPECT_EQ((std::vector<std::int64_t>{1, 3, 6, 10, 15}), out);
+    optimus::exclusive_scan(values.data(), values.data() + values.size(), out.data(), 0);
+    EXPECT_EQ((std::vector<std::int64_t>{0, 1, 3, 6, 10}), out);
+}
+
+TEST(scan, in_place) {
+    std::vector<std::uint32_t> values = random_values<std::uint32_t>(1001, 3);
+    const std::vector<std::uint32_t> expected = reference_inclusive(values, optimus::plus<std::uint32_t>{});
+    optimus::inclusive_scan(values.data(), values.data() + values.size(), values.data());
+    EXPECT_EQ(expected, values);
+}
+
+TEST(scan, parallel) {
+    optimus::work_stealing_pool pool{3};
+    const std::size_t n = optimus::scan_parallel_min + 12345;
+    const std::vector<std::uint64_t> values = random_values<std::uint64_t>(n, 5);
+    const std::vector<std::uint64_t> expected = reference_inclusive(values, optimus::plus<std::uint64_t>{});
+
+    std::vector<std::uint64_t> out(n);
+    optimus::inclusive_scan(pool, values.data(), values.data() + n, out.data());
+    EXPECT_EQ(expected, out);
+
+    optimus::exclusive_scan(pool, values.data(), values.data() + n, out.data(), 7);
+    EXPECT_EQ(7u, out[0]);
+    for (std::size_t i = 1; i < n; ++i) {
+        ASSERT_EQ(7 + expected[i - 1], out[i]) << i;
+    }
+
+    std::vector<std::uint64_t> in_place = values;
+    optimus::inclusive_scan(pool, in_place.data(), in_place.data() + n, in_place.data());
+    EXPECT_EQ(expected, in_place);
+}
+
+TEST(scan, parallel_keeps_order) {
+    optimus::work_stealing_pool pool{3};
+    const std::size_t n = optimus::scan_parallel_min + 777;
+    std::vector<affine> values(n);
+    std::mt19937_64 random(9);
+    for (auto& value : values) {
+        value = affine{random() | 1, random()};
+    }
+    const std::vector<affine> expected = reference_inclusive(values, compose_affine{});
+
+    std::vector<affine> out(n);
+    optimus::inclusive_scan(pool, values.data(), values.data() + n, out.data(), compose_affine{});
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(expected[i].a, out[i].a) << i;
+        ASSERT_EQ(expected[i].b, out[i].b) << i;
+    }
+
+    optimus::exclusive_scan(pool, values.data(), values.data() + n, out.data(), affine{1, 0}, compose_affine{});
+    for (std::size_t i = 1; i < n; ++i) {
+        ASSERT_EQ(expected[i - 1].a, out[i].a) << i;
+        ASSERT_EQ(expected[i - 1].b, out[i].b) << i;
+    }
+}
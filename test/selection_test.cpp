@@ -0,0 +1,123 @@
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/placeholders.h>
+#include <optimus/selection.h>
+
+using namespace optimus::placeholders;
+
+namespace {
+
+std::vector<std::int32_t> random_values(std::size_t n) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<std::int32_t> value(0, 99);
+    std::vector<std::int32_t> values(n);
+    for (auto& v : values) {
+        v = value(gen);
+    }
+    return values;
+}
+
+} // namespace
+
+TEST(all_of_pred, scalar) {
+    constexpr auto in_range = optimus::make_all_of_pred(_1 >= 10, _1 < 20);
+    static_assert(in_range(15), "");
+    static_assert(!in_range(20), "");
+    EXPECT_TRUE(in_range(10));
+    EXPECT_FALSE(in_range(9));
+
+    constexpr auto always = optimus::all_of_pred<>{};
+    static_assert(always(1), "");
+}
+
+TEST(any_of_pred, scalar) {
+    constexpr auto outside = optimus::make_any_of_pred(_1 < 10, _1 >= 20);
+    static_assert(outside(5), "");
+    static_assert(!outside(15), "");
+    EXPECT_TRUE(outside(25));
+
+    constexpr auto never = optimus::any_of_pred<>{};
+    static_assert(!never(1), "");
+
+    // Combinators nest, and take any predicate over the same arguments.
+    const auto nested = optimus::make_any_of_pred(optimus::make_all_of_pred(_1 > 2, _1 < 4), _1 == 9);
+    EXPECT_TRUE(nested(3));
+    EXPECT_TRUE(nested(9));
+    EXPECT_FALSE(nested(4));
+}
+
+TEST(predicate_selector, matches_scalar) {
+    // Sizes around a block and a word, to cover partial blocks and words.
+    for (std::size_t n : {0u, 1u, 63u, 64u, 65u, 1000u, 1024u, 1025u, 50000u}) {
+        const std::vector<std::int32_t> values = random_values(n);
+        auto all = optimus::make_selector(optimus::make_all_of_pred(_1 % 2 == 0, _1 < 90, _1 > 5));
+        auto any = optimus::make_selector(optimus::make_any_of_pred(_1 % 7 == 0, _1 > 95, _1 < 3));
+
+        std::vector<std::uint32_t> all_expected;
+        std::vector<std::uint32_t> any_expected;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (all.predicate()(values[i])) {
+                all_expected.push_back(std::uint32_t(i));
+            }
+            if (any.predicate()(values[i])) {
+                any_expected.push_back(std::uint32_t(i));
+            }
+        }
+
+        std::vector<std::uint32_t> selected(n);
+        selected.erase(all.select(values.begin(), values.end(), selected.data()) - selected.data()
+                       + selected.begin(), selected.end());
+        EXPECT_EQ(all_expected, selected) << n;
+
+        selected.resize(n);
+        selected.erase(any.select(values.begin(), values.end(), selected.data()) - selected.data()
+                       + selected.begin(), selected.end());
+        EXPECT_EQ(any_expected, selected) << n;
+
+        std::vector<std::uint64_t> words((n + 63) / 64 + 1, ~std::uint64_t(0));
+        EXPECT_EQ(words.data() + (n + 63) / 64, all.mask(values.begin(), values.end(), words.data()));
+        for (std::size_t i = 0; i < words.size() * 64; ++i) {
+            const bool bit = (words[i / 64] >> (i % 64)) & 1;
+            if (i < n) {
+                EXPECT_EQ(all.predicate()(values[i]), bit) << n << " " << i;
+            } else if (i / 64 < (n + 63) / 64) {
+                EXPECT_FALSE(bit) << n << " " << i;
+            }
+        }
+        EXPECT_EQ(~std::uint64_t(0), words.back());
+    }
+}
+
+TEST(predicate_selector, reorders_by_selectivity) {
+    const std::vector<std::int32_t> values = random_values(100000);
+
+    // _1 < 95 passes 95% of rows and _1 < 5 5%, so all_of should test
+    // _1 < 5 first and any_of _1 < 95.
+    auto all = optimus::make_selector(optimus::make_all_of_pred(_1 < 95, _1 < 50, _1 < 5));
+    std::vector<std::uint32_t> selected(values.size());
+    all.select(values.begin(), values.end(), selected.data());
+    EXPECT_EQ(2u, all.order()[0]);
+
+    auto any = optimus::make_selector(optimus::make_any_of_pred(_1 < 5, _1 < 50, _1 < 95));
+    any.select(values.begin(), values.end(), selected.data());
+    EXPECT_EQ(2u, any.order()[0]);
+}
+
+TEST(predicate_selector, rows) {
+    using row = std::tuple<std::int32_t, double>;
+    const std::vector<row> rows = {row{1, 0.5}, row{2, 2.5}, row{3, 1.5}, row{4, 3.0}};
+    auto heavy_even = optimus::make_selector(optimus::make_all_of_pred(
+            [](const row& r) { return std::get<0>(r) % 2 == 0; },
+            [](const row& r) { return std::get<1>(r) > 1.0; }));
+    std::size_t selected[4];
+    const std::size_t* end = heavy_even.select(rows.begin(), rows.end(), selected);
+    ASSERT_EQ(2, end - selected);
+    EXPECT_EQ(1u, selected[0]);
+    EXPECT_EQ(3u, selected[1]);
+}
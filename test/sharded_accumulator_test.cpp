@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/sharded_accumulator.h>
+
+namespace {
+
+struct max_op {
+    std::int64_t operator()(std::int64_t a, std::int64_t b) const {
+        return a < b ? b : a;
+    }
+};
+
+template <typename Accumulator, typename Fn>
+void add_from_threads(Accumulator& accumulator, std::size_t threads, std::size_t per_thread, Fn value) {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&accumulator, t, per_thread, value] {
+            for (std::size_t i = 0; i < per_thread; ++i) {
+                accumulator.add(value(t, i));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace
+
+TEST(sharded_accumulator, counter) {
+    optimus::sharded_accumulator<std::uint64_t, optimus::plus<std::uint64_t>> counter{16};
+    EXPECT_EQ(16u, counter.shards());
+    EXPECT_EQ(0u, counter.read());
+    counter.add(5);
+    counter.add(7);
+    EXPECT_EQ(12u, counter.read());
+
+    add_from_threads(counter, 8, 100000, [](std::size_t, std::size_t) {
+        return std::uint64_t(1);
+    });
+    EXPECT_EQ(800012u, counter.read());
+}
+
+TEST(sharded_accumulator, bitmask) {
+    optimus::sharded_accumulator<std::uint64_t, optimus::bit_or<std::uint64_t>> flags;
+    add_from_threads(flags, 4, 1000, [](std::size_t t, std::size_t i) {
+        return std::uint64_t(1) << ((t * 16 + i) % 64);
+    });
+    EXPECT_EQ(~std::uint64_t(0), flags.read());
+
+    optimus::sharded_accumulator<std::uint32_t, optimus::bit_and<std::uint32_t>> common;
+    EXPECT_EQ(0xffffffffu, common.read());
+    common.add(0xf0f0);
+    common.add(0xff00);
+    EXPECT_EQ(0xf000u, common.read());
+}
+
+TEST(sharded_accumulator, more_threads_than_shards) {
+    // Threads past the second share the overflow shard.
+    optimus::sharded_accumulator<std::uint64_t, optimus::plus<std::uint64_t>> counter{2};
+    add_from_threads(counter, 6, 50000, [](std::size_t, std::size_t) {
+        return std::uint64_t(2);
+    });
+    EXPECT_EQ(600000u, counter.read());
+}
+
+TEST(sharded_accumulator, explicit_identity) {
+    optimus::sharded_accumulator<std::int64_t, max_op> maximum{4, INT64_MIN};
+    EXPECT_EQ(INT64_MIN, maximum.read());
+    add_from_threads(maximum, 3, 1000, [](std::size_t t, std::size_t i) {
+        return std::int64_t(t * 1000 + i) - 5000;
+    });
+    EXPECT_EQ(-2001, maximum.read());
+}
+
+TEST(sharded_accumulator, many_accumulators_per_thread) {
+    // More accumulators than a thread remembers shards for, used in turn.
+    std::vector<std::unique_ptr<optimus::sharded_accumulator<int, optimus::plus<int>>>> counters;
+    for (std::size_t i = 0; i < 3 * optimus::shard_cache_size; ++i) {
+        counters.emplace_back(new optimus::sharded_accumulator<int, optimus::plus<int>>{64});
+    }
+    for (int round = 0; round < 10; ++round) {
+        for (auto& counter : counters) {
+            counter->add(1);
+        }
+    }
+    for (auto& counter : counters) {
+        EXPECT_EQ(10, counter->read());
+        // The thread found its shard again each round.
+        EXPECT_EQ(1u, counter->claimed_shards());
+    }
+}
+
+TEST(sharded_accumulator, colliding_ids) {
+    // Accumulators made shard_cache_size apart share a home cache slot.
+    std::vector<std::unique_ptr<optimus::sharded_accumulator<int, optimus::plus<int>>>> counters;
+    for (std::size_t i = 0; i <= optimus::shard_cache_size; ++i) {
+        counters.emplace_back(new optimus::sharded_accumulator<int, optimus::plus<int>>{2});
+    }
+    auto& first = *counters.front();
+    auto& last = *counters.back();
+    for (int i = 0; i < 1000; ++i) {
+        first.add(1);
+        last.add(2);
+    }
+    EXPECT_EQ(1000, first.read());
+    EXPECT_EQ(2000, last.read());
+    EXPECT_EQ(1u, first.claimed_shards());
+    EXPECT_EQ(1u, last.claimed_shards());
+}
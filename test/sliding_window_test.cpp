@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/sliding_window.h>
+
+namespace {
+
+struct max_op {
+    std::int64_t operator()(std::int64_t a, std::int64_t b) const {
+        return a < b ? b : a;
+    }
+};
+
+struct concat_op {
+    std::string operator()(const std::string& a, const std::string& b) const {
+        return a + b;
+    }
+};
+
+template <typename T, typename Op>
+T fold(const std::deque<T>& values, Op op) {
+    T result = values.front();
+    for (std::size_t i = 1; i < values.size(); ++i) {
+        result = op(result, values[i]);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(sliding_window, push_and_evict) {
+    optimus::sliding_window<std::int64_t, optimus::plus<std::int64_t>> window;
+    EXPECT_TRUE(window.empty());
+    window.push(1);
+    window.push(2);
+    window.push(3);
+    EXPECT_EQ(3u, window.size());
+    EXPECT_EQ(6, window.query());
+    window.evict();
+    EXPECT_EQ(5, window.query());
+    window.push(10);
+    EXPECT_EQ(15, window.query());
+    window.evict();
+    window.evict();
+    EXPECT_EQ(10, window.query());
+    window.evict();
+    EXPECT_TRUE(window.empty());
+    window.push(4);
+    EXPECT_EQ(4, window.query());
+    window.clear();
+    EXPECT_TRUE(window.empty());
+}
+
+TEST(sliding_window, keeps_order) {
+    optimus::sliding_window<std::string, concat_op> window;
+    std::deque<std::string> expected;
+    std::mt19937 random(7);
+    for (int i = 0; i < 2000; ++i) {
+        if (expected.empty() || random() % 3 != 0) {
+            const std::string value(1, static_cast<char>('a' + i % 26));
+            window.push(value);
+            expected.push_back(value);
+        } else {
+            window.evict();
+            expected.pop_front();
+        }
+        ASSERT_EQ(expected.size(), window.size());
+        if (!expected.empty()) {
+            ASSERT_EQ(fold(expected, concat_op{}), window.query());
+        }
+    }
+}
+
+TEST(count_window, maximum) {
+    optimus::count_window<std::int64_t, max_op> window{5};
+    EXPECT_EQ(5u, window.capacity());
+    std::deque<std::int64_t> expected;
+    std::mt19937 random(11);
+    for (int i = 0; i < 1000; ++i) {
+        const std::int64_t value = static_cast<std::int64_t>(random() % 1000);
+        window.push(value);
+        expected.push_back(value);
+        if (expected.size() > 5) {
+            expected.pop_front();
+        }
+        ASSERT_EQ(expected.size(), window.size());
+        ASSERT_EQ(fold(expected, max_op{}), window.query());
+    }
+}
+
+TEST(time_window, numeric_times) {
+    optimus::time_window<std::uint64_t, optimus::bit_or<std::uint64_t>, std::int64_t> window{10};
+    EXPECT_EQ(10, window.span());
+    window.push(0, 1);
+    window.push(5, 2);
+    window.push(9, 4);
+    EXPECT_EQ(7u, window.query());
+    window.push(10, 8);
+    EXPECT_EQ(3u, window.size());
+    EXPECT_EQ(14u, window.query());
+    window.advance(19);
+    EXPECT_EQ(1u, window.size());
+    EXPECT_EQ(8u, window.query());
+    window.advance(20);
+    EXPECT_TRUE(window.empty());
+}
+
+TEST(time_window, chrono_times) {
+    using clock = std::chrono::steady_clock;
+    optimus::time_window<std::int64_t, optimus::plus<std::int64_t>> window{std::chrono::seconds(1)};
+    const clock::time_point start = clock::now();
+    for (int i = 0; i < 100; ++i) {
+        window.push(start + std::chrono::milliseconds(100 * i), i);
+    }
+    EXPECT_EQ(10u, window.size());
+    EXPECT_EQ(90 + 91 + 92 + 93 + 94 + 95 + 96 + 97 + 98 + 99, window.query());
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/sort.h>
+
+namespace {
+
+std::vector<int> random_ints(std::size_t n, int range, unsigned seed) {
+    std::mt19937 gen{seed};
+    std::vector<int> values(n);
+    for (auto& v : values) {
+        v = int(gen() % unsigned(range));
+    }
+    return values;
+}
+
+// Checks optimus::sort against std::sort, by `<` and by `>`.
+void expect_sorts_like_std(const std::vector<int>& values) {
+    auto expected = values;
+    auto actual = values;
+    std::sort(expected.begin(), expected.end());
+    optimus::sort(actual.begin(), actual.end());
+    EXPECT_EQ(expected, actual);
+
+    std::sort(expected.begin(), expected.end(), std::greater<int>{});
+    optimus::sort(actual.begin(), actual.end(), optimus::greater<int>{});
+    EXPECT_EQ(expected, actual);
+}
+
+/**
+ * McIlroy's adversary for quicksort ("A Killer Adversary for Quicksort").
+ * The items start out undecided, as `gas`, and are given values only as
+ * comparisons require, always so as to make the pivot as lopsided as
+ * possible. The values it settles on are consistent with every answer it
+ * gave, so the result can be checked against them afterwards.
+ */
+class quicksort_adversary {
+  public:
+    explicit quicksort_adversary(std::size_t n)
+        : values_(n, int(n)), gas_(int(n)), solid_(0), candidate_(0), comparisons_(0) { }
+
+    bool less(std::size_t x, std::size_t y) {
+        ++comparisons_;
+        if (values_[x] == gas_ && values_[y] == gas_) {
+            values_[x == candidate_ ? x : y] = solid_++;
+        }
+        if (values_[x] == gas_) {
+            candidate_ = x;
+        } else if (values_[y] == gas_) {
+            candidate_ = y;
+        }
+        return values_[x] < values_[y];
+    }
+
+    int value(std::size_t x) const {
+        return values_[x];
+    }
+
+    std::size_t comparisons() const {
+        return comparisons_;
+    }
+
+  private:
+    std::vector<int> values_;
+    int gas_;
+    int solid_;
+    std::size_t candidate_;
+    std::size_t comparisons_;
+};
+
+} // namespace
+
+TEST(sort, short_ranges) {
+    for (std::size_t n = 0; n <= 17; ++n) {
+        expect_sorts_like_std(random_ints(n, 1000, unsigned(n)));
+        expect_sorts_like_std(random_ints(n, 2, unsigned(n)));
+
+        std::vector<int> ascending(n);
+        std::iota(ascending.begin(), ascending.end(), 0);
+        expect_sorts_like_std(ascending);
+        expect_sorts_like_std(std::vector<int>(ascending.rbegin(), ascending.rend()));
+    }
+}
+
+TEST(sort, long_ranges) {
+    for (std::size_t n : {18u, 100u, 1000u, 100000u}) {
+        expect_sorts_like_std(random_ints(n, 1 << 30, unsigned(n)));
+    }
+
+    std::vector<int> alternating;
+    for (int i = 0; i < 5000; ++i) {
+        alternating.push_back(i % 2 == 0 ? -i : i);
+    }
+    expect_sorts_like_std(alternating);
+
+    std::vector<int> organ_pipe(5000);
+    for (int i = 0; i < 5000; ++i) {
+        organ_pipe[std::size_t(i)] = std::min(i, 4999 - i);
+    }
+    expect_sorts_like_std(organ_pipe);
+}
+
+TEST(sort, duplicates) {
+    for (int range : {1, 2, 3, 16}) {
+        expect_sorts_like_std(random_ints(100000, range, unsigned(range)));
+    }
+}
+
+TEST(sort, strings) {
+    std::vector<std::string> words;
+    for (int v : random_ints(2000, 300, 1)) {
+        words.push_back(std::to_string(v));
+    }
+    auto expected = words;
+    std::sort(expected.begin(), expected.end());
+    optimus::sort(words.begin(), words.end());
+    EXPECT_EQ(expected, words);
+}
+
+TEST(sort, heap_sort_fallback) {
+    // Against the adversary a quicksort alone makes about n^2 / 8
+    // comparisons, 50 million here; the depth limit hands the range to
+    // heap_sort after about a million.
+    const std::size_t n = 20000;
+    quicksort_adversary adversary{n};
+    std::vector<std::size_t> items(n);
+    std::iota(items.begin(), items.end(), std::size_t(0));
+    optimus::sort(items.begin(), items.end(), [&adversary](std::size_t x, std::size_t y) {
+        return adversary.less(x, y);
+    });
+
+    EXPECT_LT(adversary.comparisons(), 200 * n);
+    for (std::size_t i = 1; i < n; ++i) {
+        ASSERT_LE(adversary.value(items[i - 1]), adversary.value(items[i]));
+    }
+    std::vector<std::size_t> sorted_items = items;
+    std::sort(sorted_items.begin(), sorted_items.end());
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(i, sorted_items[i]);
+    }
+}
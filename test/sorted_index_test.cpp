@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/sorted_index.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+using row = std::tuple<std::int32_t, std::string>;
+
+std::vector<row> random_rows(std::size_t n, std::int32_t keys) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<std::int32_t> key(0, keys - 1);
+    std::vector<row> rows;
+    for (std::size_t i = 0; i < n; ++i) {
+        rows.emplace_back(key(gen), std::to_string(i));
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(sorted_index, small) {
+    const std::vector<row> rows = {row{3, "a"}, row{1, "b"}, row{3, "c"}, row{2, "d"}};
+    const auto index = optimus::index_by<optimus::get<0>>(rows);
+    EXPECT_EQ(4u, index.size());
+
+    std::vector<std::string> order;
+    for (const row& r : index) {
+        order.push_back(std::get<1>(r));
+    }
+    EXPECT_EQ((std::vector<std::string>{"b", "d", "a", "c"}), order);
+
+    const auto threes = index.equal_range(3);
+    ASSERT_EQ(2, threes.second - threes.first);
+    EXPECT_EQ(&rows[0], &*threes.first);
+    EXPECT_EQ(&rows[2], &threes.first[1]);
+    EXPECT_EQ(index.end(), threes.second);
+
+    EXPECT_EQ(&rows[3], &*index.find(2));
+    EXPECT_EQ(index.end(), index.find(0));
+    EXPECT_EQ(index.end(), index.find(4));
+    EXPECT_EQ(0u, index.count(5));
+    EXPECT_EQ(index.begin(), index.lower_bound(0));
+    EXPECT_EQ(index.end(), index.lower_bound(4));
+}
+
+TEST(sorted_index, empty) {
+    const std::vector<row> rows;
+    const auto index = optimus::index_by<optimus::get<0>>(rows);
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(index.begin(), index.end());
+    EXPECT_EQ(index.end(), index.find(1));
+    EXPECT_EQ(index.end(), index.lower_bound(1));
+    EXPECT_EQ(0u, index.count(1));
+}
+
+TEST(sorted_index, matches_binary_search) {
+    // Every size up to two full levels past a power of two, so that every
+    // shape of the last level of the tree is covered.
+    for (std::size_t n = 1; n <= 70; ++n) {
+        const std::vector<row> rows = random_rows(n, 20);
+        std::vector<std::int32_t> keys;
+        for (const row& r : rows) {
+            keys.push_back(std::get<0>(r));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        const auto index = optimus::index_by<optimus::get<0>>(rows);
+        for (std::int32_t key = -1; key <= 20; ++key) {
+            EXPECT_EQ(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin(),
+                      index.lower_bound(key) - index.begin()) << n << " " << key;
+            EXPECT_EQ(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin(),
+                      index.upper_bound(key) - index.begin()) << n << " " << key;
+        }
+    }
+}
+
+TEST(sorted_index, equal_keys_keep_row_order) {
+    const std::vector<row> rows = random_rows(10000, 100);
+    const auto index = optimus::index_by<optimus::get<0>>(rows);
+    for (std::int32_t key = 0; key < 100; ++key) {
+        const auto range = index.equal_range(key);
+        ASSERT_EQ(std::size_t(std::count_if(rows.begin(), rows.end(), [key](const row& r) {
+                      return std::get<0>(r) == key;
+                  })),
+                  index.count(key));
+        for (auto it = range.first; it != range.second; ++it) {
+            EXPECT_EQ(key, std::get<0>(*it));
+            if (it != range.first) {
+                EXPECT_LT(&it[-1], &*it);
+            }
+        }
+    }
+}
+
+TEST(sorted_index, composed_key_over_list) {
+    // Keys projected through compose, over a list rather than a vector.
+    const std::list<std::pair<row, int>> rows = {
+        {row{5, "x"}, 0}, {row{2, "y"}, 1}, {row{9, "z"}, 2}};
+    const auto index =
+            optimus::index_by<optimus::compose<optimus::get<0>, optimus::get<0>>::apply<optimus::id>>(
+                    rows.begin(), rows.end());
+    EXPECT_EQ(1, index.find(2)->second);
+    EXPECT_EQ(0, index.find(5)->second);
+    EXPECT_EQ(2, index.lower_bound(6)->second);
+    EXPECT_EQ(index.end(), index.upper_bound(9));
+}
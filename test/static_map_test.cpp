@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include <optimus/static_map.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+constexpr auto fields = optimus::make_static_keys("id", "price", "quantity", "side", "venue", "timestamp", "");
+
+constexpr auto many = optimus::make_static_keys(
+    "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8", "a9", "b0", "b1", "b2", "b3", "b4", "b5",
+    "b6", "b7", "b8", "b9", "c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8", "c9", "d0", "d1",
+    "d2", "d3", "d4", "d5", "d6", "d7", "d8", "d9", "e0", "e1", "e2", "e3", "e4", "e5", "e6", "e7",
+    "e8", "e9", "f0", "f1", "f2", "f3", "f4", "f5", "f6", "f7", "f8", "f9", "g0", "g1", "g2", "g3");
+
+constexpr optimus::static_map<int, 7> widths{fields, 8, 8, 4, 1, 2, 8, 0};
+
+static_assert(fields.size() == 7, "one index per key");
+static_assert(fields.index_of("id") == 0, "keys keep their order");
+static_assert(fields.index_of("timestamp") == 5, "keys keep their order");
+static_assert(fields.index_of("") == 6, "the empty key");
+static_assert(widths.at(fields.index_of("quantity")) == 4, "a constexpr map is read at compile time");
+static_assert(std::integral_constant<int, widths[fields.index_of("side")]>::value == 1, "a constant");
+
+} // namespace
+
+TEST(static_keys, finds_every_key) {
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        EXPECT_EQ(i, fields.find(std::string(fields.key(i), fields.key_size(i))));
+    }
+    for (std::size_t i = 0; i < many.size(); ++i) {
+        EXPECT_EQ(i, many.find(std::string(many.key(i))));
+    }
+    EXPECT_EQ(1u, fields.find("price"));
+}
+
+TEST(static_keys, misses) {
+    for (const char* key : {"ID", "pric", "prices", "sid", "x", "timestamp ", "a0"}) {
+        EXPECT_EQ(fields.size(), fields.find(std::string(key))) << key;
+    }
+    for (const char* key : {"a", "a00", "g4", "h0", "", "id"}) {
+        EXPECT_EQ(many.size(), many.find(std::string(key))) << key;
+    }
+}
+
+TEST(static_map, at_and_find) {
+    optimus::static_map<double, 7> row{fields};
+    EXPECT_EQ(0.0, row.at("price"));
+    row.at("price") = 101.5;
+    row.at(std::string("quantity")) = 3;
+    row[fields.index_of("side")] = -1;
+    EXPECT_EQ(101.5, row[1]);
+    EXPECT_EQ(3.0, row.at(2));
+    EXPECT_EQ(-1.0, row.at("side"));
+    EXPECT_EQ(&row.at("venue"), row.find("venue"));
+    EXPECT_EQ(nullptr, row.find("missing"));
+    EXPECT_EQ(1u, row.count("id"));
+    EXPECT_EQ(0u, row.count("missing"));
+    EXPECT_EQ(&fields, &row.keys());
+}
+
+TEST(static_map, at_misses) {
+    optimus::static_map<double, 7> row{fields};
+    const optimus::static_map<double, 7>& const_row = row;
+    EXPECT_THROW(row.at("missing"), std::out_of_range);
+    EXPECT_THROW(row.at(std::string("pric")), std::out_of_range);
+    EXPECT_THROW(const_row.at("prices"), std::out_of_range);
+    EXPECT_THROW(const_row.at(std::string("timestamp ")), std::out_of_range);
+    EXPECT_THROW(optimus::at<std::string>{"ID"}(row), std::out_of_range);
+}
+
+TEST(static_map, at_transformers) {
+    optimus::static_map<std::string, 7> row{fields, "17", "9.5", "100", "buy", "X", "0", "none"};
+
+    optimus::at<std::string> venue{"venue"};
+    EXPECT_EQ("X", venue(row));
+
+    optimus::at_index<fields.index_of("price")> price;
+    EXPECT_EQ("9.5", price(row));
+
+    optimus::at_index<fields.index_of("side")>::apply<optimus::equal_to<std::string>> same_side;
+    EXPECT_TRUE(same_side(row, row));
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <random>
+#include <sstream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/top_k.h>
+#include <optimus/transformers.h>
+
+namespace {
+
+std::vector<int> random_ints(std::size_t n, int range) {
+    std::mt19937 gen{unsigned(n)};
+    std::vector<int> values(n);
+    for (auto& v : values) {
+        v = int(gen() % unsigned(range));
+    }
+    return values;
+}
+
+std::vector<int> sorted_prefix(std::vector<int> values, std::size_t k) {
+    std::sort(values.begin(), values.end(), std::greater<int>{});
+    values.resize(std::min(k, values.size()));
+    return values;
+}
+
+} // namespace
+
+TEST(top_k, largest) {
+    const auto values = random_ints(100000, 1000000);
+    for (std::size_t k : {0u, 1u, 10u, 1000u, 20000u, 100000u, 200000u}) {
+        EXPECT_EQ(sorted_prefix(values, k), optimus::top_k<optimus::greater<int>>(values, k)) << k;
+    }
+}
+
+TEST(top_k, duplicates) {
+    const auto values = random_ints(10000, 5);
+    EXPECT_EQ(sorted_prefix(values, 100), optimus::top_k<optimus::greater<int>>(values, 100));
+    EXPECT_EQ(sorted_prefix(values, 5000), optimus::top_k<optimus::greater<int>>(values, 5000));
+}
+
+TEST(top_k, flip) {
+    const auto values = random_ints(5000, 100000);
+    EXPECT_EQ(sorted_prefix(values, 7),
+              optimus::top_k<optimus::flip::apply<optimus::less<int>>>(values.begin(), values.end(), 7));
+
+    auto smallest = values;
+    std::sort(smallest.begin(), smallest.end());
+    smallest.resize(7);
+    EXPECT_EQ(smallest, optimus::top_k(values, 7, optimus::less<int>{}));
+}
+
+TEST(top_k, projected) {
+    std::vector<std::tuple<std::string, int>> rows;
+    const auto scores = random_ints(1000, 100000);
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        rows.emplace_back("row" + std::to_string(i), scores[i]);
+    }
+    const auto top = optimus::top_k<optimus::get<1>::apply<optimus::greater<int>>>(rows, 5);
+    ASSERT_EQ(5u, top.size());
+    const auto expected = sorted_prefix(scores, 5);
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(expected[i], std::get<1>(top[i]));
+        EXPECT_EQ(scores[std::stoul(std::get<0>(top[i]).substr(3))], std::get<1>(top[i]));
+    }
+}
+
+TEST(top_k, forward_and_input_iterators) {
+    const auto values = random_ints(3000, 1000000);
+    const std::list<int> list(values.begin(), values.end());
+    EXPECT_EQ(sorted_prefix(values, 20), optimus::top_k<optimus::greater<int>>(list, 20));
+
+    std::stringstream stream;
+    for (int v : values) {
+        stream << v << ' ';
+    }
+    EXPECT_EQ(sorted_prefix(values, 20), optimus::top_k<optimus::greater<int>>(
+            std::istream_iterator<int>{stream}, std::istream_iterator<int>{}, 20));
+}
+
+TEST(top_k_accumulator, streaming) {
+    optimus::top_k_accumulator<int, optimus::greater<int>> top{10};
+    EXPECT_EQ(10u, top.k());
+    std::vector<int> seen;
+    std::mt19937 gen{3};
+    for (int batch = 0; batch < 100; ++batch) {
+        std::vector<int> values(std::size_t(gen() % 500));
+        for (auto& v : values) {
+            v = int(gen() % 100000);
+        }
+        if (batch % 2 == 0) {
+            top.push(values.begin(), values.end());
+        } else {
+            for (int v : values) {
+                top.push(v);
+            }
+        }
+        seen.insert(seen.end(), values.begin(), values.end());
+        EXPECT_EQ(sorted_prefix(seen, 10), top.sorted());
+    }
+    EXPECT_TRUE(top.full());
+    EXPECT_EQ(sorted_prefix(seen, 10).back(), top.threshold());
+}
@@ -1,7 +1,15 @@
 #include <algorithm>
+#include <array>
 #include <functional>
+#include <iterator>
 #include <limits>
+#include <map>
+#include <cstdint>
+#include <cstring>
 #include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
@@ -9,6 +17,13 @@
 
 #include <optimus/functional.h>
 #include <optimus/transformers.h>
+#include <optimus/parallel.h>
+#include <optimus/placeholders.h>
+
+// After transformers.h, to show that get<I> finds the accessors of the
+// tuple-like types whatever order the headers come in.
+#include <optimus/lazy_tuple.h>
+#include <optimus/record.h>
 
 #define EXPECT_SAME_TYPE(T, U) \
     EXPECT_TRUE((std::is_same<T, U>::value))
@@ -45,13 +60,41 @@ TYPED_TEST(transformer_test, constexpr_constructors) {
     constexpr typename TypeParam::template apply<optimus::constant<int>> t2{t};
 }
 
+// Checks that it is only copied or moved when the test allows it, and
+// counts every copy and move.
 struct expecter {
+    static int copies;
+    static int moves;
+
+    static void reset() {
+        copies = 0;
+        moves = 0;
+    }
+
+    expecter() : expecter(true, true) { }
     expecter(bool copyable, bool movable) : copyable(copyable), movable(movable) { }
     expecter(const expecter& o) : copyable(o.copyable), movable(o.movable) {
+        ++copies;
         EXPECT_TRUE(copyable);
     }
     expecter(expecter&& o) : copyable(o.copyable), movable(o.movable) {
+        ++moves;
+        EXPECT_TRUE(movable);
+    }
+
+    expecter& operator=(const expecter& o) {
+        copyable = o.copyable;
+        movable = o.movable;
+        ++copies;
+        EXPECT_TRUE(copyable);
+        return *this;
+    }
+    expecter& operator=(expecter&& o) {
+        copyable = o.copyable;
+        movable = o.movable;
+        ++moves;
         EXPECT_TRUE(movable);
+        return *this;
     }
 
     bool copyable;
@@ -68,6 +111,19 @@ struct expecter {
     }
 };
 
+int expecter::copies = 0;
+int expecter::moves = 0;
+
+// Evaluates the expression, expecting it to copy and to move expecters
+// exactly the given numbers of times.
+#define EXPECT_COPIES(Copies, Moves, ...) \
+    do { \
+        expecter::reset(); \
+        __VA_ARGS__; \
+        EXPECT_EQ(Copies, expecter::copies) << #__VA_ARGS__; \
+        EXPECT_EQ(Moves, expecter::moves) << #__VA_ARGS__; \
+    } while (false)
+
 struct A { };
 struct B { };
 
@@ -227,5 +283,323 @@ TEST(compose, works) {
     EXPECT_EQ(false, (std::integral_constant<bool, t1::apply<optimus::less<bool>>{}(false, true)>::value));
 }
 
+TEST(get, record_ref) {
+    const std::vector<std::tuple<std::int32_t, double, std::int32_t>> records{
+        std::make_tuple(1, 0.5, 2), std::make_tuple(4, 1.5, 3)};
+    std::ostringstream out;
+    optimus::write_record_file<std::int32_t, double, std::int32_t>(out, records.begin(), records.end());
+    const std::string bytes = out.str();
+    std::vector<std::uint64_t> buffer((bytes.size() + 7) / 8);
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+
+    optimus::record_file_view<std::int32_t, double, std::int32_t> view{buffer.data(), bytes.size()};
+    ASSERT_TRUE(view.valid());
+    EXPECT_EQ(1, optimus::fst{}(view[0]));
+    EXPECT_EQ(&view[1].get<1>(), &optimus::snd{}(view[1]));
+    EXPECT_SAME_TYPE_AS(const double&, optimus::snd{}(view[1]));
+
+    auto fst_less = optimus::fst::apply<optimus::less<std::int32_t>>{};
+    EXPECT_TRUE(fst_less(view[0], view[1]));
+    EXPECT_FALSE(fst_less(view[1], view[0]));
+
+    auto fields_less = optimus::variadic<optimus::fst, optimus::get<2>>::apply<optimus::less<std::int32_t>>{};
+    EXPECT_TRUE(fields_less(view[0], view[0]));
+    EXPECT_FALSE(fields_less(view[1], view[1]));
+}
+
+TEST(get, lazy_tuple) {
+    auto half = [](int x) { return x / 2; };
+    auto twice = [](int x) { return x * 2; };
+    auto t = optimus::make_lazy_tuple(10, half, twice);
+    const auto& ct = t;
+
+    EXPECT_EQ(20, optimus::snd{}(t));
+    EXPECT_EQ(0x2, t.mask());
+    EXPECT_EQ(&t.get<0>(), &optimus::fst{}(ct));
+    EXPECT_EQ(20, optimus::snd{}(optimus::make_lazy_tuple(10, half, twice)));
+    EXPECT_SAME_TYPE_AS(int&&, optimus::fst{}(std::move(t)));
+
+    auto snd_less = optimus::snd::apply<optimus::less<int>>{};
+    EXPECT_TRUE(snd_less(optimus::make_lazy_tuple(1, half, twice), t));
+}
+
+namespace {
+
+// Squares, and counts the calls of each overload.
+struct counted_square {
+    using argument_type = int;
+    using result_type = long;
+
+    counted_square(int* single_calls, int* block_calls) : single(single_calls), blocks(block_calls) { }
+
+    int* single;
+    int* blocks;
+
+    long operator()(int x) const {
+        ++*single;
+        return long(x) * x;
+    }
+
+    long* operator()(const int* first, const int* last, long* out) const {
+        ++*blocks;
+        for (; first != last; ++first, ++out) {
+            *out = long(*first) * *first;
+        }
+        return out;
+    }
+};
+
+struct negate_only {
+    using argument_type = int;
+    using result_type = int;
+
+    int operator()(int x) const {
+        return -x;
+    }
+};
+
+} // namespace
+
+TEST(batch, calls_fn_on_blocks) {
+    int single = 0;
+    int blocks = 0;
+    optimus::batch<4>::apply<counted_square> squares{&single, &blocks};
+    EXPECT_EQ(4u, squares.capacity());
+
+    std::vector<long> results;
+    auto out = std::back_inserter(results);
+    for (int i = 1; i <= 10; ++i) {
+        squares(i, out);
+        EXPECT_EQ(std::size_t(i % 4), squares.size());
+    }
+    EXPECT_EQ((std::vector<long>{1, 4, 9, 16, 25, 36, 49, 64}), results);
+    EXPECT_EQ(2, blocks);
+
+    squares.flush(out);
+    squares.flush(out);
+    EXPECT_EQ((std::vector<long>{1, 4, 9, 16, 25, 36, 49, 64, 81, 100}), results);
+    EXPECT_EQ(3, blocks);
+    EXPECT_EQ(0, single);
+}
+
+TEST(batch, sinks) {
+    optimus::batch<3>::apply<optimus::divides_by<std::uint32_t>> tenths{10u};
+    std::uint32_t sum = 0;
+    auto add = [&sum](std::uint32_t x) { sum += x; };
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        tenths(i, add);
+    }
+    tenths.flush(add);
+    EXPECT_EQ(450u, sum);
+
+    std::uint32_t out[5] = {};
+    std::uint32_t* it = out;
+    for (std::uint32_t i : {10u, 25u, 99u, 100u, 7u}) {
+        tenths(i, it);
+    }
+    EXPECT_EQ(out + 3, it);
+    tenths.flush(it);
+    EXPECT_EQ(out + 5, it);
+    EXPECT_EQ(1u, out[0]);
+    EXPECT_EQ(9u, out[2]);
+    EXPECT_EQ(0u, out[4]);
+}
+
+TEST(batch, without_a_block_overload) {
+    optimus::batch<2>::apply<negate_only> negate;
+    std::vector<int> results;
+    for (int i : {1, 2, 3}) {
+        negate(i, std::back_inserter(results));
+    }
+    negate.flush(std::back_inserter(results));
+    EXPECT_EQ((std::vector<int>{-1, -2, -3}), results);
+}
+
+namespace {
+
+struct throwing_key {
+    int value;
+
+    bool operator<(const throwing_key& other) const {
+        return value < other.value;
+    }
+};
+
+template <typename T>
+struct throwing_copy {
+    T operator()(const T& value) const {
+        return value;
+    }
+};
+
+using by_first = optimus::fst::apply<optimus::less<int>>;
+using by_key = optimus::get<1>::apply<optimus::less<throwing_key>>;
+using by_name = optimus::at<std::string>::apply<optimus::less<int>>;
+using row = std::tuple<int, throwing_key>;
+
+// Comparators which std::sort copies and calls without unwinding.
+static_assert(std::is_nothrow_copy_constructible<by_first>::value, "");
+static_assert(std::is_nothrow_move_constructible<by_first>::value, "");
+static_assert(noexcept(by_first{}(std::declval<row&>(), std::declval<row&>())), "");
+static_assert(noexcept(optimus::flip::apply<by_first>{}(std::declval<row&>(), std::declval<row&>())), "");
+static_assert(noexcept(optimus::variadic<optimus::fst, optimus::fst>::apply<optimus::less<int>>{}(
+                  std::declval<row&>(), std::declval<row&>())), "");
+static_assert(noexcept(optimus::after<optimus::logical_not>::apply<by_first>{}(
+                  std::declval<row&>(), std::declval<row&>())), "");
+static_assert(noexcept(optimus::before<optimus::negate>::apply<optimus::less<int>>{}(1, 2)), "");
+static_assert(noexcept(optimus::id{}(1)), "");
+static_assert(noexcept(optimus::fst{}(std::declval<row&>())), "");
+static_assert(!noexcept(by_key{}(std::declval<row&>(), std::declval<row&>())), "follows the comparison");
+static_assert(!noexcept(by_name{}(std::declval<std::map<std::string, int>&>(),
+                                  std::declval<std::map<std::string, int>&>())), "map::at throws");
+static_assert(noexcept(optimus::at_index<0>{}(std::declval<std::array<int, 2>&>())) ==
+                  noexcept(std::declval<std::array<int, 2>&>().at(0)), "follows at");
+static_assert(!noexcept(optimus::at_index<0>::apply<optimus::less<int>>{}(
+                  std::declval<std::vector<int>&>(), std::declval<std::vector<int>&>())), "vector::at throws");
+static_assert(!noexcept(optimus::variadic<optimus::get<1>, optimus::get<1>>::apply<optimus::less<throwing_key>>{}(
+                  std::declval<row&>(), std::declval<row&>())), "follows the comparison");
+static_assert(!noexcept(optimus::after<throwing_copy>::apply<by_first>{}(
+                  std::declval<row&>(), std::declval<row&>())), "follows the function after");
+static_assert(!noexcept(optimus::before<throwing_copy>::apply<optimus::less<int>>{}(1, 2)),
+              "follows the functions before");
+
+// Transformers which vector relocates by moving.
+static_assert(std::is_nothrow_move_constructible<optimus::at<std::string>>::value, "");
+static_assert(std::is_nothrow_move_constructible<by_name>::value, "");
+static_assert(!std::is_nothrow_copy_constructible<by_name>::value, "copying a string may throw");
+static_assert(std::is_nothrow_default_constructible<by_first>::value, "");
+static_assert(std::is_nothrow_constructible<by_name, const char*>::value ==
+                  std::is_nothrow_constructible<std::string, const char*>::value, "");
+
+// Moves are constant expressions.
+constexpr optimus::get<1> moved_get = optimus::get<1>(optimus::get<1>{});
+constexpr optimus::id moved_id = optimus::id(optimus::id{});
+constexpr optimus::at_index<1> moved_at = optimus::at_index<1>(optimus::at_index<1>{});
+constexpr by_first moved_by_first = by_first(by_first{});
+
+} // namespace
+
+TEST(transformers, noexcept_sort) {
+    std::vector<std::tuple<int, int>> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.emplace_back((i * 37) % 100, i);
+    }
+    std::sort(rows.begin(), rows.end(), moved_by_first);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, moved_get(optimus::tuple<int, int>(0, std::get<0>(rows[i]))));
+    }
+    EXPECT_EQ(3, moved_id(3));
+    EXPECT_EQ(2, moved_at(std::array<int, 2>{{1, 2}}));
+}
+
+namespace {
+
+template <typename T>
+struct copyable_of {
+    using argument_type = T;
+    using result_type = bool;
+
+    bool operator()(const T& v) const {
+        return v.copyable;
+    }
+};
+
+// The address of a result, whatever its value category.
+template <typename T>
+const typename std::remove_reference<T>::type* address(T&& v) {
+    return &v;
+}
+
+} // namespace
+
+TEST(transformers, no_copies) {
+    auto t = std::make_tuple(expecter{}, expecter{});
+    const auto& ct = t;
+    auto u = std::make_tuple(expecter{}, expecter{});
+    auto nested = std::make_tuple(std::make_tuple(0, expecter{}));
+    std::map<int, expecter> m;
+    m.emplace(1, expecter{});
+    std::array<expecter, 2> a{{expecter{}, expecter{}}};
+    expecter e;
+
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&std::get<0>(t), address(optimus::fst::apply<optimus::id>{}(t))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&std::get<1>(t), address(optimus::snd::apply<optimus::id>{}(ct))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&std::get<0>(t), address(optimus::fst::apply<optimus::id>{}(std::move(t)))));
+
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&e, address(optimus::id::apply<optimus::id>{}(e))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&e, address(optimus::id::apply<optimus::id>{}(std::move(e)))));
+
+    using flipped_less = optimus::flip::apply<optimus::less<expecter>>;
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(flipped_less{}(std::get<1>(t), e)));
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(flipped_less{}(std::move(std::get<1>(t)), std::move(e))));
+
+    using fst_less_snd = optimus::variadic<optimus::fst, optimus::snd>::apply<optimus::less<expecter>>;
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(fst_less_snd{}(t, ct)));
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(fst_less_snd{}(std::move(t), std::move(u))));
+
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&m.at(1), address(optimus::at<int>::apply<optimus::id>{1}(m))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&m.at(1), address(optimus::at<int>::apply<optimus::id>{1}(std::move(m)))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&a[1], address(optimus::at_index<1>::apply<optimus::id>{}(a))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&a[1], address(optimus::at_index<1>::apply<optimus::id>{}(std::move(a)))));
+
+    using copyable_fst = optimus::after<copyable_of>::apply<optimus::fst>;
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(copyable_fst{}(t)));
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(copyable_fst{}(std::move(t))));
+    using copyable_equal = optimus::before<copyable_of>::apply<optimus::equal_to<bool>>;
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(copyable_equal{}(e, a[0])));
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(copyable_equal{}(std::move(e), std::move(a[0]))));
+
+    using snd_of_fst = optimus::compose<optimus::fst, optimus::snd>::apply<optimus::id>;
+    auto& inner = std::get<1>(std::get<0>(nested));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&inner, address(snd_of_fst{}(nested))));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&inner, address(snd_of_fst{}(std::move(nested)))));
+
+    const optimus::constant_ref<expecter> c(true, true);
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&c(), &c(t, e)));
+    EXPECT_COPIES(0, 0, EXPECT_EQ(&c(), &c(std::move(t), std::move(e))));
+    using copyable_of_constant_ref = optimus::after<copyable_of>::apply<optimus::constant_ref<expecter>>;
+    const copyable_of_constant_ref k(true, true);
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(k(e)));
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(k(std::move(e))));
+
+    // A constant returns a copy of its value, but leaves its arguments be.
+    const optimus::constant<expecter> v(true, true);
+    EXPECT_COPIES(1, 0, v(e));
+    EXPECT_COPIES(1, 0, v(std::move(e)));
+
+    // The operands of a placeholder expression which are not scalars are
+    // held by constant_ref.
+    const auto less_than_e = optimus::placeholders::_1 < expecter{};
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(less_than_e(e)));
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(less_than_e(std::move(e))));
+    const auto e_less_than_snd = expecter{} < optimus::placeholders::_2;
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(e_less_than_snd(t, std::get<1>(t))));
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(e_less_than_snd(std::move(t), std::move(std::get<1>(t)))));
+
+    // A single Fn runs inline, two on the pool.
+    using parallel_copyable = optimus::parallel_variadic<optimus::fst>::apply<copyable_of<expecter>>;
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(parallel_copyable{}(t)));
+    EXPECT_COPIES(0, 0, EXPECT_TRUE(parallel_copyable{}(std::move(t))));
+    using parallel_less = optimus::parallel_variadic<optimus::fst, optimus::snd>::apply<optimus::less<expecter>>;
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(parallel_less{}(t, ct)));
+    EXPECT_COPIES(0, 0, EXPECT_FALSE(parallel_less{}(std::move(t), std::move(u))));
+
+    // A batch buffers a copy of an lvalue, and moves an rvalue.
+    optimus::batch<2>::apply<copyable_of<expecter>> batched;
+    std::vector<bool> results;
+    EXPECT_COPIES(1, 0, batched(e, std::back_inserter(results)));
+    EXPECT_COPIES(0, 1, batched(std::move(e), std::back_inserter(results)));
+    EXPECT_COPIES(0, 0, batched.flush(std::back_inserter(results)));
+    EXPECT_EQ(std::vector<bool>({true, true}), results);
+}
+
+TEST(after, lvalue_results) {
+    int x = 3;
+    auto t = std::make_tuple(4, 5);
+    EXPECT_EQ(-6, optimus::before<optimus::negate>::apply<optimus::plus<int>>{}(x, x));
+    EXPECT_EQ(-4, optimus::after<optimus::negate>::apply<optimus::fst>{}(t));
+    EXPECT_TRUE(optimus::before<optimus::negate>::apply<optimus::less<int>>{}(std::get<1>(t), x));
+}
+
 #undef EXPECT_SAME_TYPE
 #undef EXPECT_SAME_TYPE_AS
@@ -1,9 +1,13 @@
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <random>
 #include <string>
 #include <type_traits>
 #include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -12,3 +16,363 @@
 TEST(tuple, compiles) {
     EXPECT_EQ(1, (optimus::get<2>(optimus::make_tuple(3, 2, 1))));
 }
+
+struct visit_describe {
+    std::string operator()(int v) const {
+        return "int " + std::to_string(v);
+    }
+    std::string operator()(const std::string& v) const {
+        return "string " + v;
+    }
+    std::string operator()(char v) const {
+        return std::string{"char "} + v;
+    }
+};
+
+TEST(visit_at, small_tuple) {
+    const auto t = optimus::make_tuple(3, std::string{"two"}, 'c');
+    EXPECT_EQ("int 3", optimus::visit_at(t, 0, visit_describe{}));
+    EXPECT_EQ("string two", optimus::visit_at(t, 1, visit_describe{}));
+    EXPECT_EQ("char c", optimus::visit_at(t, 2, visit_describe{}));
+}
+
+struct visit_increment {
+    template <typename T>
+    void operator()(T& v) const {
+        ++v;
+    }
+};
+
+TEST(visit_at, large_tuple) {
+    auto t = optimus::make_tuple(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19);
+    for (std::size_t i = 0; i < 20; ++i) {
+        optimus::visit_at(t, i, visit_increment{});
+        EXPECT_EQ(int(i + 1), optimus::visit_at(t, i, [](int v) { return v; }));
+    }
+    EXPECT_EQ(20, optimus::get<19>(t));
+}
+
+TEST(visit_at, forwarding) {
+    auto t = optimus::make_tuple(std::string{"moved"}, std::string{"kept"});
+    std::string s = optimus::visit_at(std::move(t), 0, [](std::string&& v) { return std::move(v); });
+    EXPECT_EQ("moved", s);
+    std::string& kept = optimus::visit_at(t, 1, [](std::string& v) -> std::string& { return v; });
+    EXPECT_EQ(&optimus::get<1>(t), &kept);
+}
+
+struct visit_identity {
+    template <typename T>
+    T&& operator()(T&& v) const {
+        return std::forward<T>(v);
+    }
+};
+
+TEST(visit_at, common_type) {
+    const auto t = optimus::make_tuple(1, 2.5, 'a');
+    EXPECT_EQ(2.5, optimus::visit_at(t, 1, [](double v) { return v; }));
+    EXPECT_TRUE((std::is_same<double, decltype(optimus::visit_at(t, 0, visit_identity{}))>::value));
+}
+
+TEST(visit_at, std_tuple) {
+    auto t = std::make_tuple(1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+    EXPECT_EQ(9, optimus::visit_at(t, 8, visit_identity{}));
+}
+
+#ifndef NDEBUG
+TEST(visit_at, out_of_range) {
+    auto small = optimus::make_tuple(1, 2, 3);
+    auto large = std::make_tuple(1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+    EXPECT_DEATH(optimus::visit_at(small, 3, visit_identity{}), "out of range");
+    EXPECT_DEATH(optimus::visit_at(large, 10, visit_identity{}), "out of range");
+}
+#endif
+
+struct twice {
+    template <typename T>
+    constexpr T operator()(const T& v) const {
+        return v + v;
+    }
+};
+
+TEST(tuple_transform, works) {
+    const auto t = optimus::make_tuple(1, 2.5, std::string{"ab"});
+    const auto u = optimus::tuple_transform(t, twice{});
+    EXPECT_TRUE((std::is_same<const optimus::tuple<int, double, std::string>, decltype(u)>::value));
+    EXPECT_EQ(2, optimus::get<0>(u));
+    EXPECT_EQ(5.0, optimus::get<1>(u));
+    EXPECT_EQ("abab", optimus::get<2>(u));
+}
+
+TEST(tuple_transform, constexpr) {
+    constexpr auto t = optimus::make_tuple(1, 2, 3);
+    constexpr auto u = optimus::tuple_transform(t, twice{});
+    EXPECT_EQ(6, (std::integral_constant<int, optimus::get<2>(u)>::value));
+}
+
+struct take {
+    template <typename T>
+    T operator()(T&& v) const {
+        static_assert(!std::is_reference<T>::value, "expected an rvalue");
+        return std::move(v);
+    }
+};
+
+TEST(tuple_transform, forwarding) {
+    auto t = optimus::make_tuple(std::string{"moved"}, 1);
+    auto refs = optimus::tuple_transform(t, visit_identity{});
+    EXPECT_TRUE((std::is_same<optimus::tuple<std::string&, int&>, decltype(refs)>::value));
+    EXPECT_EQ(&optimus::get<0>(t), &optimus::get<0>(refs));
+
+    auto moved = optimus::tuple_transform(std::move(t), take{});
+    EXPECT_EQ("moved", optimus::get<0>(moved));
+}
+
+TEST(tuple, assign_and_swap) {
+    auto t = optimus::make_tuple(1, std::string{"a"});
+    t = optimus::make_tuple(2, std::string{"b"});
+    EXPECT_EQ(2, optimus::get<0>(t));
+    EXPECT_EQ("b", optimus::get<1>(t));
+
+    int i = 0;
+    std::string s;
+    optimus::tie(i, s) = t;
+    EXPECT_EQ(2, i);
+    EXPECT_EQ("b", s);
+
+    int j = 3;
+    std::string u = "c";
+    using std::swap;
+    swap(optimus::tie(i, s), optimus::tie(j, u));
+    EXPECT_EQ(3, i);
+    EXPECT_EQ("c", s);
+    EXPECT_EQ(2, j);
+    EXPECT_EQ("b", u);
+
+    int&& moved = optimus::get<0>(optimus::tuple<int&&>(std::move(i)));
+    EXPECT_EQ(&i, &moved);
+    int& ref = optimus::get<0>(optimus::tie(j));
+    EXPECT_EQ(&j, &ref);
+}
+
+namespace {
+
+// Counts copies, and moves without throwing only if NothrowMove.
+template <bool NothrowMove>
+struct copy_counter {
+    static int copies;
+
+    copy_counter() { }
+    copy_counter(const copy_counter&) {
+        ++copies;
+    }
+    copy_counter(copy_counter&&) noexcept(NothrowMove) { }
+    copy_counter& operator=(const copy_counter&) {
+        ++copies;
+        return *this;
+    }
+    copy_counter& operator=(copy_counter&&) noexcept(NothrowMove) {
+        return *this;
+    }
+};
+
+template <bool NothrowMove>
+int copy_counter<NothrowMove>::copies = 0;
+
+using nothrow_move = optimus::tuple<int, std::string>;
+using throwing_move = optimus::tuple<int, copy_counter<false>>;
+using references = optimus::tuple<int&, std::string&>;
+
+static_assert(std::is_nothrow_default_constructible<optimus::tuple<int, double>>::value, "");
+static_assert(std::is_nothrow_copy_constructible<optimus::tuple<int, double>>::value, "");
+static_assert(!std::is_nothrow_copy_constructible<nothrow_move>::value, "copying a string may throw");
+static_assert(std::is_nothrow_move_constructible<nothrow_move>::value, "moving a string may not");
+static_assert(std::is_nothrow_move_assignable<nothrow_move>::value, "");
+static_assert(!std::is_nothrow_move_constructible<throwing_move>::value, "follows the elements");
+static_assert(!std::is_nothrow_move_assignable<throwing_move>::value, "follows the elements");
+static_assert(std::is_nothrow_copy_constructible<references>::value, "");
+static_assert(std::is_nothrow_copy_assignable<references>::value == std::is_nothrow_copy_assignable<std::string>::value,
+              "assigns through the references");
+static_assert(std::is_nothrow_constructible<optimus::tuple<long, double>, int, float>::value, "");
+static_assert(std::is_nothrow_constructible<optimus::tuple<long, double>, optimus::tuple<int, float>&&>::value, "");
+static_assert(!std::is_nothrow_constructible<nothrow_move, int, const char*>::value, "");
+static_assert(noexcept(std::get<1>(std::declval<nothrow_move&>())), "");
+static_assert(noexcept(optimus::get<0>(std::declval<const nothrow_move&>())), "");
+
+using std::swap;
+static_assert(noexcept(swap(std::declval<nothrow_move&>(), std::declval<nothrow_move&>())), "");
+static_assert(!noexcept(swap(std::declval<throwing_move&>(), std::declval<throwing_move&>())), "");
+
+} // namespace
+
+TEST(tuple, vector_growth_moves) {
+    std::vector<optimus::tuple<int, copy_counter<true>>> moved;
+    std::vector<optimus::tuple<int, copy_counter<false>>> copied;
+    for (int i = 0; i < 100; ++i) {
+        moved.emplace_back(i, copy_counter<true>{});
+        copied.emplace_back(i, copy_counter<false>{});
+    }
+    EXPECT_EQ(0, copy_counter<true>::copies);
+    EXPECT_LT(0, copy_counter<false>::copies);
+}
+
+struct collect {
+    std::string* out;
+
+    template <typename T>
+    void operator()(const T& v) const {
+        *out += std::to_string(v);
+    }
+};
+
+TEST(tuple_for_each, in_order) {
+    std::string out;
+    optimus::tuple_for_each(optimus::make_tuple(1, 2u, 3l), collect{&out});
+    EXPECT_EQ("123", out);
+
+    auto t = optimus::make_tuple(1, 2, 3);
+    optimus::tuple_for_each(t, visit_increment{});
+    EXPECT_EQ(4, optimus::get<2>(t));
+
+    optimus::tuple_for_each(optimus::tuple<>{}, collect{&out});
+    EXPECT_EQ("123", out);
+}
+
+struct add_any {
+    template <typename T, typename U>
+    auto operator()(const T& x, const U& y) const -> decltype(x + y) {
+        return x + y;
+    }
+};
+
+TEST(zip_transform, works) {
+    const auto a = optimus::make_tuple(1, 2.0, std::string{"a"});
+    const auto b = std::make_tuple(10, 0.5, std::string{"b"});
+    const auto sums = optimus::zip_transform(add_any{}, a, b);
+    EXPECT_EQ(11, optimus::get<0>(sums));
+    EXPECT_EQ(2.5, optimus::get<1>(sums));
+    EXPECT_EQ("ab", optimus::get<2>(sums));
+}
+
+struct add3 {
+    template <typename T>
+    constexpr T operator()(const T& x, const T& y, const T& z) const {
+        return x + y + z;
+    }
+};
+
+TEST(zip_transform, constexpr) {
+    constexpr auto t = optimus::make_tuple(1, 2);
+    constexpr auto u = optimus::zip_transform(add3{}, t, t, t);
+    EXPECT_EQ(6, (std::integral_constant<int, optimus::get<1>(u)>::value));
+}
+
+enum class color : std::int8_t { red = -1, green, blue };
+
+template <typename Tuple>
+void expect_same_order_as_std(const std::vector<Tuple>& values) {
+    for (const auto& a : values) {
+        for (const auto& b : values) {
+            const auto sa = std::make_tuple(optimus::get<0>(a), optimus::get<1>(a), optimus::get<2>(a));
+            const auto sb = std::make_tuple(optimus::get<0>(b), optimus::get<1>(b), optimus::get<2>(b));
+            EXPECT_EQ(sa == sb, a == b);
+            EXPECT_EQ(sa != sb, a != b);
+            EXPECT_EQ(sa < sb, a < b);
+            EXPECT_EQ(sa <= sb, a <= b);
+            EXPECT_EQ(sa > sb, a > b);
+            EXPECT_EQ(sa >= sb, a >= b);
+        }
+    }
+}
+
+TEST(tuple_compare, packed) {
+    EXPECT_TRUE((std::is_same<std::uint64_t,
+        optimus::detail::packed_word<std::uint32_t, std::int16_t, char>::type>::value));
+    EXPECT_TRUE((std::is_same<void,
+        optimus::detail::packed_word<std::uint32_t, double>::type>::value));
+
+    using key = optimus::tuple<std::uint32_t, std::int16_t, color>;
+    std::vector<key> values;
+    for (std::uint32_t a : {0u, 1u, 0xFFFFFFFFu}) {
+        for (std::int16_t b : {INT16_MIN, -1, 0, 1, INT16_MAX}) {
+            for (color c : {color::red, color::green, color::blue}) {
+                values.push_back(key{a, b, c});
+            }
+        }
+    }
+    expect_same_order_as_std(values);
+}
+
+#if defined(__SIZEOF_INT128__)
+TEST(tuple_compare, packed_128) {
+    EXPECT_TRUE((std::is_same<optimus::detail::packed_word_max_t,
+        optimus::detail::packed_word<std::uint64_t, std::int32_t, bool>::type>::value));
+
+    using key = optimus::tuple<std::uint64_t, std::int32_t, bool>;
+    std::vector<key> values;
+    for (std::uint64_t a : {std::uint64_t(0), std::uint64_t(1) << 63, ~std::uint64_t(0)}) {
+        for (std::int32_t b : {INT32_MIN, -1, 0, INT32_MAX}) {
+            for (bool c : {false, true}) {
+                values.push_back(key{a, b, c});
+            }
+        }
+    }
+    expect_same_order_as_std(values);
+}
+#endif
+
+TEST(tuple_compare, elementwise) {
+    using key = optimus::tuple<std::string, double, int>;
+    std::vector<key> values;
+    for (const char* a : {"", "a", "b"}) {
+        for (double b : {-1.5, 0.0, 2.0}) {
+            for (int c : {-1, 1}) {
+                values.push_back(key{std::string{a}, b, c});
+            }
+        }
+    }
+    expect_same_order_as_std(values);
+}
+
+TEST(tuple_compare, mixed_types) {
+    EXPECT_TRUE((optimus::make_tuple(1, 2L) == optimus::make_tuple(1L, 2)));
+    EXPECT_TRUE((optimus::make_tuple(1, 2L) < optimus::make_tuple(1L, 3)));
+    EXPECT_TRUE((optimus::make_tuple(std::string{"a"}) < optimus::make_tuple("b")));
+}
+
+TEST(tuple_compare, constexpr) {
+    constexpr auto a = optimus::make_tuple(1u, -2);
+    constexpr auto b = optimus::make_tuple(1u, 3);
+    EXPECT_EQ(true, (std::integral_constant<bool, a < b>::value));
+    EXPECT_EQ(false, (std::integral_constant<bool, a == b>::value));
+    constexpr auto c = optimus::make_tuple(1.0, 2);
+    EXPECT_EQ(true, (std::integral_constant<bool, c == c>::value));
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+TEST(tuple_compare, three_way) {
+    EXPECT_TRUE((optimus::make_tuple(1u, 2) <=> optimus::make_tuple(1u, 3)) < 0);
+    EXPECT_TRUE((optimus::make_tuple(std::string{"b"}, 1) <=> optimus::make_tuple(std::string{"a"}, 2)) > 0);
+    EXPECT_TRUE((std::is_same<std::partial_ordering,
+        decltype(optimus::make_tuple(1, 2.0) <=> optimus::make_tuple(1, 2.0))>::value));
+    EXPECT_TRUE((optimus::make_tuple(1, 2.0) <=> optimus::make_tuple(1, 2.0)) == 0);
+}
+#endif
+
+TEST(tuple_hash, consistent_with_equality) {
+    using packed = optimus::tuple<std::uint32_t, std::uint16_t>;
+    std::hash<packed> h;
+    EXPECT_EQ(h(packed{1, 2}), h(packed{1, 2}));
+    EXPECT_NE(h(packed{1, 2}), h(packed{2, 1}));
+
+    using general = optimus::tuple<std::string, int>;
+    std::hash<general> g;
+    EXPECT_EQ(g(general{std::string{"a"}, 1}), g(general{std::string{"a"}, 1}));
+    EXPECT_NE(g(general{std::string{"a"}, 1}), g(general{std::string{"a"}, 2}));
+
+    std::unordered_set<packed> set;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        set.insert(packed{i, std::uint16_t(i % 7)});
+        set.insert(packed{i, std::uint16_t(i % 7)});
+    }
+    EXPECT_EQ(1000u, set.size());
+}
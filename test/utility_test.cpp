@@ -213,5 +213,12 @@ TEST(index_sequence_for, works) {
         optimus::index_sequence_for<int, char, bool>>::value));
 }
 
+TEST(make_integer_sequence, large) {
+    EXPECT_EQ(1000u, (optimus::make_integer_sequence<unsigned, 1000>::size()));
+    EXPECT_TRUE((::std::is_same<
+        optimus::make_index_sequence<1000>,
+        optimus::detail::make_integer_sequence_impl<std::size_t, 0, 1000, false>::type>::value));
+}
+
 #undef EXPECT_SAME_TYPE
 #undef EXPECT_SAME_TYPE_AS
@@ -0,0 +1,223 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/transformers.h>
+#include <optimus/variant.h>
+
+#define EXPECT_SAME_TYPE(T, U) \
+    EXPECT_TRUE((std::is_same<T, U>::value))
+
+#define EXPECT_SAME_TYPE_AS(T, Value) \
+    EXPECT_SAME_TYPE(T, decltype(Value))
+
+struct counted {
+    static int alive;
+
+    counted() { ++alive; }
+    counted(const counted&) { ++alive; }
+    counted(counted&&) { ++alive; }
+    ~counted() { --alive; }
+
+    counted& operator=(const counted&) = default;
+    counted& operator=(counted&&) = default;
+};
+
+int counted::alive = 0;
+
+TEST(variant, layout) {
+    using small = optimus::variant<char, std::uint32_t, double>;
+    EXPECT_EQ(sizeof(double) + alignof(double), sizeof(small));
+    EXPECT_EQ(alignof(double), alignof(small));
+    EXPECT_EQ(2 * sizeof(char), sizeof(optimus::variant<char>));
+    EXPECT_TRUE((std::is_trivially_copyable<small>::value));
+    EXPECT_TRUE((std::is_trivially_destructible<small>::value));
+    EXPECT_FALSE((std::is_trivially_copyable<optimus::variant<int, std::string>>::value));
+}
+
+TEST(variant, construction) {
+    optimus::variant<int, std::string> d;
+    EXPECT_EQ(0u, d.index());
+    EXPECT_EQ(0, optimus::get<0>{}(d));
+
+    optimus::variant<int, std::string> s{std::string{"hello"}};
+    EXPECT_EQ(1u, s.index());
+    EXPECT_TRUE(optimus::holds_alternative<std::string>(s));
+    EXPECT_EQ("hello", optimus::get<1>{}(s));
+
+    optimus::variant<int, std::string> p{optimus::in_place_index_t<1>{}, 3, 'x'};
+    EXPECT_EQ("xxx", optimus::get<1>{}(p));
+}
+
+TEST(variant, constexpr) {
+    constexpr optimus::variant<int, char, double> v{'c'};
+    EXPECT_EQ(1u, (std::integral_constant<std::size_t, v.index()>::value));
+    EXPECT_EQ('c', (std::integral_constant<char, optimus::get<1>{}(v)>::value));
+    constexpr optimus::variant<int, char, double> w{optimus::in_place_index_t<0>{}, 42};
+    EXPECT_EQ(42, (std::integral_constant<int, optimus::get<0>{}(w)>::value));
+}
+
+TEST(variant, copy_and_assign) {
+    optimus::variant<int, std::string> a{std::string{"a"}};
+    optimus::variant<int, std::string> b{a};
+    EXPECT_EQ("a", optimus::get<1>{}(b));
+
+    b = 5;
+    EXPECT_EQ(0u, b.index());
+    EXPECT_EQ(5, optimus::get<0>{}(b));
+
+    b = a;
+    EXPECT_EQ("a", optimus::get<1>{}(b));
+    b = std::string{"b"};
+    EXPECT_EQ("b", optimus::get<1>{}(b));
+
+    optimus::variant<int, std::string> c{std::move(b)};
+    EXPECT_EQ("b", optimus::get<1>{}(c));
+    a = std::move(c);
+    EXPECT_EQ("b", optimus::get<1>{}(a));
+
+    a.emplace<1>(2, 'z');
+    EXPECT_EQ("zz", optimus::get<1>{}(a));
+}
+
+// Copy constructible, but only move assignable.
+struct no_copy_assign {
+    no_copy_assign() = default;
+    no_copy_assign(const no_copy_assign&) = default;
+    no_copy_assign(no_copy_assign&&) = default;
+    no_copy_assign& operator=(const no_copy_assign&) = delete;
+    no_copy_assign& operator=(no_copy_assign&&) = default;
+};
+
+TEST(variant, copy_only_when_alternatives_copy) {
+    using move_only = optimus::variant<std::unique_ptr<int>, int>;
+    EXPECT_FALSE((std::is_copy_constructible<move_only>::value));
+    EXPECT_FALSE((std::is_copy_assignable<move_only>::value));
+    EXPECT_TRUE((std::is_nothrow_move_constructible<move_only>::value));
+    EXPECT_TRUE((std::is_move_assignable<move_only>::value));
+
+    using copy_constructible = optimus::variant<no_copy_assign, int>;
+    EXPECT_TRUE((std::is_copy_constructible<copy_constructible>::value));
+    EXPECT_FALSE((std::is_copy_assignable<copy_constructible>::value));
+    EXPECT_TRUE((std::is_move_assignable<copy_constructible>::value));
+
+    EXPECT_TRUE((std::is_copy_constructible<optimus::variant<int, std::string>>::value));
+    EXPECT_TRUE((std::is_copy_assignable<optimus::variant<int, std::string>>::value));
+
+    move_only a{std::unique_ptr<int>(new int(3))};
+    move_only b{std::move(a)};
+    EXPECT_EQ(3, *optimus::get<0>{}(b));
+    a = 4;
+    a = std::move(b);
+    EXPECT_EQ(3, *optimus::get<0>{}(a));
+}
+
+TEST(variant, destroys_alternatives) {
+    {
+        optimus::variant<int, counted> v{counted{}};
+        EXPECT_EQ(1, counted::alive);
+        optimus::variant<int, counted> w{v};
+        EXPECT_EQ(2, counted::alive);
+        w = 1;
+        EXPECT_EQ(1, counted::alive);
+        v = w;
+        EXPECT_EQ(0, counted::alive);
+        v.emplace<1>();
+        EXPECT_EQ(1, counted::alive);
+    }
+    EXPECT_EQ(0, counted::alive);
+}
+
+struct thrower {
+    thrower() { }
+    thrower(int) { throw 1; }
+};
+
+TEST(variant, valueless_by_exception) {
+    optimus::variant<std::string, thrower> v{std::string{"x"}};
+    EXPECT_THROW(v.emplace<1>(1), int);
+    EXPECT_TRUE(v.valueless_by_exception());
+    EXPECT_EQ(optimus::variant_npos, v.index());
+    optimus::variant<std::string, thrower> w{v};
+    EXPECT_TRUE(w.valueless_by_exception());
+    w = std::string{"y"};
+    EXPECT_EQ("y", optimus::get<0>{}(w));
+}
+
+TEST(variant, get_if) {
+    optimus::variant<int, std::string> v{7};
+    EXPECT_EQ(7, *optimus::get_if<0>(&v));
+    EXPECT_EQ(nullptr, optimus::get_if<1>(&v));
+    const auto& cv = v;
+    EXPECT_SAME_TYPE_AS(const int*, optimus::get_if<0>(&cv));
+}
+
+struct describe {
+    std::string operator()(int) const { return "int"; }
+    std::string operator()(const std::string&) const { return "string"; }
+    std::string operator()(double) const { return "double"; }
+};
+
+TEST(variant, visit) {
+    optimus::variant<int, std::string, double> v{2.0};
+    EXPECT_EQ("double", optimus::visit(describe{}, v));
+    v = std::string{"s"};
+    EXPECT_EQ("string", optimus::visit(describe{}, v));
+
+    auto moved = optimus::visit([](std::string&& s) { return std::move(s); },
+            optimus::variant<std::string>{std::string{"moved"}});
+    EXPECT_EQ("moved", moved);
+
+    optimus::variant<int, long> w{3};
+    EXPECT_SAME_TYPE_AS(long, optimus::visit(optimus::id{}, w));
+    optimus::variant<int, int> same{optimus::in_place_index_t<1>{}, 4};
+    int& ref = optimus::visit(optimus::id{}, same);
+    EXPECT_EQ(&optimus::get<1>{}(same), &ref);
+}
+
+template <std::size_t I>
+using tag = std::integral_constant<std::size_t, I>;
+
+struct tag_value {
+    template <std::size_t I>
+    std::size_t operator()(tag<I>) const {
+        return I;
+    }
+};
+
+TEST(variant, visit_many_alternatives) {
+    using many = optimus::variant<
+        tag<0>, tag<1>, tag<2>, tag<3>, tag<4>, tag<5>, tag<6>, tag<7>,
+        tag<8>, tag<9>, tag<10>, tag<11>, tag<12>, tag<13>, tag<14>, tag<15>>;
+    EXPECT_EQ(1u, sizeof(many::index_type));
+    many v{tag<12>{}};
+    EXPECT_EQ(12u, optimus::visit(tag_value{}, v));
+    v = tag<3>{};
+    EXPECT_EQ(3u, optimus::visit(tag_value{}, v));
+}
+
+TEST(variant, transformer_visitors) {
+    optimus::variant<int, bool> v{5};
+    EXPECT_EQ(false, optimus::visit(optimus::after<optimus::logical_not>::apply<optimus::id>{}, v));
+    v = false;
+    EXPECT_EQ(true, optimus::visit(optimus::after<optimus::logical_not>::apply<optimus::id>{}, v));
+
+    optimus::variant<std::pair<int, int>, int> p{std::make_pair(1, 2)};
+    EXPECT_EQ(std::make_pair(1, 2), optimus::get<0>{}(p));
+    EXPECT_EQ(2, optimus::get<0>::apply<optimus::snd>{}(p));
+    EXPECT_TRUE((optimus::get<0>::apply<optimus::fst::apply<optimus::less<int>>>{}(
+            p, optimus::variant<std::pair<int, int>, int>{std::make_pair(3, 0)})));
+
+    using pair = std::pair<int, int>;
+    const auto& cp = p;
+    EXPECT_SAME_TYPE_AS(const pair&, optimus::get<0>{}(cp));
+    EXPECT_SAME_TYPE_AS(pair&&, optimus::get<0>{}(std::move(p)));
+}
+
+#undef EXPECT_SAME_TYPE
+#undef EXPECT_SAME_TYPE_AS
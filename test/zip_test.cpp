@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <optimus/functional.h>
+#include <optimus/sort.h>
+#include <optimus/sorted_index.h>
+#include <optimus/top_k.h>
+#include <optimus/transformers.h>
+#include <optimus/tuple_core.h>
+#include <optimus/zip.h>
+
+TEST(zip, references) {
+    std::vector<int> a{1, 2, 3};
+    std::vector<std::string> b{"one", "two", "three", "four"};
+    const std::vector<double> c{0.5, 1.5, 2.5};
+
+    auto zipped = optimus::zip(a, b, c);
+    EXPECT_EQ(3u, zipped.size());
+    EXPECT_EQ(3, std::distance(zipped.begin(), zipped.end()));
+    static_assert(std::is_same<decltype(*zipped.begin()), optimus::tuple<int&, std::string&, const double&>>::value,
+                  "zip yields a tuple of references");
+    static_assert(std::is_same<std::iterator_traits<decltype(zipped.begin())>::iterator_category,
+                               std::random_access_iterator_tag>::value, "zip of vectors is random access");
+
+    EXPECT_EQ(&a[1], &std::get<0>(zipped[1]));
+    EXPECT_EQ(&b[2], &optimus::get<1>{}(zipped[2]));
+    EXPECT_EQ(2.5, std::get<2>(zipped[2]));
+
+    std::get<0>(zipped[0]) = 10;
+    EXPECT_EQ(10, a[0]);
+
+    int sum = 0;
+    for (auto row : zipped) {
+        sum += std::get<0>(row);
+        std::get<1>(row) += "!";
+    }
+    EXPECT_EQ(15, sum);
+    EXPECT_EQ("three!", b[2]);
+    EXPECT_EQ("four", b[3]);
+}
+
+TEST(zip, iterator_arithmetic) {
+    std::vector<int> a{0, 1, 2, 3, 4, 5};
+    std::vector<int> b{0, 10, 20, 30, 40, 50};
+    auto zipped = optimus::zip(a, b);
+    auto it = zipped.begin();
+    it += 4;
+    EXPECT_EQ(40, std::get<1>(*it));
+    EXPECT_EQ(20, std::get<1>(it[-2]));
+    --it;
+    EXPECT_EQ(3, std::get<0>(*it--));
+    EXPECT_EQ(2, std::get<0>(*it));
+    EXPECT_EQ(2, it - zipped.begin());
+    EXPECT_TRUE(zipped.begin() < it);
+    EXPECT_TRUE(it <= it);
+    EXPECT_TRUE(zipped.end() > it);
+    EXPECT_EQ(zipped.end(), 6 + zipped.begin());
+    EXPECT_EQ(zipped.begin(), zipped.end() - 6);
+}
+
+TEST(zip, assign_and_swap) {
+    std::vector<int> a{1, 2};
+    std::vector<std::string> b{"x", "y"};
+    auto zipped = optimus::zip(a, b);
+
+    zipped[0] = zipped[1];
+    EXPECT_EQ(2, a[0]);
+    EXPECT_EQ("y", b[0]);
+
+    zipped[1] = optimus::tuple<int, std::string>(7, "z");
+    EXPECT_EQ(7, a[1]);
+    EXPECT_EQ("z", b[1]);
+
+    using std::swap;
+    swap(zipped[0], zipped[1]);
+    EXPECT_EQ((std::vector<int>{7, 2}), a);
+    EXPECT_EQ((std::vector<std::string>{"z", "y"}), b);
+
+    std::iter_swap(zipped.begin(), zipped.begin() + 1);
+    EXPECT_EQ((std::vector<int>{2, 7}), a);
+    EXPECT_EQ((std::vector<std::string>{"y", "z"}), b);
+
+    optimus::tuple<int, std::string> value = *zipped.begin();
+    EXPECT_EQ(2, std::get<0>(value));
+    EXPECT_EQ("y", std::get<1>(value));
+}
+
+TEST(zip, sort_by_column) {
+    std::vector<std::int64_t> keys;
+    std::vector<std::string> names;
+    std::vector<int> positions;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back((i * 7919) % 1009);
+        names.push_back(std::to_string(keys.back()));
+        positions.push_back(i);
+    }
+    auto zipped = optimus::zip(keys, names, positions);
+
+    std::sort(zipped.begin(), zipped.end(), optimus::fst::apply<optimus::less<std::int64_t>>{});
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(std::to_string(keys[i]), names[i]);
+        ASSERT_EQ((positions[i] * 7919) % 1009, keys[i]);
+    }
+
+    std::stable_sort(zipped.begin(), zipped.end(),
+                     optimus::variadic<optimus::get<2>, optimus::get<2>>::apply<optimus::greater<int>>{});
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(int(999 - i), positions[i]);
+        ASSERT_EQ(std::to_string(keys[i]), names[i]);
+    }
+
+    std::sort(zipped.begin(), zipped.end());
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    EXPECT_TRUE(std::is_sorted(zipped.begin(), zipped.end()));
+}
+
+TEST(zip, iter_move) {
+    std::vector<int> a{1, 2};
+    std::vector<std::string> b{"a string too long for the small buffer", "y"};
+    auto zipped = optimus::zip(a, b);
+    static_assert(std::is_same<decltype(iter_move(zipped.begin())), optimus::tuple<int&&, std::string&&>>::value,
+                  "iter_move yields a tuple of rvalue references");
+
+    optimus::tuple<int, std::string> value(iter_move(zipped.begin()));
+    EXPECT_EQ(1, std::get<0>(value));
+    EXPECT_EQ("a string too long for the small buffer", std::get<1>(value));
+    EXPECT_TRUE(b[0].empty());
+
+    zipped[0] = iter_move(zipped.begin() + 1);
+    EXPECT_EQ(2, a[0]);
+    EXPECT_EQ("y", b[0]);
+}
+
+namespace {
+
+// Counts the copies made of it, to check that sorting only moves.
+struct counted {
+    static int copies;
+
+    int value;
+
+    explicit counted(int value) : value(value) { }
+    counted(const counted& other) : value(other.value) { ++copies; }
+    counted(counted&&) = default;
+
+    counted& operator=(const counted& other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+
+    counted& operator=(counted&&) = default;
+};
+
+int counted::copies = 0;
+
+} // namespace
+
+TEST(zip, sort_moves) {
+    std::vector<int> keys;
+    std::vector<counted> payloads;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back((i * 7919) % 1009);
+        payloads.emplace_back(keys.back());
+    }
+    auto zipped = optimus::zip(keys, payloads);
+
+    counted::copies = 0;
+    optimus::sort(zipped.begin(), zipped.end(), optimus::fst::apply<optimus::greater<int>>{});
+    EXPECT_EQ(0, counted::copies);
+    EXPECT_TRUE(std::is_sorted(keys.rbegin(), keys.rend()));
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(keys[i], payloads[i].value);
+    }
+}
+
+TEST(zip, with_projections) {
+    std::vector<int> ids{30, 10, 20};
+    std::vector<std::string> names{"c", "a", "b"};
+    auto zipped = optimus::zip(ids, names);
+
+    auto index = optimus::index_by<optimus::fst>(zipped.begin(), zipped.end());
+    auto found = index.find(20);
+    ASSERT_NE(index.end(), found);
+    EXPECT_EQ("b", std::get<1>(*found));
+
+    auto top = optimus::top_k<optimus::fst::apply<optimus::greater<int>>>(zipped, 2);
+    ASSERT_EQ(2u, top.size());
+    EXPECT_EQ(30, std::get<0>(top[0]));
+    EXPECT_EQ("b", std::get<1>(top[1]));
+}
+
+TEST(zip, shortest_and_forward) {
+    std::list<int> a{1, 2, 3, 4};
+    std::vector<char> b{'a', 'b', 'c'};
+    auto zipped = optimus::zip(a, b);
+    static_assert(std::is_same<std::iterator_traits<decltype(zipped.begin())>::iterator_category,
+                               std::bidirectional_iterator_tag>::value, "the weakest category");
+    EXPECT_EQ(3u, zipped.size());
+    std::string joined;
+    for (auto row : zipped) {
+        joined += std::to_string(std::get<0>(row));
+        joined += std::get<1>(row);
+    }
+    EXPECT_EQ("1a2b3c", joined);
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <optimus/utility.h>
+
+namespace optimus {
+
+// Candidates tested against the threshold at once before any of them
+// reaches the heap.
+constexpr ::std::size_t top_k_block = 64;
+
+/**
+ * The first `k` values pushed into it under `Compare`, e.g. the largest k
+ * under optimus::greater<int>, or the k rows with the smallest second field
+ * under optimus::get<1>::apply<optimus::less<int>>. For inputs which are
+ * too large or unbounded to hold at once.
+ *
+ * The values are kept in a heap of size k whose top is the threshold, the
+ * worst value kept. Once the heap is full, a block of candidates is first
+ * compared with a copy of the threshold in a branch-free loop the compiler
+ * vectorizes for arithmetic values, and only a block in which some value
+ * beats it goes near the heap, so most of a large input costs one
+ * comparison per value.
+ */
+template <typename T, typename Compare>
+class top_k_accumulator {
+  public:
+    explicit top_k_accumulator(::std::size_t k, Compare compare = Compare{})
+            : k_(k), compare_(optimus::move(compare)) {
+        heap_.reserve(k);
+    }
+
+    ::std::size_t k() const {
+        return k_;
+    }
+
+    ::std::size_t size() const {
+        return heap_.size();
+    }
+
+    bool full() const {
+        return heap_.size() == k_;
+    }
+
+    // The worst value kept, which a value must beat to be kept once full.
+    const T& threshold() const {
+        return heap_.front();
+    }
+
+    void push(const T& value) {
+        if (heap_.size() < k_) {
+            heap_.push_back(value);
+            ::std::push_heap(heap_.begin(), heap_.end(), compare_);
+        } else if (k_ != 0 && compare_(value, heap_.front())) {
+            replace_top(value);
+        }
+    }
+
+    template <typename Iterator>
+    void push(Iterator first, Iterator last) {
+        push(first, last, typename ::std::iterator_traits<Iterator>::iterator_category{});
+    }
+
+    // The values kept, best first.
+    ::std::vector<T> sorted() const {
+        ::std::vector<T> values = heap_;
+        ::std::sort_heap(values.begin(), values.end(), compare_);
+        return values;
+    }
+
+  private:
+    template <typename Iterator>
+    void push(Iterator first, Iterator last, ::std::input_iterator_tag) {
+        for (; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+    // Blocks need a second pass, so only for forward iterators.
+    template <typename Iterator>
+    void push(Iterator first, Iterator last, ::std::forward_iterator_tag) {
+        for (; first != last && !full(); ++first) {
+            push(*first);
+        }
+        if (k_ == 0) {
+            return;
+        }
+        while (first != last) {
+            Iterator block_last = first;
+            ::std::size_t n = 0;
+            const T threshold = heap_.front();
+            bool any = false;
+            for (; n < top_k_block && block_last != last; ++n, ++block_last) {
+                any |= bool(compare_(*block_last, threshold));
+            }
+            if (any) {
+                for (; first != block_last; ++first) {
+                    if (compare_(*first, heap_.front())) {
+                        replace_top(*first);
+                    }
+                }
+            }
+            first = block_last;
+        }
+    }
+
+    // With random access, each block is a counted loop which vectorizes.
+    template <typename Iterator>
+    void push(Iterator first, Iterator last, ::std::random_access_iterator_tag) {
+        for (; first != last && !full(); ++first) {
+            push(*first);
+        }
+        if (k_ == 0) {
+            return;
+        }
+        while (first != last) {
+            const ::std::ptrdiff_t n = ::std::min(::std::ptrdiff_t(top_k_block), last - first);
+            const T threshold = heap_.front();
+            bool any = false;
+            for (::std::ptrdiff_t i = 0; i < n; ++i) {
+                any |= bool(compare_(first[i], threshold));
+            }
+            if (any) {
+                for (::std::ptrdiff_t i = 0; i < n; ++i) {
+                    if (compare_(first[i], heap_.front())) {
+                        replace_top(first[i]);
+                    }
+                }
+            }
+            first += n;
+        }
+    }
+
+    // Replaces the top of the heap with `value`, which beats it, and sifts
+    // it down.
+    void replace_top(const T& value) {
+        const ::std::size_t n = heap_.size();
+        ::std::size_t hole = 0;
+        for (::std::size_t child = 1; child < n; child = 2 * hole + 1) {
+            if (child + 1 < n && compare_(heap_[child], heap_[child + 1])) {
+                ++child;
+            }
+            if (!compare_(value, heap_[child])) {
+                break;
+            }
+            heap_[hole] = optimus::move(heap_[child]);
+            hole = child;
+        }
+        heap_[hole] = value;
+    }
+
+    ::std::size_t k_;
+    Compare compare_;
+    ::std::vector<T> heap_;
+};
+
+namespace detail {
+
+template <typename Iterator, typename Compare>
+::std::vector<typename ::std::iterator_traits<Iterator>::value_type>
+top_k(Iterator first, Iterator last, ::std::size_t k, Compare& compare, ::std::input_iterator_tag) {
+    top_k_accumulator<typename ::std::iterator_traits<Iterator>::value_type, Compare> top{k, compare};
+    top.push(first, last);
+    return top.sorted();
+}
+
+// With the size known up front, a k which is a large share of it is
+// cheaper to select in linear time than to keep in a heap.
+template <typename Iterator, typename Compare>
+::std::vector<typename ::std::iterator_traits<Iterator>::value_type>
+top_k(Iterator first, Iterator last, ::std::size_t k, Compare& compare, ::std::forward_iterator_tag) {
+    const ::std::size_t n = ::std::size_t(::std::distance(first, last));
+    if (k < n / 8) {
+        return top_k(first, last, k, compare, ::std::input_iterator_tag{});
+    }
+    ::std::vector<typename ::std::iterator_traits<Iterator>::value_type> values(first, last);
+    k = ::std::min(k, n);
+    ::std::nth_element(values.begin(), values.begin() + ::std::ptrdiff_t(k), values.end(), compare);
+    values.resize(k);
+    ::std::sort(values.begin(), values.end(), compare);
+    return values;
+}
+
+} // namespace detail
+
+/**
+ * The first `k` values of [first, last) under `Compare`, best first: the k
+ * largest under optimus::greater<int> or
+ * optimus::flip::apply<optimus::less<int>>, the k rows with the largest
+ * second field under optimus::get<1>::apply<optimus::greater<int>>. Which
+ * of equal values are kept is unspecified.
+ *
+ * Uses a top_k_accumulator for small k, and selection over a copy of the
+ * input when k is at least an eighth of it.
+ */
+template <typename Compare, typename Iterator>
+::std::vector<typename ::std::iterator_traits<Iterator>::value_type>
+top_k(Iterator first, Iterator last, ::std::size_t k, Compare compare = Compare{}) {
+    return detail::top_k(first, last, k, compare,
+                         typename ::std::iterator_traits<Iterator>::iterator_category{});
+}
+
+template <typename Compare, typename Range>
+auto top_k(const Range& range, ::std::size_t k, Compare compare = Compare{})
+        -> decltype(optimus::top_k(::std::begin(range), ::std::end(range), k, compare)) {
+    return optimus::top_k(::std::begin(range), ::std::end(range), k, compare);
+}
+
+} // namespace optimus
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
 namespace optimus {
 
@@ -8,6 +9,17 @@ namespace optimus {
 template <typename T>
 using result_of_t = typename ::std::result_of<T>::type;
 
+// Whether the call `Fn(Args...)`, written as for result_of_t, cannot throw,
+// for noexcept specifications which follow the function they call.
+template <typename T>
+struct is_nothrow_call;
+
+template <typename Fn, typename... Args>
+struct is_nothrow_call<Fn(Args...)> : ::std::integral_constant<
+    bool,
+    noexcept(::std::declval<Fn>()(::std::declval<Args>()...))
+> { };
+
 template <typename, typename...>
 struct safe_forwarding_constructor : ::std::true_type { };
 
@@ -22,6 +34,20 @@ struct safe_forwarding_constructor<Class, T> :
     >
 { };
 
+namespace detail {
+
+template <bool... Bools>
+struct bool_pack { };
+
+} // namespace detail
+
+// True if every trait in `Traits` is true.
+template <typename... Traits>
+struct all_of : ::std::is_same<
+    detail::bool_pack<Traits::value...>,
+    detail::bool_pack<(Traits::value || true)...>
+> { };
+
 template <typename Class, typename... Args>
 using safe_forwarding_constructor_t = typename ::std::enable_if<
     safe_forwarding_constructor<Class, Args...>::value
@@ -1,20 +1,23 @@
 #pragma once
 
+#include <cstddef>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <optimus/functional.h>
 #include <optimus/traits.h>
+#include <optimus/tuple_core.h>
 #include <optimus/utility.h>
 
 #define MAKE_BASIC_TRANSFORMER(Class) \
-    constexpr Class() { } \
+    constexpr Class() noexcept(::std::is_nothrow_default_constructible<Fn>::value) { } \
     \
     template < \
         typename... Args, \
         typename = safe_forwarding_constructor_t<Class, Args...> \
     > \
-    explicit constexpr Class(Args&&... args) : \
+    explicit constexpr Class(Args&&... args) noexcept(::std::is_nothrow_constructible<Fn, Args&&...>::value) : \
             fn_(optimus::forward<Args>(args)...) { } \
     \
     constexpr Class(const Class&) = default; \
@@ -24,13 +27,34 @@
 
 namespace optimus {
 
+namespace detail {
+
+namespace adl_get_impl {
+
+using ::std::get;
+
+// Finds the accessors in std, for std::tuple, std::pair and optimus::tuple,
+// and by argument dependent lookup the hidden friends of tuple-like types
+// (see detail::tuple_like_adl), whether or not their headers come first.
+template <::std::size_t Index, typename Tuple>
+constexpr auto adl_get(Tuple&& t) noexcept(noexcept(get<Index>(::std::declval<Tuple>())))
+        -> decltype(get<Index>(optimus::forward<Tuple>(t))) {
+    return get<Index>(optimus::forward<Tuple>(t));
+}
+
+} // namespace adl_get_impl
+
+using adl_get_impl::adl_get;
+
+} // namespace detail
+
 /**
  * This class serves two purposes:
  *   1. Provide a function obejct which returns the element at position
  *      `Index` of a tuple.
  *   2. Provide a function object transformer `get<Index>::apply` which
  *      takes a function object and returns a function object which first
- *      calls `std::get<Index>` on each argument and then forwards it to
+ *      calls `get<Index>` on each argument and then forwards it to
  *      the provided function object.
  */
 template <::std::size_t Index>
@@ -40,8 +64,13 @@ class get {
         MAKE_BASIC_TRANSFORMER(transformer_impl)
 
         template <typename... Args>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<const Fn(decltype(::std::get<Index>(optimus::forward<Args>(args)))...)> {
-            return fn_(::std::get<Index>(optimus::forward<Args>(args))...);
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    is_nothrow_call<const get&(Args&&)>...,
+                    is_nothrow_call<const Fn&(result_of_t<const get(Args&&)>...)>
+                >::value)
+                -> result_of_t<const Fn(decltype(detail::adl_get<Index>(optimus::forward<Args>(args)))...)> {
+            return fn_(detail::adl_get<Index>(optimus::forward<Args>(args))...);
         }
     };
 
@@ -49,13 +78,14 @@ class get {
     template <typename Fn>
     using apply = transformer_impl<Fn>;
 
-    constexpr get() { }
+    constexpr get() noexcept { }
     constexpr get(const get&) = default;
-    get(get&&) = default;
+    constexpr get(get&&) = default;
 
     template <typename Arg>
-    constexpr auto operator()(Arg&& arg) const -> decltype(::std::get<Index>(optimus::forward<Arg>(arg))) {
-        return ::std::get<Index>(optimus::forward<Arg>(arg));
+    constexpr auto operator()(Arg&& arg) const noexcept(noexcept(detail::adl_get<Index>(::std::declval<Arg>())))
+            -> decltype(detail::adl_get<Index>(optimus::forward<Arg>(arg))) {
+        return detail::adl_get<Index>(optimus::forward<Arg>(arg));
     }
 };
 
@@ -67,12 +97,12 @@ class id {
     template <typename Fn>
     using apply = Fn;
 
-    constexpr id() { }
+    constexpr id() noexcept { }
     constexpr id(const id&) = default;
-    id(id&&) = default;
+    constexpr id(id&&) = default;
 
     template <typename Arg>
-    constexpr Arg&& operator()(Arg&& arg) const  {
+    constexpr Arg&& operator()(Arg&& arg) const noexcept {
         return optimus::forward<Arg>(arg);
     }
 };
@@ -83,7 +113,8 @@ class flip {
         MAKE_BASIC_TRANSFORMER(impl)
 
         template <typename Lhs, typename Rhs>
-        constexpr auto operator()(Lhs&& lhs, Rhs&& rhs) const -> result_of_t<const Fn(Rhs&&, Lhs&&)> {
+        constexpr auto operator()(Lhs&& lhs, Rhs&& rhs) const noexcept(is_nothrow_call<const Fn&(Rhs&&, Lhs&&)>::value)
+                -> result_of_t<const Fn(Rhs&&, Lhs&&)> {
             return fn_(optimus::forward<Rhs>(rhs), optimus::forward<Lhs>(lhs));
         }
     };
@@ -102,7 +133,13 @@ class variadic {
         MAKE_BASIC_TRANSFORMER(impl)
 
         template <typename... Args, typename = typename ::std::enable_if<sizeof...(Fns) == sizeof...(Args)>::type>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> {
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    ::std::is_nothrow_default_constructible<Fns>...,
+                    is_nothrow_call<const Fns(Args&&)>...,
+                    is_nothrow_call<const Fn&(result_of_t<const Fns(Args&&)>...)>
+                >::value)
+                -> result_of_t<const Fn(result_of_t<const Fns(Args&&)>...)> {
             return this->fn_(Fns{}(optimus::forward<Args>(args))...);
         }
     };
@@ -116,7 +153,9 @@ template <typename Key>
 class at {
     template <typename Fn>
     struct impl {
-        impl() { }
+        constexpr impl() noexcept(::std::is_nothrow_default_constructible<Key>::value &&
+                                  ::std::is_nothrow_default_constructible<Fn>::value)
+                : key_(), fn_() { }
 
         template <
             typename KeyArg,
@@ -124,17 +163,24 @@ class at {
             typename = safe_forwarding_constructor_t<impl, KeyArg, Args...>
         >
         explicit constexpr impl(KeyArg&& key_arg, Args&&... args)
+                noexcept(::std::is_nothrow_constructible<Key, KeyArg&&>::value &&
+                         ::std::is_nothrow_constructible<Fn, Args&&...>::value)
                 : key_(optimus::forward<KeyArg>(key_arg)),
                   fn_(optimus::forward<Args>(args)...) { }
 
         constexpr impl(const impl&) = default;
-        impl(impl&&) = default;
+        constexpr impl(impl&&) = default;
 
         Key key_;
         Fn fn_;
 
         template <typename... Args>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<const Fn(decltype(optimus::forward<Args>(args).at(key_))...)> {
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    is_nothrow_call<const at&(Args&&)>...,
+                    is_nothrow_call<const Fn&(result_of_t<const at(Args&&)>...)>
+                >::value)
+                -> result_of_t<const Fn(decltype(optimus::forward<Args>(args).at(key_))...)> {
             return this->fn_(optimus::forward<Args>(args).at(key_)...);
         }
     };
@@ -147,15 +193,17 @@ class at {
         typename... Args,
         typename = safe_forwarding_constructor_t<at, Args...>
     >
-    constexpr at(Args&&... args)
+    constexpr at(Args&&... args) noexcept(::std::is_nothrow_constructible<Key, Args&&...>::value)
             : key_(optimus::forward<Args>(args)...)  { }
     constexpr at(const at&) = default;
-    at(at&&) = default;
+    constexpr at(at&&) = default;
 
     Key key_;
 
     template <typename Arg>
-    constexpr auto operator()(Arg&& arg) const -> decltype(optimus::forward<Arg>(arg).at(key_)) {
+    constexpr auto operator()(Arg&& arg) const
+            noexcept(noexcept(::std::declval<Arg>().at(::std::declval<const Key&>())))
+            -> decltype(optimus::forward<Arg>(arg).at(key_)) {
         return optimus::forward<Arg>(arg).at(key_);
     }
 };
@@ -167,7 +215,12 @@ class at<Constant<T, value>> {
         MAKE_BASIC_TRANSFORMER(impl)
 
         template <typename... Args>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<const Fn(decltype(std::forward<Args>(args).at(value))...)> {
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    is_nothrow_call<const at&(Args&&)>...,
+                    is_nothrow_call<const Fn&(result_of_t<const at(Args&&)>...)>
+                >::value)
+                -> result_of_t<const Fn(decltype(std::forward<Args>(args).at(value))...)> {
             return this->fn_(std::forward<Args>(args).at(value)...);
         }
     };
@@ -176,14 +229,15 @@ class at<Constant<T, value>> {
     template <typename Fn>
     using apply = impl<Fn>;
 
-    constexpr at() { }
+    constexpr at() noexcept : key_(value) { }
     constexpr at(const at&) = default;
-    at(at&&) = default;
+    constexpr at(at&&) = default;
 
     T key_;
 
     template <typename Arg>
-    constexpr auto operator()(Arg&& arg) const -> decltype(optimus::forward<Arg>(arg).at(value)) {
+    constexpr auto operator()(Arg&& arg) const noexcept(noexcept(::std::declval<Arg>().at(value)))
+            -> decltype(optimus::forward<Arg>(arg).at(value)) {
         return optimus::forward<Arg>(arg).at(value);
     }
 };
@@ -191,6 +245,14 @@ class at<Constant<T, value>> {
 template <std::size_t Index>
 using at_index = at<std::integral_constant<std::size_t, Index>>;
 
+/**
+ * `after<Function>::apply<Fn>` applies `Function<T>` to the result of Fn,
+ * and `before<Function>::apply<Fn>` applies it to each argument of Fn,
+ * where T is the decayed type of the value. The functions of functional.h
+ * take their arguments by const reference, so a value passes through
+ * without being copied, and Function<T> is empty, so making one on each
+ * call costs nothing.
+ */
 template <template <typename...> class Function>
 class after {
     template <typename Fn>
@@ -198,8 +260,17 @@ class after {
         MAKE_BASIC_TRANSFORMER(impl)
 
         template <typename... Args>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<Function<result_of_t<const Fn(Args&&...)>>(result_of_t<const Fn(Args&&...)>)> {
-            return Function<result_of_t<const Fn(Args&&...)>>{}(this->fn_(optimus::forward<Args>(args)...));
+        using function = Function<typename ::std::decay<result_of_t<const Fn(Args&&...)>>::type>;
+
+        template <typename... Args>
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    is_nothrow_call<const Fn&(Args&&...)>,
+                    ::std::is_nothrow_default_constructible<function<Args...>>,
+                    is_nothrow_call<function<Args...>(result_of_t<const Fn(Args&&...)>)>
+                >::value)
+                -> result_of_t<function<Args...>(result_of_t<const Fn(Args&&...)>)> {
+            return function<Args...>{}(this->fn_(optimus::forward<Args>(args)...));
         }
     };
 
@@ -214,9 +285,18 @@ class before {
     struct impl {
         MAKE_BASIC_TRANSFORMER(impl)
 
+        template <typename Arg>
+        using function = Function<typename ::std::decay<Arg>::type>;
+
         template <typename... Args>
-        constexpr auto operator()(Args&&... args) const -> result_of_t<const Fn(result_of_t<Function<Args>(Args&&)>...)> {
-            return this->fn_(Function<Args>{}(optimus::forward<Args>(args))...);
+        constexpr auto operator()(Args&&... args) const
+                noexcept(all_of<
+                    ::std::is_nothrow_default_constructible<function<Args>>...,
+                    is_nothrow_call<function<Args>(Args&&)>...,
+                    is_nothrow_call<const Fn&(result_of_t<function<Args>(Args&&)>...)>
+                >::value)
+                -> result_of_t<const Fn(result_of_t<function<Args>(Args&&)>...)> {
+            return this->fn_(function<Args>{}(optimus::forward<Args>(args))...);
         }
     };
 
@@ -237,6 +317,125 @@ class compose {
     using apply = typename foldr<Fn, composer, Transforms...>::type;
 };
 
+namespace detail {
+
+// Calls fn's three argument overload, which transforms [first, last) into
+// out, or failing that calls fn on each argument.
+template <typename Fn, typename T, typename R>
+auto batch_call(const Fn& fn, const T* first, const T* last, R* out, int)
+        -> decltype((void)fn(first, last, out)) {
+    fn(first, last, out);
+}
+
+template <typename Fn, typename T, typename R>
+void batch_call(const Fn& fn, const T* first, const T* last, R* out, long) {
+    for (; first != last; ++first, ++out) {
+        *out = fn(*first);
+    }
+}
+
+// Hands a result to a callback, or failing that writes it through an
+// output iterator and advances it.
+template <typename Sink, typename R>
+auto batch_emit(Sink& sink, R& result, int) -> decltype((void)sink(optimus::move(result))) {
+    sink(optimus::move(result));
+}
+
+template <typename Sink, typename R>
+void batch_emit(Sink& out, R& result, long) {
+    *out = optimus::move(result);
+    ++out;
+}
+
+} // namespace detail
+
+/**
+ * `batch<N>::apply<Fn>` buffers the arguments it is called with and calls
+ * Fn on N of them at once, through the three argument overload
+ * `fn(first, last, out)` that the functions of functional.h such as
+ * divides_by provide, or one call per argument when Fn has none. Each call
+ * `f(arg, sink)` takes an argument, copying or moving it into the buffer
+ * as its value category allows; whenever N are buffered, and on
+ * `f.flush(sink)`, their results are handed to `sink` in order. A sink is
+ * either a callback taking a result or an output iterator; an iterator
+ * passed as an lvalue is advanced in place. Arguments still buffered when
+ * the transformer is destroyed are dropped, so flush at the end.
+ *
+ * Fn declares `argument_type` and `result_type`, both default
+ * constructible, since the buffers are arrays of them.
+ */
+template <::std::size_t N>
+class batch {
+    static_assert(N > 0, "batch requires a positive size");
+
+    template <typename Fn>
+    class impl {
+      public:
+        using argument_type = typename Fn::argument_type;
+        using result_type = typename Fn::result_type;
+
+        impl() : size_(0) { }
+
+        template <
+            typename... Args,
+            typename = safe_forwarding_constructor_t<impl, Args...>
+        >
+        explicit impl(Args&&... args) : fn_(optimus::forward<Args>(args)...), size_(0) { }
+
+        impl(const impl&) = default;
+        impl(impl&&) = default;
+
+        template <typename Sink>
+        void operator()(const argument_type& arg, Sink&& sink) {
+            args_[size_++] = arg;
+            if (size_ == N) {
+                flush(sink);
+            }
+        }
+
+        template <typename Sink>
+        void operator()(argument_type&& arg, Sink&& sink) {
+            args_[size_++] = optimus::move(arg);
+            if (size_ == N) {
+                flush(sink);
+            }
+        }
+
+        template <typename Sink>
+        void flush(Sink&& sink) {
+            const ::std::size_t n = size_;
+            if (n == 0) {
+                return;
+            }
+            size_ = 0;
+            result_type results[N];
+            detail::batch_call(static_cast<const Fn&>(fn_), args_ + 0, args_ + n, results + 0, 0);
+            for (::std::size_t i = 0; i < n; ++i) {
+                detail::batch_emit(sink, results[i], 0);
+            }
+        }
+
+        // Arguments buffered since the last call to Fn.
+        ::std::size_t size() const {
+            return size_;
+        }
+
+        static constexpr ::std::size_t capacity() {
+            return N;
+        }
+
+        Fn fn_;
+
+      private:
+        argument_type args_[N];
+        ::std::size_t size_;
+    };
+
+  public:
+    template <typename Fn>
+    using apply = impl<Fn>;
+};
+
 }
 
 #undef MAKE_BASIC_TRANSFORMER
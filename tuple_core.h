@@ -0,0 +1,818 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_three_way_comparison)
+#include <compare>
+#endif
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+/**
+ * Provides an interface that supports a subset of
+ * std::tuple functionality, but has constexpr
+ * support.
+ */
+template <typename... Types>
+struct tuple;
+
+template <>
+struct tuple<> { };
+
+template <typename Type, typename... Types>
+struct tuple<Type, Types...> {
+    using head_type = Type;
+    using tail_type = optimus::tuple<Types...>;
+
+    head_type head_;
+    tail_type tail_;
+
+    constexpr tuple() noexcept(::std::is_nothrow_default_constructible<Type>::value &&
+                               ::std::is_nothrow_default_constructible<tail_type>::value) { }
+    explicit constexpr tuple(const Type& type, const Types&... types)
+            noexcept(::std::is_nothrow_constructible<Type, const Type&>::value &&
+                     ::std::is_nothrow_constructible<tail_type, const Types&...>::value)
+            : head_(type), tail_(types...) { }
+    template <
+        typename UType,
+        typename... UTypes,
+        typename = typename ::std::enable_if<
+            ::std::is_constructible<Type, UType&&>::value
+        >::type
+    >
+    explicit constexpr tuple(UType&& arg, UTypes&&... args)
+            noexcept(::std::is_nothrow_constructible<Type, UType&&>::value &&
+                     ::std::is_nothrow_constructible<tail_type, UTypes&&...>::value)
+            : head_(optimus::forward<UType>(arg)),
+              tail_(optimus::forward<UTypes>(args)...) { }
+    template <
+        typename UType,
+        typename... UTypes,
+        typename = typename ::std::enable_if<
+            ::std::is_constructible<Type, const UType&>::value
+        >::type
+    >
+    constexpr tuple(const optimus::tuple<UType, UTypes...>& other)
+            noexcept(::std::is_nothrow_constructible<Type, const UType&>::value &&
+                     ::std::is_nothrow_constructible<tail_type, const optimus::tuple<UTypes...>&>::value)
+            : head_(other.head_), tail_(other.tail_) { }
+    template <
+        typename UType,
+        typename... UTypes,
+        typename = typename ::std::enable_if<
+            ::std::is_constructible<Type, UType&&>::value
+        >::type
+    >
+    constexpr tuple(optimus::tuple<UType, UTypes...>&& other)
+            noexcept(::std::is_nothrow_constructible<Type, UType&&>::value &&
+                     ::std::is_nothrow_constructible<tail_type, optimus::tuple<UTypes...>&&>::value)
+            : head_(optimus::forward<UType>(other.head_)),
+              tail_(optimus::move(other.tail_)) { }
+    // Conditionally noexcept, so that containers move rather than copy
+    // tuples of movable elements when they grow.
+    constexpr tuple(const tuple& other)
+            noexcept(::std::is_nothrow_constructible<Type, const Type&>::value &&
+                     ::std::is_nothrow_copy_constructible<tail_type>::value)
+            : head_(other.head_), tail_(other.tail_) { }
+    constexpr tuple(tuple&& other)
+            noexcept(::std::is_nothrow_constructible<Type, Type&&>::value &&
+                     ::std::is_nothrow_move_constructible<tail_type>::value)
+            : head_(optimus::forward<Type>(other.head_)), tail_(optimus::move(other.tail_)) { }
+
+    // Assigns element by element, so a tuple of references assigns
+    // through them, like std::tuple.
+    tuple& operator=(const tuple& other)
+            noexcept(::std::is_nothrow_assignable<Type&, const Type&>::value &&
+                     ::std::is_nothrow_copy_assignable<tail_type>::value) {
+        head_ = other.head_;
+        tail_ = other.tail_;
+        return *this;
+    }
+    tuple& operator=(tuple&& other)
+            noexcept(::std::is_nothrow_assignable<Type&, Type&&>::value &&
+                     ::std::is_nothrow_move_assignable<tail_type>::value) {
+        head_ = optimus::forward<Type>(other.head_);
+        tail_ = optimus::move(other.tail_);
+        return *this;
+    }
+    template <typename UType, typename... UTypes>
+    tuple& operator=(const optimus::tuple<UType, UTypes...>& other)
+            noexcept(::std::is_nothrow_assignable<Type&, const UType&>::value &&
+                     ::std::is_nothrow_assignable<tail_type&, const optimus::tuple<UTypes...>&>::value) {
+        head_ = other.head_;
+        tail_ = other.tail_;
+        return *this;
+    }
+    template <typename UType, typename... UTypes>
+    tuple& operator=(optimus::tuple<UType, UTypes...>&& other)
+            noexcept(::std::is_nothrow_assignable<Type&, UType&&>::value &&
+                     ::std::is_nothrow_assignable<tail_type&, optimus::tuple<UTypes...>&&>::value) {
+        head_ = optimus::forward<UType>(other.head_);
+        tail_ = optimus::move(other.tail_);
+        return *this;
+    }
+};
+
+namespace detail {
+
+namespace swap_lookup {
+
+using ::std::swap;
+
+// Whether swapping two T, found as tuple_swap finds it, cannot throw.
+template <typename T>
+struct is_nothrow_swappable
+    : ::std::integral_constant<bool, noexcept(swap(::std::declval<T&>(), ::std::declval<T&>()))> { };
+
+} // namespace swap_lookup
+
+inline void tuple_swap(optimus::tuple<>&, optimus::tuple<>&) noexcept { }
+
+template <typename T, typename... Types>
+void tuple_swap(optimus::tuple<T, Types...>& lhs, optimus::tuple<T, Types...>& rhs)
+        noexcept(all_of<swap_lookup::is_nothrow_swappable<T>, swap_lookup::is_nothrow_swappable<Types>...>::value) {
+    using ::std::swap;
+    swap(lhs.head_, rhs.head_);
+    tuple_swap(lhs.tail_, rhs.tail_);
+}
+
+} // namespace detail
+
+/**
+ * Swaps element by element. For a tuple of references this swaps what
+ * they refer to, which is what makes a tuple of references usable as the
+ * reference type of an iterator, as in zip.h; the overload for rvalues
+ * swaps two such references returned by value.
+ */
+template <typename... Types>
+void swap(optimus::tuple<Types...>& lhs, optimus::tuple<Types...>& rhs)
+        noexcept(noexcept(detail::tuple_swap(lhs, rhs))) {
+    detail::tuple_swap(lhs, rhs);
+}
+
+template <typename... Types>
+void swap(optimus::tuple<Types...>&& lhs, optimus::tuple<Types...>&& rhs)
+        noexcept(noexcept(detail::tuple_swap(lhs, rhs))) {
+    detail::tuple_swap(lhs, rhs);
+}
+
+namespace detail {
+
+template <typename T>
+struct tuple_decay {
+    using type = typename ::std::decay<T>::type;
+};
+
+template <typename T>
+struct tuple_decay<::std::reference_wrapper<T>> {
+    using type = T&;
+};
+
+template <typename T>
+using tuple_decay_t = typename tuple_decay<T>::type;
+
+}
+
+template <typename... Types>
+constexpr optimus::tuple<detail::tuple_decay_t<Types>...> make_tuple(Types&&... args) {
+    return optimus::tuple<detail::tuple_decay_t<Types>...>{optimus::forward<Types>(args)...};
+}
+
+template <typename... Types>
+constexpr optimus::tuple<Types&...> tie(Types&... args) noexcept {
+    return optimus::tuple<Types&...>{args...};
+}
+
+template <typename... Types>
+constexpr optimus::tuple<Types&&...> forward_as_tuple(Types&&... args) noexcept {
+    return optimus::tuple<Types&&...>{optimus::forward<Types>(args)...};
+}
+
+template <typename T>
+struct tuple_size;
+
+template <typename... Types>
+struct tuple_size<optimus::tuple<Types...>>
+    : ::std::integral_constant<std::size_t, sizeof...(Types)> { };
+
+template <typename T>
+struct tuple_size<const T>
+    : ::std::integral_constant<std::size_t, tuple_size<T>::value> { };
+
+template <typename T>
+struct tuple_size<volatile T>
+    : ::std::integral_constant<std::size_t, tuple_size<T>::value> { };
+
+template <typename T>
+struct tuple_size<const volatile T>
+    : ::std::integral_constant<std::size_t, tuple_size<T>::value> { };
+
+template <std::size_t I, typename T>
+struct tuple_element;
+
+template <std::size_t I, typename T, typename... Types>
+struct tuple_element<I, optimus::tuple<T, Types...>> {
+    using type = typename tuple_element<I - 1, optimus::tuple<Types...>>::type;
+};
+
+template <typename T, typename... Types>
+struct tuple_element<0, optimus::tuple<T, Types...>> {
+    using type = T;
+};
+
+template <std::size_t I, typename T>
+struct tuple_element<I, const T> {
+    using type = typename ::std::add_const<optimus::tuple_element<I, T>>::type;
+};
+
+template <std::size_t I, typename T>
+struct tuple_element<I, volatile T> {
+    using type = typename ::std::add_volatile<optimus::tuple_element<I, T>>::type;
+};
+
+template <std::size_t I, typename T>
+struct tuple_element<I, const volatile T> {
+    using type = typename ::std::add_cv<optimus::tuple_element<I, T>>::type;
+};
+
+namespace detail {
+
+template <std::size_t I, typename T>
+struct get;
+
+template <std::size_t I, typename T, typename... Types>
+struct get<I, optimus::tuple<T, Types...>> {
+    constexpr typename optimus::tuple_element<I, optimus::tuple<T, Types...>>::type&
+    operator()(optimus::tuple<T, Types...>& tup) const noexcept {
+        return get<I - 1, optimus::tuple<Types...>>{}(tup.tail_);
+    }
+    constexpr typename optimus::tuple_element<I, optimus::tuple<T, Types...>>::type const&
+    operator()(const optimus::tuple<T, Types...>& tup) const noexcept {
+        return get<I - 1, optimus::tuple<Types...>>{}(tup.tail_);
+    }
+    constexpr typename optimus::tuple_element<I, optimus::tuple<T, Types...>>::type&&
+    operator()(optimus::tuple<T, Types...>&& tup) const noexcept {
+        return get<I - 1, optimus::tuple<Types...>>{}(optimus::move(tup.tail_));
+    }
+};
+
+template <typename T, typename... Types>
+struct get<0, optimus::tuple<T, Types...>> {
+    constexpr T& operator()(optimus::tuple<T, Types...>& tup) const noexcept {
+        return tup.head_;
+    }
+    constexpr T const& operator()(const optimus::tuple<T, Types...>& tup) const noexcept {
+        return tup.head_;
+    }
+    constexpr T&& operator()(optimus::tuple<T, Types...>&& tup) const noexcept {
+        return optimus::forward<T>(tup.head_);
+    }
+};
+
+} // namespace detail
+
+} // namespace optimus
+
+namespace std {
+
+template <typename... Types>
+struct tuple_size<optimus::tuple<Types...>>
+    : ::std::integral_constant<std::size_t, sizeof...(Types)> { };
+
+template <std::size_t I, typename... Types>
+struct tuple_element<I, optimus::tuple<Types...>> {
+    using type = typename optimus::tuple_element<I, optimus::tuple<Types...>>::type;
+};
+
+template <std::size_t I, typename... Types>
+constexpr typename std::tuple_element<I, optimus::tuple<Types...>>::type&
+get(optimus::tuple<Types...>& t) noexcept {
+    return optimus::detail::get<I, optimus::tuple<Types...>>{}(t);
+}
+
+template <std::size_t I, typename... Types>
+constexpr typename std::tuple_element<I, optimus::tuple<Types...>>::type const&
+get(optimus::tuple<Types...> const& t) noexcept {
+    return optimus::detail::get<I, optimus::tuple<Types...>>{}(t);
+}
+
+template <std::size_t I, typename... Types>
+constexpr typename std::tuple_element<I, optimus::tuple<Types...>>::type&&
+get(optimus::tuple<Types...>&& t) noexcept {
+    return optimus::detail::get<I, optimus::tuple<Types...>>{}(optimus::move(t));
+}
+
+} // namespace std
+
+namespace optimus {
+
+template <std::size_t I, typename T>
+using tuple_element_t = typename ::std::tuple_element<I, T>::type;
+
+namespace detail {
+
+template <typename TTuple, std::size_t... TIndices, typename UTuple, std::size_t... UIndices>
+constexpr auto tuple_cat_impl(
+        TTuple&& ttuple, optimus::index_sequence<TIndices...>,
+        UTuple&& utuple, optimus::index_sequence<UIndices...>)
+        ->  optimus::tuple<
+                optimus::tuple_element_t<TIndices, TTuple>...,
+                optimus::tuple_element_t<UIndices, UTuple>...
+            > {
+    return optimus::tuple<
+        optimus::tuple_element_t<TIndices, TTuple>...,
+        optimus::tuple_element_t<UIndices, UTuple>...
+    >{
+        ::std::get<TIndices>(optimus::forward<TTuple>(ttuple))...,
+        ::std::get<UIndices>(optimus::forward<UTuple>(utuple))...
+    };
+}
+
+struct tuple_cat {
+    template <typename TTuple, typename UTuple>
+    constexpr auto operator()(TTuple&& ttuple, UTuple&& utuple) const
+        ->  decltype(tuple_cat_impl(
+                optimus::forward<TTuple>(ttuple),
+                optimus::make_index_sequence<::std::tuple_size<TTuple>::value>{},
+                optimus::forward<UTuple>(utuple),
+                optimus::make_index_sequence<::std::tuple_size<UTuple>::value>{}))
+        {
+        return tuple_cat_impl(
+                optimus::forward<TTuple>(ttuple),
+                optimus::make_index_sequence<::std::tuple_size<TTuple>::value>{},
+                optimus::forward<UTuple>(utuple),
+                optimus::make_index_sequence<::std::tuple_size<UTuple>::value>{});
+    }
+};
+
+class foldl {
+    template <typename Fn>
+    struct impl {
+        constexpr impl() { }
+        template <
+            typename... Args,
+            typename = safe_forwarding_constructor_t<impl, Args...>
+        >
+        constexpr impl(Args&&... args)
+            : fn_(optimus::forward<Args>(args)...) { }
+        constexpr impl(const impl&) = default;
+        constexpr impl(impl&&) = default;
+
+        Fn fn_;
+
+        template <typename Acc, typename Arg, typename... Args>
+        constexpr auto operator()(Acc&& acc, Arg&& arg, Args&&... args) const ->
+                optimus::result_of_t<impl<Fn>(
+                    optimus::result_of_t<Fn(Acc&&, Arg&&)>,
+                    Args&&...
+                )> {
+            return (*this)(
+                fn_(optimus::forward<Acc>(acc), optimus::forward<Arg>(arg)), 
+                optimus::forward<Args>(args)...);
+        }
+
+        template <typename Acc>
+        constexpr Acc&& operator()(Acc&& acc) const {
+            return optimus::forward<Acc>(acc);
+        }
+    };
+
+  public:
+    template <typename Fn>
+    using apply = impl<Fn>;
+};
+
+}
+
+template <typename... Tuples>
+constexpr auto tuple_cat(Tuples&&... args)
+        -> optimus::result_of_t<detail::foldl::apply<detail::tuple_cat>(Tuples&&...)> {
+    return detail::foldl::apply<detail::tuple_cat>{}(optimus::forward<Tuples>(args)...);
+}
+
+}
+
+namespace optimus {
+
+namespace detail {
+
+template <::std::size_t I, typename Tuple, typename Fn>
+using visit_at_result_t = result_of_t<Fn&&(decltype(::std::get<I>(::std::declval<Tuple>())))>;
+
+template <typename Tuple, typename Fn, typename Indices>
+struct visit_at_result;
+
+template <typename Tuple, typename Fn, ::std::size_t... Indices>
+struct visit_at_result<Tuple, Fn, optimus::index_sequence<Indices...>>
+    : common_result<visit_at_result_t<Indices, Tuple, Fn>...> { };
+
+template <typename R>
+struct visit_at_thunk {
+    template <::std::size_t I, typename Tuple, typename Fn>
+    static constexpr R call(Tuple&& tup, Fn&& fn) {
+        return optimus::forward<Fn>(fn)(::std::get<I>(optimus::forward<Tuple>(tup)));
+    }
+};
+
+} // namespace detail
+
+/**
+ * Calls `fn` with the element at position `index` of `tup`, where `index`
+ * is only known at runtime, and returns the common type of the results.
+ * Small tuples dispatch through a switch, larger ones through a constexpr
+ * table of function pointers, so the cost is a single indirect jump
+ * regardless of the tuple size. `index` must be less than the tuple size,
+ * which is asserted. Since the index is a runtime value, this is not
+ * constexpr.
+ */
+template <
+    typename Tuple,
+    typename Fn,
+    typename Indices = optimus::make_index_sequence<::std::tuple_size<typename ::std::decay<Tuple>::type>::value>,
+    typename R = typename detail::visit_at_result<Tuple&&, Fn&&, Indices>::type
+>
+R visit_at(Tuple&& tup, ::std::size_t index, Fn&& fn) {
+    return detail::runtime_dispatch<
+            R,
+            detail::visit_at_thunk<R>,
+            ::std::tuple_size<typename ::std::decay<Tuple>::type>::value
+        >::call(index, optimus::forward<Tuple>(tup), optimus::forward<Fn>(fn));
+}
+
+}
+
+namespace optimus {
+
+namespace detail {
+
+// Braced initialization evaluates its elements left to right.
+struct swallow {
+    template <typename... Args>
+    constexpr swallow(Args&&...) { }
+};
+
+template <typename Tuple>
+using tuple_indices = optimus::make_index_sequence<::std::tuple_size<typename ::std::decay<Tuple>::type>::value>;
+
+template <typename Tuple, typename Fn, ::std::size_t... Indices>
+constexpr auto tuple_transform_impl(Tuple&& tup, Fn& fn, optimus::index_sequence<Indices...>)
+        -> optimus::tuple<result_of_t<Fn&(decltype(::std::get<Indices>(optimus::forward<Tuple>(tup))))>...> {
+    return optimus::tuple<result_of_t<Fn&(decltype(::std::get<Indices>(optimus::forward<Tuple>(tup))))>...>{
+        fn(::std::get<Indices>(optimus::forward<Tuple>(tup)))...
+    };
+}
+
+template <typename Fn>
+constexpr Fn for_each_result(swallow, Fn& fn) {
+    return fn;
+}
+
+template <typename Tuple, typename Fn, ::std::size_t... Indices>
+constexpr Fn tuple_for_each_impl(Tuple&& tup, Fn& fn, optimus::index_sequence<Indices...>) {
+    return for_each_result(
+            swallow{((void)fn(::std::get<Indices>(optimus::forward<Tuple>(tup))), 0)...}, fn);
+}
+
+template <::std::size_t Index, typename Fn, typename... Tuples>
+constexpr auto zip_element(Fn& fn, Tuples&&... tups)
+        -> result_of_t<Fn&(decltype(::std::get<Index>(optimus::forward<Tuples>(tups)))...)> {
+    return fn(::std::get<Index>(optimus::forward<Tuples>(tups))...);
+}
+
+template <typename Fn, ::std::size_t... Indices, typename... Tuples>
+constexpr auto zip_transform_impl(Fn& fn, optimus::index_sequence<Indices...>, Tuples&&... tups)
+        -> optimus::tuple<decltype(zip_element<Indices>(fn, optimus::forward<Tuples>(tups)...))...> {
+    return optimus::tuple<decltype(zip_element<Indices>(fn, optimus::forward<Tuples>(tups)...))...>{
+        zip_element<Indices>(fn, optimus::forward<Tuples>(tups)...)...
+    };
+}
+
+template <typename Tuple, typename... Tuples>
+struct same_tuple_size : ::std::is_same<
+    optimus::index_sequence<::std::tuple_size<typename ::std::decay<Tuples>::type>::value...>,
+    optimus::index_sequence<(0 * ::std::tuple_size<typename ::std::decay<Tuples>::type>::value +
+                             ::std::tuple_size<typename ::std::decay<Tuple>::type>::value)...>
+> { };
+
+} // namespace detail
+
+/**
+ * Returns an optimus::tuple holding `fn` applied to each element of `tup`,
+ * keeping the exact result types (a reference result stays a reference).
+ * Elements are forwarded, so an rvalue tuple hands its elements over as
+ * rvalues. The calls are made left to right and are fully unrolled.
+ */
+template <typename Tuple, typename Fn>
+constexpr auto tuple_transform(Tuple&& tup, Fn fn)
+        -> decltype(detail::tuple_transform_impl(
+                optimus::forward<Tuple>(tup), fn, detail::tuple_indices<Tuple>{})) {
+    return detail::tuple_transform_impl(
+            optimus::forward<Tuple>(tup), fn, detail::tuple_indices<Tuple>{});
+}
+
+/**
+ * Calls `fn` on each element of `tup` from left to right, and returns `fn`.
+ */
+template <typename Tuple, typename Fn>
+constexpr Fn tuple_for_each(Tuple&& tup, Fn fn) {
+    return detail::tuple_for_each_impl(optimus::forward<Tuple>(tup), fn, detail::tuple_indices<Tuple>{});
+}
+
+/**
+ * Returns an optimus::tuple whose element `I` is `fn` applied to element
+ * `I` of every tuple in `tups`, which must all have the same size. The
+ * function comes first since it cannot follow a pack.
+ */
+template <typename Fn, typename Tuple, typename... Tuples>
+constexpr auto zip_transform(Fn fn, Tuple&& tup, Tuples&&... tups)
+        -> decltype(detail::zip_transform_impl(
+                fn, detail::tuple_indices<Tuple>{},
+                optimus::forward<Tuple>(tup), optimus::forward<Tuples>(tups)...)) {
+    static_assert(detail::same_tuple_size<Tuple, Tuples...>::value,
+            "zip_transform requires tuples of the same size");
+    return detail::zip_transform_impl(
+            fn, detail::tuple_indices<Tuple>{},
+            optimus::forward<Tuple>(tup), optimus::forward<Tuples>(tups)...);
+}
+
+}
+
+namespace optimus {
+
+namespace detail {
+
+template <typename T>
+struct type_tag { };
+
+template <typename T, bool = ::std::is_enum<T>::value>
+struct packed_value {
+    using type = T;
+};
+
+template <typename T>
+struct packed_value<T, true> {
+    using type = typename ::std::underlying_type<T>::type;
+};
+
+// Number of bits a value takes in a packed word, 0 if it can't be packed.
+template <typename T>
+struct packed_bits : ::std::integral_constant<
+    ::std::size_t,
+    (::std::is_integral<T>::value || ::std::is_enum<T>::value) ? 8 * sizeof(T) : 0
+> { };
+
+template <typename... Types>
+struct packed_bits_sum;
+
+template <>
+struct packed_bits_sum<> : ::std::integral_constant<::std::size_t, 0> { };
+
+template <typename T, typename... Types>
+struct packed_bits_sum<T, Types...>
+    : ::std::integral_constant<::std::size_t, packed_bits<T>::value + packed_bits_sum<Types...>::value> { };
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 packed_word_max_t;
+#else
+typedef ::std::uint64_t packed_word_max_t;
+#endif
+
+/**
+ * The unsigned word which a tuple of `Types` packs into, or void if the
+ * elements aren't all integers or enums or don't fit in the widest word.
+ * Each element is stored in order from the most significant bits down,
+ * with the sign bit of signed elements flipped, so that comparing packed
+ * words is the same as comparing the tuples lexicographically.
+ */
+template <typename... Types>
+struct packed_word {
+    using type = typename ::std::conditional<
+        (!all_of<::std::integral_constant<bool, (packed_bits<Types>::value > 0)>...>::value ||
+            packed_bits_sum<Types...>::value > 8 * sizeof(packed_word_max_t)),
+        void,
+        typename ::std::conditional<
+            (packed_bits_sum<Types...>::value <= 64),
+            ::std::uint64_t,
+            packed_word_max_t
+        >::type
+    >::type;
+};
+
+template <typename Word, typename T>
+constexpr Word order_key(T v, ::std::false_type /* is_signed */) {
+    return Word(v);
+}
+
+template <typename Word, typename T>
+constexpr Word order_key(T v, ::std::true_type /* is_signed */) {
+    using unsigned_type = typename ::std::make_unsigned<T>::type;
+    return Word(unsigned_type(unsigned_type(v) ^ unsigned_type(unsigned_type(1) << (8 * sizeof(T) - 1))));
+}
+
+template <typename Word, typename T>
+constexpr Word order_key(const T& v) {
+    return order_key<Word>(
+            static_cast<typename packed_value<T>::type>(v),
+            ::std::is_signed<typename packed_value<T>::type>{});
+}
+
+template <typename Word>
+constexpr Word pack(const optimus::tuple<>&, Word acc) {
+    return acc;
+}
+
+// Shifts in two halves, since shifting by the full width of Word is undefined.
+template <typename Word, typename T, typename... Types>
+constexpr Word pack(const optimus::tuple<T, Types...>& tup, Word acc) {
+    return pack<Word>(
+            tup.tail_,
+            Word(Word(Word(acc << (4 * sizeof(T))) << (4 * sizeof(T))) | order_key<Word>(tup.head_)));
+}
+
+template <typename Tuple, typename Other>
+struct tuple_packing {
+    using type = void;
+};
+
+template <typename... Types>
+struct tuple_packing<optimus::tuple<Types...>, optimus::tuple<Types...>> {
+    using type = typename packed_word<Types...>::type;
+};
+
+constexpr bool elementwise_equal(const optimus::tuple<>&, const optimus::tuple<>&) {
+    return true;
+}
+
+template <typename T, typename... Types, typename U, typename... UTypes>
+constexpr bool elementwise_equal(const optimus::tuple<T, Types...>& lhs, const optimus::tuple<U, UTypes...>& rhs) {
+    return lhs.head_ == rhs.head_ && elementwise_equal(lhs.tail_, rhs.tail_);
+}
+
+constexpr bool elementwise_less(const optimus::tuple<>&, const optimus::tuple<>&) {
+    return false;
+}
+
+template <typename T, typename... Types, typename U, typename... UTypes>
+constexpr bool elementwise_less(const optimus::tuple<T, Types...>& lhs, const optimus::tuple<U, UTypes...>& rhs) {
+    return lhs.head_ < rhs.head_ || (!(rhs.head_ < lhs.head_) && elementwise_less(lhs.tail_, rhs.tail_));
+}
+
+template <typename Tuple, typename Other>
+constexpr bool tuple_equal(const Tuple& lhs, const Other& rhs, type_tag<void>) {
+    return elementwise_equal(lhs, rhs);
+}
+
+template <typename Tuple, typename Other, typename Word>
+constexpr bool tuple_equal(const Tuple& lhs, const Other& rhs, type_tag<Word>) {
+    return pack<Word>(lhs, 0) == pack<Word>(rhs, 0);
+}
+
+template <typename Tuple, typename Other>
+constexpr bool tuple_less(const Tuple& lhs, const Other& rhs, type_tag<void>) {
+    return elementwise_less(lhs, rhs);
+}
+
+template <typename Tuple, typename Other, typename Word>
+constexpr bool tuple_less(const Tuple& lhs, const Other& rhs, type_tag<Word>) {
+    return pack<Word>(lhs, 0) < pack<Word>(rhs, 0);
+}
+
+inline ::std::size_t hash_combine(::std::size_t seed, ::std::size_t hash) {
+    return seed ^ (hash + ::std::size_t(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2));
+}
+
+inline ::std::size_t hash_word(::std::uint64_t word) {
+    return ::std::size_t(hash_mix(word));
+}
+
+#if defined(__SIZEOF_INT128__)
+inline ::std::size_t hash_word(packed_word_max_t word) {
+    return ::std::size_t(hash_mix(::std::uint64_t(word) ^ hash_mix(::std::uint64_t(word >> 64))));
+}
+#endif
+
+inline ::std::size_t elementwise_hash(const optimus::tuple<>&, ::std::size_t seed) {
+    return seed;
+}
+
+template <typename T, typename... Types>
+::std::size_t elementwise_hash(const optimus::tuple<T, Types...>& tup, ::std::size_t seed) {
+    return elementwise_hash(tup.tail_, hash_combine(seed, ::std::hash<T>{}(tup.head_)));
+}
+
+template <typename Tuple>
+::std::size_t tuple_hash(const Tuple& tup, type_tag<void>) {
+    return elementwise_hash(tup, 0);
+}
+
+template <typename Tuple, typename Word>
+::std::size_t tuple_hash(const Tuple& tup, type_tag<Word>) {
+    return hash_word(pack<Word>(tup, 0));
+}
+
+} // namespace detail
+
+/**
+ * Lexicographic comparisons, unrolled per element. When both tuples have
+ * the same element types and those are integers or enums which fit in a
+ * machine word (128 bits where the compiler supports it), the elements are
+ * packed into a single word and compared in one step without branches.
+ */
+template <typename... Types, typename... UTypes>
+constexpr bool operator==(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    static_assert(sizeof...(Types) == sizeof...(UTypes), "Cannot compare tuples of different sizes");
+    return detail::tuple_equal(lhs, rhs, detail::type_tag<typename detail::tuple_packing<
+            optimus::tuple<Types...>, optimus::tuple<UTypes...>>::type>{});
+}
+
+template <typename... Types, typename... UTypes>
+constexpr bool operator<(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    static_assert(sizeof...(Types) == sizeof...(UTypes), "Cannot compare tuples of different sizes");
+    return detail::tuple_less(lhs, rhs, detail::type_tag<typename detail::tuple_packing<
+            optimus::tuple<Types...>, optimus::tuple<UTypes...>>::type>{});
+}
+
+template <typename... Types, typename... UTypes>
+constexpr bool operator!=(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename... Types, typename... UTypes>
+constexpr bool operator>(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename... Types, typename... UTypes>
+constexpr bool operator<=(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename... Types, typename... UTypes>
+constexpr bool operator>=(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    return !(lhs < rhs);
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+
+namespace detail {
+
+template <typename Ordering>
+constexpr Ordering elementwise_three_way(const optimus::tuple<>&, const optimus::tuple<>&) {
+    return Ordering::equivalent;
+}
+
+template <typename Ordering, typename T, typename... Types, typename U, typename... UTypes>
+constexpr Ordering elementwise_three_way(
+        const optimus::tuple<T, Types...>& lhs, const optimus::tuple<U, UTypes...>& rhs) {
+    const auto c = lhs.head_ <=> rhs.head_;
+    return c != 0 ? Ordering(c) : elementwise_three_way<Ordering>(lhs.tail_, rhs.tail_);
+}
+
+template <typename Ordering, typename Tuple, typename Other>
+constexpr Ordering tuple_three_way(const Tuple& lhs, const Other& rhs, type_tag<void>) {
+    return elementwise_three_way<Ordering>(lhs, rhs);
+}
+
+template <typename Ordering, typename Tuple, typename Other, typename Word>
+constexpr Ordering tuple_three_way(const Tuple& lhs, const Other& rhs, type_tag<Word>) {
+    return pack<Word>(lhs, 0) <=> pack<Word>(rhs, 0);
+}
+
+} // namespace detail
+
+template <typename... Types, typename... UTypes>
+constexpr ::std::common_comparison_category_t<::std::compare_three_way_result_t<Types, UTypes>...>
+operator<=>(const optimus::tuple<Types...>& lhs, const optimus::tuple<UTypes...>& rhs) {
+    return detail::tuple_three_way<
+            ::std::common_comparison_category_t<::std::compare_three_way_result_t<Types, UTypes>...>
+        >(lhs, rhs, detail::type_tag<typename detail::tuple_packing<
+            optimus::tuple<Types...>, optimus::tuple<UTypes...>>::type>{});
+}
+
+#endif
+
+}
+
+namespace std {
+
+/**
+ * Combines the hashes of the elements in order, or mixes the packed word
+ * when the elements pack into one (see the comparison operators).
+ */
+template <typename... Types>
+struct hash<optimus::tuple<Types...>> {
+    std::size_t operator()(const optimus::tuple<Types...>& tup) const {
+        return optimus::detail::tuple_hash(
+                tup, optimus::detail::type_tag<typename optimus::detail::packed_word<Types...>::type>{});
+    }
+};
+
+} // namespace std
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <tuple>
 #include <type_traits>
 
@@ -78,8 +81,30 @@ struct make_integer_sequence_impl<T, Same, Same, false> {
 template <std::size_t... Ints>
 using index_sequence = integer_sequence<std::size_t, Ints...>;
 
+// Prefer the compiler builtins, which generate the sequence without any
+// intermediate instantiations. Define OPTIMUS_NO_BUILTIN_INTEGER_SEQUENCE to
+// always use the library implementation above.
+#if !defined(OPTIMUS_NO_BUILTIN_INTEGER_SEQUENCE) && defined(__has_builtin)
+#  if __has_builtin(__make_integer_seq)
+#    define OPTIMUS_MAKE_INTEGER_SEQ 1
+#  elif __has_builtin(__integer_pack)
+#    define OPTIMUS_INTEGER_PACK 1
+#  endif
+#endif
+
+#if defined(OPTIMUS_MAKE_INTEGER_SEQ)
+template <typename T, T N>
+using make_integer_sequence = __make_integer_seq<integer_sequence, T, N>;
+#elif defined(OPTIMUS_INTEGER_PACK)
+template <typename T, T N>
+using make_integer_sequence = integer_sequence<T, __integer_pack(N)...>;
+#else
 template <typename T, T N>
 using make_integer_sequence = typename detail::make_integer_sequence_impl<T, 0, N, N == 1>::type;
+#endif
+
+#undef OPTIMUS_MAKE_INTEGER_SEQ
+#undef OPTIMUS_INTEGER_PACK
 
 template <std::size_t N>
 using make_index_sequence = make_integer_sequence<std::size_t, N>;
@@ -110,4 +135,169 @@ constexpr auto apply(Func&& func, Tup&& tup) ->
             optimus::make_index_sequence<std::tuple_size<typename std::decay<Tup>::type>::value>{});
 }
 
+namespace detail {
+
+// Runtime indices below this limit are dispatched with a switch, which lets
+// the compiler inline every alternative. Larger ones go through a table.
+constexpr ::std::size_t dispatch_switch_limit = 8;
+
+template <typename R, typename Thunk, typename Indices, typename... Args>
+struct dispatch_table;
+
+template <typename R, typename Thunk, ::std::size_t... Indices, typename... Args>
+struct dispatch_table<R, Thunk, optimus::index_sequence<Indices...>, Args...> {
+    static constexpr R (*value[sizeof...(Indices)])(Args...) = {
+        &Thunk::template call<Indices, Args...>...
+    };
+};
+
+template <typename R, typename Thunk, ::std::size_t... Indices, typename... Args>
+constexpr R (*dispatch_table<R, Thunk, optimus::index_sequence<Indices...>, Args...>::value[sizeof...(Indices)])(Args...);
+
+/**
+ * Calls `Thunk::call<index>(args...)` for an index known only at runtime,
+ * where `Thunk::call<I, Args...>` is a static function returning `R` for
+ * every `I < N`. The index must be less than `N`, which is asserted on
+ * both paths.
+ */
+template <typename R, typename Thunk, ::std::size_t N, bool = (N <= dispatch_switch_limit)>
+struct runtime_dispatch {
+    static_assert(N > 0, "Cannot dispatch over zero alternatives");
+
+    template <typename... Args>
+    static R call(::std::size_t index, Args&&... args) {
+        assert(index < N && "runtime_dispatch index out of range");
+        return dispatch_table<R, Thunk, optimus::make_index_sequence<N>, Args&&...>::value[index](
+                optimus::forward<Args>(args)...);
+    }
+};
+
+template <typename R, typename Thunk, ::std::size_t N>
+struct runtime_dispatch<R, Thunk, N, true> {
+    static_assert(N > 0, "Cannot dispatch over zero alternatives");
+
+    template <typename... Args>
+    static R call(::std::size_t index, Args&&... args) {
+        assert(index < N && "runtime_dispatch index out of range");
+
+#define OPTIMUS_DISPATCH_CASE(I) \
+        case I: \
+            return Thunk::template call<(I < N ? I : N - 1), Args&&...>(optimus::forward<Args>(args)...);
+
+        switch (index) {
+            OPTIMUS_DISPATCH_CASE(0)
+            OPTIMUS_DISPATCH_CASE(1)
+            OPTIMUS_DISPATCH_CASE(2)
+            OPTIMUS_DISPATCH_CASE(3)
+            OPTIMUS_DISPATCH_CASE(4)
+            OPTIMUS_DISPATCH_CASE(5)
+            OPTIMUS_DISPATCH_CASE(6)
+            default:
+                return Thunk::template call<N - 1, Args&&...>(optimus::forward<Args>(args)...);
+        }
+
+#undef OPTIMUS_DISPATCH_CASE
+    }
+};
+
+// The result of calling a function on every alternative of a heterogeneous
+// type: the result itself if they all agree (so that references are
+// preserved), otherwise their common type.
+template <typename R, typename... Rs>
+struct common_result
+    : ::std::conditional<
+        ::std::is_same<
+            optimus::integer_sequence<bool, ::std::is_same<R, Rs>::value...>,
+            optimus::integer_sequence<bool, ::std::is_same<Rs, Rs>::value...>
+        >::value,
+        ::std::enable_if<true, R>,
+        ::std::common_type<R, Rs...>
+    >::type { };
+
+namespace tuple_like_adl {
+
+/**
+ * A base for tuple-like types, whose elements are then read by `get<I>`
+ * found through argument dependent lookup, as `optimus::get<I>` does. The
+ * friends are declared here rather than in each type, because in optimus
+ * the name `get` belongs to the transformer. `Tuple::get_element<I>(t)`,
+ * which may be private if Tuple befriends its base, reads element I of `t`
+ * and decides what each value category yields.
+ */
+template <typename Tuple>
+class tuple_like {
+    // Named through T rather than Tuple, which is incomplete when its base
+    // is instantiated.
+    template <::std::size_t I, typename T, typename Self = typename ::std::decay<T>::type>
+    static constexpr auto element(T&& t) noexcept(noexcept(Self::template get_element<I>(optimus::forward<T>(t))))
+            -> decltype(Self::template get_element<I>(optimus::forward<T>(t))) {
+        return Self::template get_element<I>(optimus::forward<T>(t));
+    }
+
+    template <::std::size_t I>
+    friend constexpr auto get(Tuple& t) noexcept(noexcept(tuple_like::element<I>(t)))
+            -> decltype(tuple_like::element<I>(t)) {
+        return tuple_like::element<I>(t);
+    }
+
+    template <::std::size_t I>
+    friend constexpr auto get(const Tuple& t) noexcept(noexcept(tuple_like::element<I>(t)))
+            -> decltype(tuple_like::element<I>(t)) {
+        return tuple_like::element<I>(t);
+    }
+
+    template <::std::size_t I>
+    friend constexpr auto get(Tuple&& t) noexcept(noexcept(tuple_like::element<I>(optimus::move(t))))
+            -> decltype(tuple_like::element<I>(optimus::move(t))) {
+        return tuple_like::element<I>(optimus::move(t));
+    }
+};
+
+} // namespace tuple_like_adl
+
+// The splitmix64 finalizer.
+inline ::std::uint64_t hash_mix(::std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+inline unsigned count_trailing_zeros(::std::uint32_t x) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctz(x));
+#else
+    unsigned n = 0;
+    for (; (x & 1) == 0; x >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline unsigned count_trailing_zeros(::std::uint64_t x) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    for (; (x & 1) == 0; x >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline unsigned popcount(::std::uint64_t x) {
+#if defined(__GNUC__)
+    return unsigned(__builtin_popcountll(x));
+#else
+    unsigned n = 0;
+    for (; x != 0; x &= x - 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+} // namespace detail
+
 }
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include <optimus/traits.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+template <::std::size_t Index>
+struct in_place_index_t {
+    explicit constexpr in_place_index_t() { }
+};
+
+constexpr ::std::size_t variant_npos = static_cast<::std::size_t>(-1);
+
+template <typename... Types>
+class variant;
+
+template <typename T>
+struct variant_size;
+
+template <typename... Types>
+struct variant_size<optimus::variant<Types...>>
+    : ::std::integral_constant<::std::size_t, sizeof...(Types)> { };
+
+template <typename T>
+struct variant_size<const T> : variant_size<T> { };
+
+template <::std::size_t I, typename T>
+struct variant_alternative;
+
+template <::std::size_t I, typename T, typename... Types>
+struct variant_alternative<I, optimus::variant<T, Types...>>
+    : variant_alternative<I - 1, optimus::variant<Types...>> { };
+
+template <typename T, typename... Types>
+struct variant_alternative<0, optimus::variant<T, Types...>> {
+    using type = T;
+};
+
+template <::std::size_t I, typename T>
+struct variant_alternative<I, const T> {
+    using type = typename ::std::add_const<typename variant_alternative<I, T>::type>::type;
+};
+
+template <::std::size_t I, typename T>
+using variant_alternative_t = typename variant_alternative<I, T>::type;
+
+namespace detail {
+
+// Position of `T` in `Types`, or variant_npos if it isn't there.
+template <typename T, typename... Types>
+struct index_of;
+
+template <typename T>
+struct index_of<T> : ::std::integral_constant<::std::size_t, variant_npos> { };
+
+template <typename T, typename... Types>
+struct index_of<T, T, Types...> : ::std::integral_constant<::std::size_t, 0> { };
+
+template <typename T, typename U, typename... Types>
+struct index_of<T, U, Types...> : ::std::integral_constant<
+    ::std::size_t,
+    index_of<T, Types...>::value == variant_npos ? variant_npos : index_of<T, Types...>::value + 1
+> { };
+
+// The smallest discriminator which can tell `N` alternatives apart from the
+// valueless state.
+template <::std::size_t N>
+using variant_index_t = typename ::std::conditional<
+    (N < UINT8_MAX),
+    ::std::uint8_t,
+    typename ::std::conditional<(N < UINT16_MAX), ::std::uint16_t, ::std::uint32_t>::type
+>::type;
+
+/**
+ * Storage for the alternatives. Every member of a union lives at offset 0,
+ * so the recursion only exists in the type: the object is a single flat,
+ * suitably aligned buffer. A union (rather than raw aligned storage) keeps
+ * construction and access constexpr.
+ */
+template <bool TriviallyDestructible, typename... Types>
+union variant_union;
+
+template <bool TriviallyDestructible>
+union variant_union<TriviallyDestructible> {
+    constexpr variant_union() : dummy_() { }
+
+    char dummy_;
+};
+
+#define OPTIMUS_VARIANT_UNION(TriviallyDestructible, Destructor) \
+    template <typename T, typename... Types> \
+    union variant_union<TriviallyDestructible, T, Types...> { \
+        constexpr variant_union() : dummy_() { } \
+        \
+        template <typename... Args> \
+        explicit constexpr variant_union(in_place_index_t<0>, Args&&... args) \
+                : head_(optimus::forward<Args>(args)...) { } \
+        \
+        template <::std::size_t I, typename... Args> \
+        explicit constexpr variant_union(in_place_index_t<I>, Args&&... args) \
+                : tail_(in_place_index_t<I - 1>{}, optimus::forward<Args>(args)...) { } \
+        \
+        Destructor \
+        \
+        char dummy_; \
+        T head_; \
+        variant_union<TriviallyDestructible, Types...> tail_; \
+    };
+
+OPTIMUS_VARIANT_UNION(true, )
+OPTIMUS_VARIANT_UNION(false, ~variant_union() { })
+
+#undef OPTIMUS_VARIANT_UNION
+
+template <::std::size_t I>
+struct union_get {
+    template <typename Union>
+    static constexpr auto get(Union&& u)
+            -> decltype(union_get<I - 1>::get(optimus::forward<Union>(u).tail_)) {
+        return union_get<I - 1>::get(optimus::forward<Union>(u).tail_);
+    }
+};
+
+template <>
+struct union_get<0> {
+    template <typename Union>
+    static constexpr auto get(Union&& u) -> decltype((optimus::forward<Union>(u).head_)) {
+        return optimus::forward<Union>(u).head_;
+    }
+};
+
+struct union_destroy {
+    template <::std::size_t I, typename Union>
+    static void call(Union& u) {
+        using type = typename ::std::decay<decltype(union_get<I>::get(u))>::type;
+        union_get<I>::get(u).~type();
+    }
+};
+
+struct union_construct {
+    template <::std::size_t I, typename Union, typename Other>
+    static void call(Union& u, Other&& other) {
+        using type = typename ::std::decay<decltype(union_get<I>::get(u))>::type;
+        ::new (static_cast<void*>(&union_get<I>::get(u)))
+            type(union_get<I>::get(optimus::forward<Other>(other)));
+    }
+};
+
+struct union_assign {
+    template <::std::size_t I, typename Union, typename Other>
+    static void call(Union& u, Other&& other) {
+        union_get<I>::get(u) = union_get<I>::get(optimus::forward<Other>(other));
+    }
+};
+
+struct valueless_t { };
+
+template <bool TriviallyDestructible, typename... Types>
+struct variant_storage {
+    using index_type = variant_index_t<sizeof...(Types)>;
+
+    static constexpr index_type valueless = static_cast<index_type>(-1);
+
+    explicit constexpr variant_storage(valueless_t) : union_(), index_(valueless) { }
+
+    template <::std::size_t I, typename... Args>
+    explicit constexpr variant_storage(in_place_index_t<I>, Args&&... args)
+            : union_(in_place_index_t<I>{}, optimus::forward<Args>(args)...), index_(I) { }
+
+    void destroy() {
+        index_ = valueless;
+    }
+
+    variant_union<true, Types...> union_;
+    index_type index_;
+};
+
+template <typename... Types>
+struct variant_storage<false, Types...> {
+    using index_type = variant_index_t<sizeof...(Types)>;
+
+    static constexpr index_type valueless = static_cast<index_type>(-1);
+
+    explicit constexpr variant_storage(valueless_t) : union_(), index_(valueless) { }
+
+    template <::std::size_t I, typename... Args>
+    explicit constexpr variant_storage(in_place_index_t<I>, Args&&... args)
+            : union_(in_place_index_t<I>{}, optimus::forward<Args>(args)...), index_(I) { }
+
+    ~variant_storage() {
+        destroy();
+    }
+
+    void destroy() {
+        if (index_ != valueless) {
+            runtime_dispatch<void, union_destroy, sizeof...(Types)>::call(index_, union_);
+            index_ = valueless;
+        }
+    }
+
+    variant_union<false, Types...> union_;
+    index_type index_;
+};
+
+/**
+ * When every alternative is trivially copyable the copy and move operations
+ * are defaulted, so the variant itself stays trivially copyable and is
+ * copied as a block of bytes. Otherwise they dispatch on the index.
+ */
+template <bool TriviallyCopyable, typename... Types>
+struct variant_copy_base
+    : variant_storage<all_of<::std::is_trivially_destructible<Types>...>::value, Types...> {
+    using base = variant_storage<all_of<::std::is_trivially_destructible<Types>...>::value, Types...>;
+
+    template <typename... Args, typename = safe_forwarding_constructor_t<variant_copy_base, Args...>>
+    explicit constexpr variant_copy_base(Args&&... args) : base(optimus::forward<Args>(args)...) { }
+
+    constexpr variant_copy_base(const variant_copy_base&) = default;
+    constexpr variant_copy_base(variant_copy_base&&) = default;
+    variant_copy_base& operator=(const variant_copy_base&) = default;
+    variant_copy_base& operator=(variant_copy_base&&) = default;
+};
+
+template <typename... Types>
+struct variant_copy_base<false, Types...>
+    : variant_storage<all_of<::std::is_trivially_destructible<Types>...>::value, Types...> {
+    using base = variant_storage<all_of<::std::is_trivially_destructible<Types>...>::value, Types...>;
+
+    template <typename... Args, typename = safe_forwarding_constructor_t<variant_copy_base, Args...>>
+    explicit constexpr variant_copy_base(Args&&... args) : base(optimus::forward<Args>(args)...) { }
+
+    variant_copy_base(const variant_copy_base& other) : base(valueless_t{}) {
+        construct_from(other);
+    }
+
+    variant_copy_base(variant_copy_base&& other)
+            noexcept(all_of<::std::is_nothrow_move_constructible<Types>...>::value)
+            : base(valueless_t{}) {
+        construct_from(optimus::move(other));
+    }
+
+    variant_copy_base& operator=(const variant_copy_base& other) {
+        assign_from(other);
+        return *this;
+    }
+
+    variant_copy_base& operator=(variant_copy_base&& other)
+            noexcept(all_of<::std::is_nothrow_move_constructible<Types>...>::value &&
+                     all_of<::std::is_nothrow_move_assignable<Types>...>::value) {
+        assign_from(optimus::move(other));
+        return *this;
+    }
+
+    template <typename Other>
+    void construct_from(Other&& other) {
+        if (other.index_ != base::valueless) {
+            runtime_dispatch<void, union_construct, sizeof...(Types)>::call(
+                    other.index_, this->union_, optimus::forward<Other>(other).union_);
+            this->index_ = other.index_;
+        }
+    }
+
+    template <typename Other>
+    void assign_from(Other&& other) {
+        if (this->index_ == other.index_ && other.index_ != base::valueless) {
+            runtime_dispatch<void, union_assign, sizeof...(Types)>::call(
+                    other.index_, this->union_, optimus::forward<Other>(other).union_);
+        } else if (this != &other) {
+            this->destroy();
+            construct_from(optimus::forward<Other>(other));
+        }
+    }
+};
+
+/**
+ * Deletes the copy operations of a variant with an alternative that cannot
+ * be copied, as std::variant does, so that is_copy_constructible and
+ * move_if_noexcept see the variant as it is rather than failing to compile
+ * when a copy is made.
+ */
+template <bool CopyConstructible, bool CopyAssignable>
+struct variant_copy_control { };
+
+template <>
+struct variant_copy_control<true, false> {
+    variant_copy_control() = default;
+    variant_copy_control(const variant_copy_control&) = default;
+    variant_copy_control(variant_copy_control&&) = default;
+    variant_copy_control& operator=(const variant_copy_control&) = delete;
+    variant_copy_control& operator=(variant_copy_control&&) = default;
+};
+
+template <>
+struct variant_copy_control<false, false> {
+    variant_copy_control() = default;
+    variant_copy_control(const variant_copy_control&) = delete;
+    variant_copy_control(variant_copy_control&&) = default;
+    variant_copy_control& operator=(const variant_copy_control&) = delete;
+    variant_copy_control& operator=(variant_copy_control&&) = default;
+};
+
+template <typename... Types>
+using variant_copy_control_for = variant_copy_control<
+    all_of<::std::is_copy_constructible<Types>...>::value,
+    all_of<::std::is_copy_constructible<Types>..., ::std::is_copy_assignable<Types>...>::value
+>;
+
+template <typename... Types>
+using variant_base = variant_copy_base<
+    all_of<::std::is_trivially_copyable<Types>...>::value,
+    Types...
+>;
+
+} // namespace detail
+
+/**
+ * A constexpr friendly tagged union, in the same style as optimus::tuple.
+ *
+ * The alternatives share one flat buffer, and the index uses the smallest
+ * unsigned type that fits. If every alternative is trivially copyable, so
+ * is the variant. `visit` dispatches through a switch or a table of function
+ * pointers (see `visit_at`), never through a chain of comparisons.
+ *
+ * The active alternative is read with `optimus::get<I>`, which its
+ * transformers use too, or with `get_if`.
+ *
+ * Converting construction and assignment only accept an alternative type
+ * exactly (after decay), which must appear once in `Types`. Use
+ * `in_place_index_t` for anything else. If constructing a new alternative
+ * throws, the variant is left valueless.
+ */
+template <typename... Types>
+class variant
+    : public detail::variant_base<Types...>,
+      private detail::variant_copy_control_for<Types...>,
+      public detail::tuple_like_adl::tuple_like<variant<Types...>> {
+    static_assert(sizeof...(Types) > 0, "A variant needs at least one alternative");
+
+    using base = detail::variant_base<Types...>;
+
+    template <typename T>
+    using index_of = detail::index_of<typename ::std::decay<T>::type, Types...>;
+
+  public:
+    constexpr variant() : base(in_place_index_t<0>{}) { }
+
+    template <::std::size_t I, typename... Args>
+    explicit constexpr variant(in_place_index_t<I>, Args&&... args)
+            : base(in_place_index_t<I>{}, optimus::forward<Args>(args)...) { }
+
+    template <
+        typename T,
+        typename = typename ::std::enable_if<index_of<T>::value != variant_npos>::type
+    >
+    constexpr variant(T&& v) : base(in_place_index_t<index_of<T>::value>{}, optimus::forward<T>(v)) { }
+
+    template <
+        typename T,
+        typename = typename ::std::enable_if<index_of<T>::value != variant_npos>::type
+    >
+    variant& operator=(T&& v) {
+        if (index() == index_of<T>::value) {
+            detail::union_get<index_of<T>::value>::get(this->union_) = optimus::forward<T>(v);
+        } else {
+            emplace<index_of<T>::value>(optimus::forward<T>(v));
+        }
+        return *this;
+    }
+
+    template <::std::size_t I, typename... Args>
+    variant_alternative_t<I, variant>& emplace(Args&&... args) {
+        using type = variant_alternative_t<I, variant>;
+        this->destroy();
+        ::new (static_cast<void*>(&detail::union_get<I>::get(this->union_)))
+            type(optimus::forward<Args>(args)...);
+        this->index_ = I;
+        return detail::union_get<I>::get(this->union_);
+    }
+
+    constexpr ::std::size_t index() const noexcept {
+        return this->index_ == base::valueless ? variant_npos : this->index_;
+    }
+
+    constexpr bool valueless_by_exception() const noexcept {
+        return this->index_ == base::valueless;
+    }
+
+  private:
+    friend class detail::tuple_like_adl::tuple_like<variant>;
+
+    // Read by the `get<I>` of tuple_like, so that optimus::get<I> and its
+    // transformers apply to variants. The alternative `I` must be active.
+    template <::std::size_t I>
+    static constexpr variant_alternative_t<I, variant>& get_element(variant& v) {
+        return detail::union_get<I>::get(v.union_);
+    }
+
+    template <::std::size_t I>
+    static constexpr const variant_alternative_t<I, variant>& get_element(const variant& v) {
+        return detail::union_get<I>::get(v.union_);
+    }
+
+    template <::std::size_t I>
+    static constexpr variant_alternative_t<I, variant>&& get_element(variant&& v) {
+        return detail::union_get<I>::get(optimus::move(v).union_);
+    }
+};
+
+template <typename T, typename... Types>
+constexpr bool holds_alternative(const optimus::variant<Types...>& v) noexcept {
+    return v.index() == detail::index_of<T, Types...>::value;
+}
+
+template <::std::size_t I, typename... Types>
+constexpr typename ::std::add_pointer<variant_alternative_t<I, optimus::variant<Types...>>>::type
+get_if(optimus::variant<Types...>* v) noexcept {
+    return v != nullptr && v->index() == I ? &detail::union_get<I>::get(v->union_) : nullptr;
+}
+
+template <::std::size_t I, typename... Types>
+constexpr typename ::std::add_pointer<const variant_alternative_t<I, optimus::variant<Types...>>>::type
+get_if(const optimus::variant<Types...>* v) noexcept {
+    return v != nullptr && v->index() == I ? &detail::union_get<I>::get(v->union_) : nullptr;
+}
+
+namespace detail {
+
+template <typename R>
+struct visit_thunk {
+    template <::std::size_t I, typename Fn, typename Union>
+    static constexpr R call(Fn&& fn, Union&& u) {
+        return optimus::forward<Fn>(fn)(union_get<I>::get(optimus::forward<Union>(u)));
+    }
+};
+
+template <typename Fn, typename Variant, typename Indices>
+struct visit_result;
+
+template <typename Fn, typename Variant, ::std::size_t... Indices>
+struct visit_result<Fn, Variant, optimus::index_sequence<Indices...>>
+    : common_result<result_of_t<Fn(decltype(union_get<Indices>::get(::std::declval<Variant>().union_)))>...> { };
+
+} // namespace detail
+
+/**
+ * Calls `fn` with the active alternative of `v`. The result is the common
+ * result of `fn` over all alternatives. `v` must not be valueless.
+ */
+template <
+    typename Fn,
+    typename Variant,
+    typename R = typename detail::visit_result<
+        Fn&&,
+        Variant&&,
+        optimus::make_index_sequence<variant_size<typename ::std::remove_reference<Variant>::type>::value>
+    >::type
+>
+R visit(Fn&& fn, Variant&& v) {
+    return detail::runtime_dispatch<
+            R,
+            detail::visit_thunk<R>,
+            variant_size<typename ::std::remove_reference<Variant>::type>::value
+        >::call(v.index(), optimus::forward<Fn>(fn), optimus::forward<Variant>(v).union_);
+}
+
+} // namespace optimus
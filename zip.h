@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+#include <optimus/sort.h>
+#include <optimus/tuple_core.h>
+#include <optimus/utility.h>
+
+namespace optimus {
+
+namespace detail {
+
+struct zip_increment {
+    template <typename Iterator>
+    void operator()(Iterator& it) const {
+        ++it;
+    }
+};
+
+struct zip_decrement {
+    template <typename Iterator>
+    void operator()(Iterator& it) const {
+        --it;
+    }
+};
+
+struct zip_advance {
+    ::std::ptrdiff_t n;
+
+    template <typename Iterator>
+    void operator()(Iterator& it) const {
+        it += static_cast<typename ::std::iterator_traits<Iterator>::difference_type>(n);
+    }
+};
+
+} // namespace detail
+
+/**
+ * Walks several iterators in step. Dereferencing gives an optimus::tuple
+ * of their references, e.g. tuple<A&, B&> for two arrays, with no copy,
+ * so elements are read with std::get or the get<I> transformers, and
+ * assigning or swapping such a tuple writes through to the arrays. That
+ * makes a zip of random access iterators sortable with std::sort, e.g.
+ * by the first array with get<0>::apply<less<A>>. std::sort copies the
+ * rows it sets aside, since a tuple of references cannot be moved from;
+ * optimus::sort, of sort.h, moves them instead, through iter_move.
+ *
+ * The category is the weakest of the iterators'. Iterators are compared
+ * and subtracted by the first, so they must all have been advanced by
+ * the same amount.
+ */
+template <typename... Iterators>
+class zip_iterator {
+  public:
+    using iterator_category =
+        typename ::std::common_type<typename ::std::iterator_traits<Iterators>::iterator_category...>::type;
+    using value_type = optimus::tuple<typename ::std::iterator_traits<Iterators>::value_type...>;
+    using reference = optimus::tuple<typename ::std::iterator_traits<Iterators>::reference...>;
+    using pointer = void;
+    using difference_type = ::std::ptrdiff_t;
+
+    zip_iterator() { }
+    explicit zip_iterator(Iterators... its) : its_(its...) { }
+
+    // The underlying iterators.
+    const optimus::tuple<Iterators...>& iterators() const {
+        return its_;
+    }
+
+    reference operator*() const {
+        return dereference(optimus::index_sequence_for<Iterators...>{});
+    }
+
+    reference operator[](difference_type n) const {
+        return *(*this + n);
+    }
+
+    // The elements at `it` as rvalues, e.g. tuple<A&&, B&&> for two arrays,
+    // from which a value_type is move constructed or a row move assigned.
+    friend optimus::tuple<detail::iter_rvalue_t<typename ::std::iterator_traits<Iterators>::reference>...>
+    iter_move(const zip_iterator& it) {
+        return it.move_out(optimus::index_sequence_for<Iterators...>{});
+    }
+
+    zip_iterator& operator++() {
+        optimus::tuple_for_each(its_, detail::zip_increment{});
+        return *this;
+    }
+
+    zip_iterator operator++(int) {
+        zip_iterator result = *this;
+        ++*this;
+        return result;
+    }
+
+    zip_iterator& operator--() {
+        optimus::tuple_for_each(its_, detail::zip_decrement{});
+        return *this;
+    }
+
+    zip_iterator operator--(int) {
+        zip_iterator result = *this;
+        --*this;
+        return result;
+    }
+
+    zip_iterator& operator+=(difference_type n) {
+        optimus::tuple_for_each(its_, detail::zip_advance{n});
+        return *this;
+    }
+
+    zip_iterator& operator-=(difference_type n) {
+        return *this += -n;
+    }
+
+    friend zip_iterator operator+(zip_iterator it, difference_type n) {
+        return it += n;
+    }
+
+    friend zip_iterator operator+(difference_type n, zip_iterator it) {
+        return it += n;
+    }
+
+    friend zip_iterator operator-(zip_iterator it, difference_type n) {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return difference_type(lhs.first() - rhs.first());
+    }
+
+    friend bool operator==(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return lhs.first() == rhs.first();
+    }
+
+    friend bool operator!=(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return lhs.first() != rhs.first();
+    }
+
+    friend bool operator<(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return lhs.first() < rhs.first();
+    }
+
+    friend bool operator>(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return rhs.first() < lhs.first();
+    }
+
+    friend bool operator<=(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return !(rhs.first() < lhs.first());
+    }
+
+    friend bool operator>=(const zip_iterator& lhs, const zip_iterator& rhs) {
+        return !(lhs.first() < rhs.first());
+    }
+
+  private:
+    template <::std::size_t... Indices>
+    reference dereference(optimus::index_sequence<Indices...>) const {
+        return reference(*::std::get<Indices>(its_)...);
+    }
+
+    template <::std::size_t... Indices>
+    optimus::tuple<detail::iter_rvalue_t<typename ::std::iterator_traits<Iterators>::reference>...>
+    move_out(optimus::index_sequence<Indices...>) const {
+        return optimus::tuple<detail::iter_rvalue_t<typename ::std::iterator_traits<Iterators>::reference>...>(
+            detail::iter_move_lookup::move_at(::std::get<Indices>(its_))...);
+    }
+
+    const typename ::std::tuple_element<0, optimus::tuple<Iterators...>>::type& first() const {
+        return ::std::get<0>(its_);
+    }
+
+    optimus::tuple<Iterators...> its_;
+};
+
+// The ranges of zip: begin() and end() are zip_iterators.
+template <typename... Iterators>
+class zip_range {
+  public:
+    using iterator = zip_iterator<Iterators...>;
+    using value_type = typename iterator::value_type;
+    using reference = typename iterator::reference;
+
+    zip_range(iterator first, iterator last, ::std::size_t size) : first_(first), last_(last), size_(size) { }
+
+    iterator begin() const {
+        return first_;
+    }
+
+    iterator end() const {
+        return last_;
+    }
+
+    ::std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    reference operator[](::std::size_t i) const {
+        return first_[typename iterator::difference_type(i)];
+    }
+
+  private:
+    iterator first_;
+    iterator last_;
+    ::std::size_t size_;
+};
+
+/**
+ * The ranges in step, as long as the shortest of them: zip(a, b, c)[i] is
+ * tie(a[i], b[i], c[i]). The ranges are referred to, not copied, so they
+ * must outlive the result.
+ */
+template <typename Range, typename... Ranges>
+zip_range<decltype(::std::begin(::std::declval<Range&>())), decltype(::std::begin(::std::declval<Ranges&>()))...>
+zip(Range& range, Ranges&... ranges) {
+    using result = zip_range<decltype(::std::begin(range)), decltype(::std::begin(ranges))...>;
+    const ::std::size_t size = ::std::min({
+        ::std::size_t(::std::distance(::std::begin(range), ::std::end(range))),
+        ::std::size_t(::std::distance(::std::begin(ranges), ::std::end(ranges)))...
+    });
+    return result(typename result::iterator(::std::begin(range), ::std::begin(ranges)...),
+                  typename result::iterator(::std::next(::std::begin(range), size),
+                                            ::std::next(::std::begin(ranges), size)...),
+                  size);
+}
+
+} // namespace optimus